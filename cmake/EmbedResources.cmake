@@ -0,0 +1,138 @@
+
+# Embeds all files of a directory into a target as a sorted, constexpr resource table.
+# The generated source registers the table with cpplocate on static initialization,
+# so cpplocate::findEmbeddedResource and cpplocate::locateResource resolve the files
+# from memory without touching the file system.
+#
+# The target has to link against cpplocate::cpplocate. The table is also accessible
+# through <target>_resources(), declared in the generated header <target>_resources.h
+# (with <target> converted to a C identifier).
+#
+# Example:
+# cpplocate_embed_resources(myapp "${CMAKE_CURRENT_SOURCE_DIR}/data" PREFIX "data/")
+function(cpplocate_embed_resources target directory)
+
+    cmake_parse_arguments(EMBED "" "PREFIX" "" ${ARGN})
+
+    get_filename_component(directory "${directory}" ABSOLUTE)
+
+    # Collect files in byte order to allow for binary search at run-time;
+    # re-run the glob on build to pick up added or removed files
+    if(NOT CMAKE_VERSION VERSION_LESS 3.12)
+        file(GLOB_RECURSE files RELATIVE "${directory}" CONFIGURE_DEPENDS "${directory}/*")
+    else()
+        file(GLOB_RECURSE files RELATIVE "${directory}" "${directory}/*")
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${directory}")
+    endif()
+    list(SORT files)
+
+    string(MAKE_C_IDENTIFIER "${target}" target_id)
+
+    set(output "${CMAKE_CURRENT_BINARY_DIR}/${target}-resources.cpp")
+    set(include_dir "${CMAKE_CURRENT_BINARY_DIR}/${target}-resources")
+    set(header "${include_dir}/${target_id}_resources.h")
+
+    set(declarations "")
+    set(entries "")
+    set(index 0)
+
+    foreach(file ${files})
+        set(path "${directory}/${file}")
+        set(resourcePath "${EMBED_PREFIX}${file}")
+
+        file(READ "${path}" content HEX)
+        string(LENGTH "${content}" contentLength)
+        math(EXPR size "${contentLength} / 2")
+        string(LENGTH "${resourcePath}" resourcePathLength)
+
+        # Emit one character literal per byte, followed by a terminating null byte
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "'\\\\x\\1', " bytes "${content}")
+
+        set(declarations "${declarations}const char resource${index}[] = { ${bytes}'\\0' };\n")
+        set(entries "${entries}    { \"${resourcePath}\", ${resourcePathLength}, resource${index}, ${size} },\n")
+
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${path}")
+
+        math(EXPR index "${index} + 1")
+    endforeach()
+
+    if(index EQUAL 0)
+        message(WARNING "cpplocate_embed_resources: no files found in ${directory}")
+        return()
+    endif()
+
+    set(header_source "
+// Generated by cpplocate_embed_resources, do not edit.
+
+#pragma once
+
+
+#include <cstddef>
+
+#include <cpplocate/cpplocate.h>
+
+
+/**
+*  @brief
+*    Get the resources embedded into ${target}
+*
+*  @param[out] count
+*    Number of resources
+*
+*  @return
+*    Resource table, sorted by path
+*/
+const cpplocate::EmbeddedResource * ${target_id}_resources(std::size_t * count);
+")
+
+    set(source "
+// Generated by cpplocate_embed_resources, do not edit.
+
+#include <${target_id}_resources.h>
+
+
+namespace
+{
+
+
+${declarations}
+
+constexpr cpplocate::EmbeddedResource resources[] = {
+${entries}};
+
+
+struct Registration
+{
+    Registration()
+    {
+        cpplocate::registerEmbeddedResources(resources, ${index});
+    }
+
+    ~Registration()
+    {
+        cpplocate::unregisterEmbeddedResources(resources);
+    }
+} registration;
+
+
+} // namespace
+
+
+const cpplocate::EmbeddedResource * ${target_id}_resources(std::size_t * count)
+{
+    *count = ${index};
+
+    return resources;
+}
+")
+
+    # Only touch the generated files if their contents changed
+    file(WRITE "${header}.tmp" "${header_source}")
+    configure_file("${header}.tmp" "${header}" COPYONLY)
+    file(WRITE "${output}.tmp" "${source}")
+    configure_file("${output}.tmp" "${output}" COPYONLY)
+
+    target_sources(${target} PRIVATE "${output}" "${header}")
+    target_include_directories(${target} PRIVATE "${include_dir}")
+
+endfunction()
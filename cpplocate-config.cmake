@@ -32,6 +32,12 @@ macro(find_modules PREFIX)
 endmacro()
 
 
+# Provide cmake functions (located next to the module exports in both source tree and install location)
+if(NOT COMMAND cpplocate_embed_resources AND EXISTS "${CMAKE_CURRENT_LIST_DIR}/cmake/EmbedResources.cmake")
+    include("${CMAKE_CURRENT_LIST_DIR}/cmake/EmbedResources.cmake")
+endif()
+
+
 # Try install location
 set(MODULE_FOUND FALSE)
 find_modules("cmake")
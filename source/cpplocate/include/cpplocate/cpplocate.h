@@ -2,16 +2,412 @@
 #pragma once
 
 
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <cpplocate/cpplocate_api.h>
 
+#include <cpplocate/path.h>
+#include <cpplocate/pathview.h>
+
 
 namespace cpplocate
 {
 
 
+/**
+*  @brief
+*    Entry of an embedded resource table
+*
+*  @remark
+*    Tables are generated by the CMake function cpplocate_embed_resources
+*    and are sorted by path in byte order.
+*/
+struct EmbeddedResource
+{
+    const char * path;      ///< Relative path of the resource (e.g., 'data/config.json')
+    std::size_t pathLength; ///< Length of path
+    const char * data;      ///< Contents of the resource (followed by a null byte)
+    std::size_t size;       ///< Size of data in bytes (excluding the null byte)
+};
+
+/**
+*  @brief
+*    Result of a resource lookup
+*
+*  @remark
+*    If the resource is embedded, data points to the in-memory bytes and path is empty.
+*    If it was found on disk, path contains the base path from which the relative path
+*    can be resolved and data is nullptr.
+*/
+struct LocatedResource
+{
+    std::string path;   ///< Base path of the resource on disk
+    const char * data;  ///< Contents of the embedded resource
+    std::size_t size;   ///< Size of data in bytes
+};
+
+
+/**
+*  @brief
+*    Cumulative statistics of background prefetching
+*/
+struct PrefetchStatistics
+{
+    std::size_t filesRequested;   ///< Number of files passed to prefetch
+    std::size_t filesPrefetched;  ///< Number of files for which prefetching was issued
+    std::size_t filesFailed;      ///< Number of files that could not be opened or handed to a thread
+    std::uint64_t bytesPrefetched; ///< Accumulated size of the prefetched files
+};
+
+/**
+*  @brief
+*    Shared library found by findLibraries
+*/
+struct LibraryFile
+{
+    std::string path;       ///< Path to the library file
+    std::string name;       ///< Library name without prefix and extension (e.g., 'myplugin')
+    std::uint64_t size;     ///< Size of the file in bytes
+    std::int64_t modified;  ///< Last modification time (seconds since epoch)
+};
+
+/**
+*  @brief
+*    Result of scanning a directory with findLibraries
+*/
+struct LibraryDirectory
+{
+    std::string directory;              ///< Scanned directory
+    bool scanned;                       ///< 'true' if the directory could be opened, else 'false'
+    std::vector<LibraryFile> libraries; ///< Libraries in the directory, ordered by file name
+    std::chrono::microseconds duration; ///< Time spent scanning the directory
+};
+
+/**
+*  @brief
+*    Shared library loaded by loadLibraries
+*/
+struct LoadedLibrary
+{
+    std::string path;                      ///< Path to the library file
+    void * handle;                         ///< Native handle (dlopen or LoadLibrary), nullptr on error
+    std::vector<std::string> dependencies; ///< Paths of the loaded libraries this library depends on
+    std::chrono::microseconds duration;    ///< Time spent loading the library
+    std::string error;                     ///< Error message if the library could not be loaded
+};
+
+/**
+*  @brief
+*    Search stage at which a path was located
+*/
+enum class LocateStage : unsigned char
+{
+    Library         = 0, ///< Relative to the library identified by the symbol
+    Executable      = 1, ///< Relative to the executable
+    Bundle          = 2, ///< Relative to the application bundle
+    System          = 3, ///< Within a system install location
+    BundleResources = 4  ///< Within the resources of the application bundle
+};
+
+/**
+*  @brief
+*    Base path of a located file or directory and the stage it was found at
+*/
+struct LocatedPath
+{
+    std::string path;  ///< Base path from which the relative path can be resolved
+    LocateStage stage; ///< Search stage
+};
+
+/**
+*  @brief
+*    State of the startup access trace
+*/
+enum class AccessTraceMode
+{
+    Disabled,  ///< Queries are neither recorded nor replayed
+    Recording, ///< Queries are recorded and written on stopAccessTrace
+    Replaying  ///< Queries of a previous run are resolved and prefetched up front, new queries are recorded
+};
+
+/**
+*  @brief
+*    Kind of storage backing a filesystem
+*/
+enum class FilesystemKind : unsigned char
+{
+    Unknown = 0, ///< Type could not be determined
+    Memory  = 1, ///< Memory-backed (e.g., tmpfs)
+    Local   = 2, ///< Local disk
+    Network = 3  ///< Network or cluster filesystem (e.g., NFS, SMB)
+};
+
+/**
+*  @brief
+*    Properties of the filesystem containing a directory
+*/
+struct FilesystemStatus
+{
+    FilesystemKind kind;    ///< Kind of storage
+    std::uint64_t freeBytes; ///< Space available to unprivileged users
+    bool writable;          ///< 'true' if the directory is writable for the process
+};
+
+/**
+*  @brief
+*    Function querying the filesystem of a directory
+*
+*  @remark
+*    Returns 'false' if the directory does not exist or cannot be queried.
+*/
+using FilesystemProbe = std::function<bool(const std::string & directory, FilesystemStatus & status)>;
+
+/**
+*  @brief
+*    Capabilities of the filesystem containing a path
+*/
+struct FilesystemInfo
+{
+    std::string type;         ///< Filesystem type (e.g., 'ext4', 'xfs', 'tmpfs', 'nfs4', 'fuse.sshfs', 'overlay')
+    std::string mountPoint;   ///< Mount point containing the path
+    std::string source;       ///< Mounted device or remote location
+    FilesystemKind kind;      ///< Kind of storage
+    std::uint64_t blockSize;  ///< Preferred I/O block size in bytes
+    std::uint64_t freeBytes;  ///< Space available to unprivileged users
+    std::uint64_t totalBytes; ///< Size of the filesystem
+    bool readOnly;            ///< Mounted read-only
+    bool noAccessTime;        ///< Mounted without access time updates (noatime)
+    bool valid;               ///< 'false' if the path does not exist or cannot be queried
+};
+
+/**
+*  @brief
+*    Owned read-only file descriptor of a located file
+*
+*  @remark
+*    The file descriptor is closed on destruction.
+*/
+class CPPLOCATE_API FileHandle
+{
+public:
+    /**
+    *  @brief
+    *    Constructor (invalid handle)
+    */
+    FileHandle();
+
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] descriptor
+    *    File descriptor, ownership is transferred to the handle
+    */
+    explicit FileHandle(int descriptor);
+
+    /**
+    *  @brief
+    *    Move constructor
+    */
+    FileHandle(FileHandle && other);
+
+    /**
+    *  @brief
+    *    Destructor, closes the file descriptor
+    */
+    ~FileHandle();
+
+    /**
+    *  @brief
+    *    Move assignment
+    */
+    FileHandle & operator=(FileHandle && other);
+
+    FileHandle(const FileHandle &) = delete;
+    FileHandle & operator=(const FileHandle &) = delete;
+
+    /**
+    *  @brief
+    *    Get file descriptor
+    *
+    *  @return
+    *    File descriptor, -1 if invalid
+    */
+    int get() const;
+
+    /**
+    *  @brief
+    *    Check if the handle holds an open file descriptor
+    */
+    bool valid() const;
+
+    /**
+    *  @brief
+    *    Release ownership of the file descriptor
+    *
+    *  @return
+    *    File descriptor, the caller is responsible to close it
+    */
+    int release();
+
+private:
+    int m_descriptor; ///< Owned file descriptor
+};
+
+/**
+*  @brief
+*    Read-only memory mapping of a located file
+*
+*  @remark
+*    Mappings are shared between all callers that map the same file
+*    and are unmapped when the last reference is released.
+*/
+class CPPLOCATE_API MappedFile
+{
+public:
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] data
+    *    Mapped memory, ownership is transferred to the mapping
+    *  @param[in] size
+    *    Size of mapped memory in bytes
+    *  @param[in] mapping
+    *    Platform specific handle of the mapping object (Windows only)
+    *
+    *  @remark
+    *    Mappings are created by mapLocated.
+    */
+    MappedFile(const char * data, std::size_t size, void * mapping);
+
+    /**
+    *  @brief
+    *    Destructor, unmaps the memory
+    */
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    /**
+    *  @brief
+    *    Get mapped contents of the file
+    *
+    *  @return
+    *    Pointer to the contents, nullptr for empty files
+    */
+    const char * data() const;
+
+    /**
+    *  @brief
+    *    Get size of the file
+    *
+    *  @return
+    *    Size in bytes
+    */
+    std::size_t size() const;
+
+private:
+    const char * m_data; ///< Mapped memory
+    std::size_t m_size;  ///< Size of mapped memory
+    void * m_mapping;    ///< Handle of the mapping object (Windows only)
+};
+
+
+namespace traits
+{
+
+
+/**
+*  @brief
+*    Number of platform specific shared library extensions
+*/
+#if defined(__APPLE__)
+constexpr std::size_t libExtensionCount = 2;
+#else
+constexpr std::size_t libExtensionCount = 1;
+#endif
+
+/**
+*  @brief
+*    Get platform specific path separator at compile time
+*
+*  @return
+*    Path separator ('/' or '\')
+*/
+constexpr char pathSeparator()
+{
+#if defined(_WIN32)
+    return '\\';
+#else
+    return '/';
+#endif
+}
+
+/**
+*  @brief
+*    Get platform specific shared library prefix at compile time
+*
+*  @return
+*    Library prefix (e.g., 'lib' on UNIX systems, '' on Windows and macOS)
+*/
+constexpr PathView libPrefix()
+{
+#if defined(_WIN32) || defined(__APPLE__)
+    return PathView("");
+#else
+    return PathView("lib");
+#endif
+}
+
+/**
+*  @brief
+*    Get main platform specific shared library extension at compile time
+*
+*  @return
+*    Library extension (e.g., 'dll', 'dylib', or 'so')
+*/
+constexpr PathView libExtension()
+{
+#if defined(_WIN32)
+    return PathView("dll");
+#elif defined(__APPLE__)
+    return PathView("dylib");
+#else
+    return PathView("so");
+#endif
+}
+
+/**
+*  @brief
+*    Get all platform specific shared library extensions at compile time
+*
+*  @return
+*    Library extensions (e.g., ['dll'], ['so'], or ['dylib', 'so'])
+*/
+constexpr std::array<PathView, libExtensionCount> libExtensions()
+{
+#if defined(_WIN32)
+    return std::array<PathView, libExtensionCount>{ { PathView("dll") } };
+#elif defined(__APPLE__)
+    return std::array<PathView, libExtensionCount>{ { PathView("dylib"), PathView("so") } };
+#else
+    return std::array<PathView, libExtensionCount>{ { PathView("so") } };
+#endif
+}
+
+
+} // namespace traits
+
+
 /**
 *  @brief
 *    Get path to the current executable
@@ -70,140 +466,1106 @@ CPPLOCATE_API std::string getLibraryPath(void * symbol);
 
 /**
 *  @brief
-*    Locate path to a file or directory
+*    Get path to dynamic library into an existing string
 *
-*  @param[in] relPath
-*    Relative path to a file or directory (e.g., 'data/logo.png')
-*  @param[in] systemDir
-*    Subdirectory for system installs (e.g., 'share/myappname')
 *  @param[in] symbol
 *    A symbol from the library, e.g., a function or variable pointer
-*
-*  @return
-*    Path to file or directory
+*  @param[out] path
+*    Path to library (including filename), empty if symbol is nullptr
 *
 *  @remark
-*    This function tries to locate the named file or directory based
-*    on the location of the current executable or library. If the
-*    file or directory could be found, the base path from which the
-*    relative path can be resolved is returned. Otherwise, an empty
-*    string is returned.
+*    The path is written into the string directly; its capacity is
+*    reused, so repeated calls with the same string do not allocate.
 */
-CPPLOCATE_API std::string locatePath(const std::string & relPath, const std::string & systemDir, void * symbol);
-
+CPPLOCATE_API void getLibraryPath(void * symbol, std::string & path);
 
 /**
 *  @brief
-*    Get platform specific path separator
+*    Get path to dynamic library as interned path
 *
-*  @return
-*    Path separator (e.g., '`/`' or '`\`')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[out] path
+*    Path to library (including filename), empty if symbol is nullptr
 */
-CPPLOCATE_API std::string pathSeparator();
+CPPLOCATE_API void getLibraryPath(void * symbol, Path & path);
 
 /**
 *  @brief
-*    Get platform specific shared library prefix
+*    Get canonical path to dynamic library
+*
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
 *
 *  @return
-*    Library prefix (e.g., 'lib' on UNIX systems, '' on Windows)
+*    Absolute path to library without symbolic links, empty string on error
 */
-CPPLOCATE_API std::string libPrefix();
+CPPLOCATE_API std::string getCanonicalLibraryPath(void * symbol);
 
 /**
 *  @brief
-*    Get main platform specific shared library extension
+*    Get canonical path to the current module
 *
 *  @return
-*    Library extension (e.g., 'dll', 'dylib', or 'so')
+*    Absolute path to module without symbolic links, empty string on error
 */
-CPPLOCATE_API std::string libExtension();
+CPPLOCATE_API std::string getCanonicalModulePath();
 
 /**
 *  @brief
-*    Get the list platform specific shared library extensions
+*    Resolve a path to its canonical form
+*
+*  @param[in] path
+*    Absolute or relative path
 *
 *  @return
-*    List of library extensions (e.g., ['dll'], ['so'], or ['dylib', 'so'])
+*    Absolute path without symbolic links, '.' and '..' components, and
+*    duplicate delimiters, or empty string if path does not exist
+*
+*  @remark
+*    The canonical form of each visited directory entry is kept in a
+*    process-wide cache, so each symbolic link is read only once (see
+*    clearCanonicalCache).
 */
-CPPLOCATE_API std::vector<std::string> libExtensions();
-
+CPPLOCATE_API std::string canonicalPath(const std::string & path);
 
 /**
 *  @brief
-*    Get home directory of the current user
+*    Resolve a path to its canonical form into an existing string
 *
-*  @return
-*    Home directory
+*  @param[in] path
+*    Absolute or relative path
+*  @param[out] canonical
+*    Canonical path, empty if path does not exist (see canonicalPath)
+*
+*  @remark
+*    The capacity of canonical is reused.
 */
-CPPLOCATE_API std::string homeDir();
+CPPLOCATE_API void canonicalPath(const std::string & path, std::string & canonical);
 
 /**
 *  @brief
-*    Get profile directory of the current user
+*    Resolve a path to its canonical form as interned path
 *
-*  @return
-*    Profile directory
+*  @param[in] path
+*    Absolute or relative path
+*  @param[out] canonical
+*    Canonical path, empty if path does not exist (see canonicalPath)
 */
-CPPLOCATE_API std::string profileDir();
+CPPLOCATE_API void canonicalPath(const std::string & path, Path & canonical);
 
 /**
 *  @brief
-*    Get document directory of the current user
-*
-*  @return
-*    Document directory
+*    Discard all cached canonical paths
 */
-CPPLOCATE_API std::string documentDir();
-
+CPPLOCATE_API void clearCanonicalCache();
 
 /**
 *  @brief
-*    Get config directory for the named application
+*    Locate path to a file or directory
 *
-*  @param[in] application
-*    Application name
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
 *
 *  @return
-*    Config directory
+*    Path to file or directory
+*
+*  @remark
+*    This function tries to locate the named file or directory based
+*    on the location of the current executable or library. If the
+*    file or directory could be found, the base path from which the
+*    relative path can be resolved is returned. Otherwise, an empty
+*    string is returned.
+*
+*  @remark
+*    Directories found to contain the first component of relPath are
+*    remembered until clearSearchCache, the candidates below them are
+*    probed on each call. With a time to live set by
+*    setSearchCacheTimeToLive, directories found not to contain it are
+*    skipped for that time, so files created there meanwhile are found
+*    only after it expired or after clearSearchCache.
 */
-CPPLOCATE_API std::string configDir(const std::string & application);
+CPPLOCATE_API std::string locatePath(const std::string & relPath, const std::string & systemDir, void * symbol);
 
 /**
 *  @brief
-*    Get roaming directory for the named application
+*    Locate path to a file or directory into an existing string
 *
-*  @param[in] application
-*    Application name
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[out] path
+*    Path to file or directory, empty if it could not be located
 *
-*  @return
-*    Roaming directory
+*  @remark
+*    The path is written into the string directly; its capacity is
+*    reused, so locating many files with the same string does not
+*    allocate once the capacity suffices.
 */
-CPPLOCATE_API std::string roamingDir(const std::string & application);
+CPPLOCATE_API void locatePath(const std::string & relPath, const std::string & systemDir, void * symbol, std::string & path);
 
 /**
 *  @brief
-*    Get local directory for the named application
+*    Locate path to a file or directory as interned path
 *
-*  @param[in] application
-*    Application name
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[out] path
+*    Path to file or directory, empty if it could not be located
 *
-*  @return
-*    Local directory
+*  @remark
+*    The result is composed in a per-thread buffer and looked up in the
+*    path table, so repeating a query neither allocates nor copies the
+*    result; all handles to the result share one entry.
 */
-CPPLOCATE_API std::string localDir(const std::string & application);
+CPPLOCATE_API void locatePath(const std::string & relPath, const std::string & systemDir, void * symbol, Path & path);
 
 /**
 *  @brief
-*    Get temporary directory for the named application
+*    Locate path to a file or directory given as path views
 *
-*  @param[in] application
-*    Application name
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
 *
 *  @return
-*    Temporary directory
+*    Path to file or directory
+*
+*  @remark
+*    Passes the views to liblocate without intermediate strings.
 */
-CPPLOCATE_API std::string tempDir(const std::string & application);
+CPPLOCATE_API std::string locatePath(PathView relPath, PathView systemDir, void * symbol);
+
+/**
+*  @brief
+*    Locate path to a file or directory given as string literals
+*
+*  @remark
+*    The lengths of the literals are known at compile time, so neither
+*    strings are constructed nor lengths are computed at runtime.
+*/
+template <std::size_t N, std::size_t M>
+std::string locatePath(const char (&relPath)[N], const char (&systemDir)[M], void * symbol)
+{
+    return locatePath(PathView(relPath), PathView(systemDir), symbol);
+}
+
+/**
+*  @brief
+*    Locate path to a file or directory given as string literal
+*
+*  @remark
+*    The length of relPath is known at compile time.
+*/
+template <std::size_t N>
+std::string locatePath(const char (&relPath)[N], const std::string & systemDir, void * symbol)
+{
+    return locatePath(PathView(relPath), PathView(systemDir.data(), systemDir.size()), symbol);
+}
+
+/**
+*  @brief
+*    Locate canonical path to a file or directory
+*
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @return
+*    Canonical base path (with trailing delimiter), empty string if relPath could not be located
+*/
+CPPLOCATE_API std::string locateCanonicalPath(const std::string & relPath, const std::string & systemDir, void * symbol);
+
+/**
+*  @brief
+*    Locate canonical path to a file or directory into an existing string
+*
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[out] path
+*    Canonical base path (with trailing delimiter), empty if relPath could not be located
+*
+*  @remark
+*    The capacity of path is reused.
+*/
+CPPLOCATE_API void locateCanonicalPath(const std::string & relPath, const std::string & systemDir, void * symbol, std::string & path);
+
+/**
+*  @brief
+*    Locate path to a file or directory with a custom upward search depth
+*
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[in] depth
+*    Number of parent directories checked above each base directory,
+*    clamped to LocateMaxSearchDepth (64)
+*
+*  @return
+*    Path to file or directory
+*
+*  @remark
+*    Ancestors are memoized as described for locatePath.
+*/
+CPPLOCATE_API std::string locatePath(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth);
+
+/**
+*  @brief
+*    Enable or disable lexical normalization of located paths
+*
+*  @param[in] enabled
+*    'true' to normalize, 'false' to return candidate paths verbatim (default)
+*
+*  @remark
+*    If enabled, locatePath, locateAllPaths, and openLocated return base
+*    paths without '.' and '..' components (see normalizePath).
+*/
+CPPLOCATE_API void setNormalizedResults(bool enabled);
+
+/**
+*  @brief
+*    Lexically normalize a path
+*
+*  @param[in] path
+*    Path
+*
+*  @return
+*    Path with '/' delimiters, without '.' components and duplicate
+*    delimiters, and with '..' components resolved against the
+*    preceding component (e.g., '/opt/app/lib/../../' -> '/opt/')
+*
+*  @remark
+*    The filesystem is not accessed, so symbolic links are not taken
+*    into account. A root and a trailing delimiter are preserved.
+*/
+CPPLOCATE_API std::string normalizePath(const std::string & path);
+
+/**
+*  @brief
+*    Lexically normalize multiple paths at once
+*
+*  @param[in] paths
+*    Paths
+*
+*  @return
+*    Normalized paths in the same order (see normalizePath)
+*
+*  @remark
+*    All paths are normalized in a single buffer with one call into liblocate.
+*/
+CPPLOCATE_API std::vector<std::string> normalizePaths(const std::vector<std::string> & paths);
+
+/**
+*  @brief
+*    Set the default upward search depth of locatePath, locateAllPaths, and openLocated
+*
+*  @param[in] depth
+*    Number of parent directories checked above each base directory (default: 2),
+*    clamped to LocateMaxSearchDepth (64)
+*/
+CPPLOCATE_API void setSearchDepth(unsigned int depth);
+
+/**
+*  @brief
+*    Get the default upward search depth
+*
+*  @return
+*    Number of parent directories checked above each base directory
+*/
+CPPLOCATE_API unsigned int searchDepth();
+
+/**
+*  @brief
+*    Set how long missing ancestors are remembered during location
+*
+*  @param[in] timeToLive
+*    Time to live of memoized misses (default: 0, i.e., misses are not memoized)
+*
+*  @remark
+*    See setSearchCacheTimeToLive of liblocate.
+*/
+CPPLOCATE_API void setSearchCacheTimeToLive(std::chrono::milliseconds timeToLive);
+
+/**
+*  @brief
+*    Discard the memoized existence of directories checked during location
+*/
+CPPLOCATE_API void clearSearchCache();
+
+/**
+*  @brief
+*    Locate all paths to a file or directory
+*
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @return
+*    Every distinct base path that contains relPath, in priority order
+*
+*  @remark
+*    In contrast to locatePath, which stops at the first match, all
+*    candidates are evaluated in a single pass. This allows for layered
+*    deployments (e.g., overrides next to the executable on top of a
+*    system install). The first entry equals the result of locatePath.
+*/
+CPPLOCATE_API std::vector<LocatedPath> locateAllPaths(const std::string & relPath, const std::string & systemDir, void * symbol);
+
+/**
+*  @brief
+*    Locate and open a file
+*
+*  @param[in] relPath
+*    Relative path to a file (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @return
+*    Owned read-only file handle, invalid if the file could not be found
+*
+*  @remark
+*    The candidates are the same as for locatePath, but each candidate
+*    is opened directly, so the path is traversed only once and the file
+*    cannot change between locating and opening it.
+*/
+CPPLOCATE_API FileHandle openLocated(const std::string & relPath, const std::string & systemDir, void * symbol);
+
+/**
+*  @brief
+*    Locate a file and map it into memory
+*
+*  @param[in] relPath
+*    Relative path to a file (e.g., 'data/logo.png')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @return
+*    Read-only mapping, nullptr if the file could not be found or mapped
+*
+*  @remark
+*    Callers mapping the same file (identified by device and inode)
+*    share a single mapping, as long as size and modification time of
+*    the file are unchanged. A file rewritten in place is mapped anew;
+*    existing mappings of it are not updated.
+*/
+CPPLOCATE_API std::shared_ptr<const MappedFile> mapLocated(const std::string & relPath, const std::string & systemDir, void * symbol);
+
+
+/**
+*  @brief
+*    Register an additional system install prefix
+*
+*  @param[in] prefix
+*    Install prefix (e.g., '/opt/vendor')
+*
+*  @remark
+*    An executable or library in '<prefix>/bin', '<prefix>/lib',
+*    '<prefix>/lib32', or '<prefix>/lib64' is treated as system install
+*    by locatePath. The prefixes '/usr' and '/usr/local' are always
+*    recognized, additional prefixes can be passed through the
+*    environment variable LIBLOCATE_SYSTEM_PREFIXES. Prefixes registered
+*    earlier take precedence.
+*/
+CPPLOCATE_API void addSystemPrefix(const std::string & prefix);
+
+/**
+*  @brief
+*    Remove all system install prefixes registered with addSystemPrefix
+*/
+CPPLOCATE_API void resetSystemPrefixes();
+
+/**
+*  @brief
+*    Get platform specific path separator
+*
+*  @return
+*    Path separator (e.g., '`/`' or '`\`')
+*/
+CPPLOCATE_API std::string pathSeparator();
+
+/**
+*  @brief
+*    Get platform specific shared library prefix
+*
+*  @return
+*    Library prefix (e.g., 'lib' on UNIX systems, '' on Windows)
+*/
+CPPLOCATE_API std::string libPrefix();
+
+/**
+*  @brief
+*    Get main platform specific shared library extension
+*
+*  @return
+*    Library extension (e.g., 'dll', 'dylib', or 'so')
+*/
+CPPLOCATE_API std::string libExtension();
+
+/**
+*  @brief
+*    Get the list platform specific shared library extensions
+*
+*  @return
+*    List of library extensions (e.g., ['dll'], ['so'], or ['dylib', 'so'])
+*/
+CPPLOCATE_API std::vector<std::string> libExtensions();
+
+/**
+*  @brief
+*    Compose platform specific shared library file names for many library names
+*
+*  @param[in] names
+*    Library names (e.g., 'myplugin')
+*  @param[out] buffer
+*    Receives all file names back to back, each followed by a null byte
+*
+*  @return
+*    Offsets of the file names within buffer, followed by buffer.size()
+*
+*  @remark
+*    For each name and each extension of traits::libExtensions(), the
+*    file name '<prefix><name>.<extension>' is composed (e.g.,
+*    'libmyplugin.so'). The file name for name i and extension j starts
+*    at offset i * traits::libExtensionCount + j, its length is the
+*    distance to the next offset minus one. The buffer is allocated
+*    once for all file names.
+*/
+CPPLOCATE_API std::vector<std::size_t> composeLibraryFileNames(const std::vector<std::string> & names, std::string & buffer);
+
+/**
+*  @brief
+*    Find shared libraries in multiple directories in parallel
+*
+*  @param[in] directories
+*    Directories to scan (e.g., plugin directories obtained by locatePath)
+*  @param[in] namePattern
+*    Pattern for the library name without prefix and extension,
+*    supporting '*' and '?' wildcards (e.g., '*plugin')
+*
+*  @return
+*    One result per directory, in the order of directories
+*
+*  @remark
+*    Regular files named '<prefix><name>.<extension>' (see traits) are
+*    reported, together with their size and modification time. The
+*    directories are scanned concurrently. On Linux, entries are read
+*    in large batches with getdents64 and queried with fstatat relative
+*    to the open directory. Names are filtered in place, so only
+*    matching entries allocate memory.
+*/
+CPPLOCATE_API std::vector<LibraryDirectory> findLibraries(const std::vector<std::string> & directories, const std::string & namePattern);
+
+/**
+*  @brief
+*    Get the libraries a shared library needs
+*
+*  @param[in] path
+*    Path to shared library
+*
+*  @return
+*    Names of the needed libraries as recorded in the file (DT_NEEDED entries, e.g., 'libm.so.6')
+*
+*  @remark
+*    The dynamic section is read from a read-only mapping of the file,
+*    without loading it. Only ELF files are supported; for other formats
+*    and platforms, an empty list is returned.
+*/
+CPPLOCATE_API std::vector<std::string> libraryDependencies(const std::string & path);
+
+/**
+*  @brief
+*    Load shared libraries (e.g., plugins) concurrently
+*
+*  @param[in] paths
+*    Paths to shared libraries (e.g., obtained by findLibraries)
+*  @param[in] threadCount
+*    Maximum number of loader threads (0 for one per hardware thread)
+*
+*  @return
+*    One result per library, in the order of paths
+*
+*  @remark
+*    A library that needs another one of the given libraries (by soname
+*    or file name) is loaded after it, independent libraries are loaded
+*    concurrently. Dependency cycles are broken in the order of paths.
+*    The files are prefetched while their dependencies are read.
+*    Libraries are opened with RTLD_NOW | RTLD_LOCAL.
+*/
+CPPLOCATE_API std::vector<LoadedLibrary> loadLibraries(const std::vector<std::string> & paths, std::size_t threadCount);
+
+/**
+*  @brief
+*    Unload libraries loaded by loadLibraries
+*
+*  @param[in,out] libraries
+*    Loaded libraries, unloaded in reverse order (handles are reset to nullptr)
+*/
+CPPLOCATE_API void unloadLibraries(std::vector<LoadedLibrary> & libraries);
+
+/**
+*  @brief
+*    Find a library installed on the system
+*
+*  @param[in] name
+*    Soname (e.g., 'libz.so.1'), file name (e.g., 'libz.so'), or library name (e.g., 'z')
+*
+*  @return
+*    Path to library, empty string if not found
+*
+*  @remark
+*    On Linux, the dynamic linker cache '/etc/ld.so.cache' is mapped and
+*    parsed once into a sorted table, which is then searched for entries
+*    of the host architecture. Library names without version resolve to
+*    the first versioned soname. Libraries not in the cache (or if there
+*    is no cache) are probed in the system library directories.
+*/
+CPPLOCATE_API std::string findSystemLibrary(const std::string & name);
+
+/**
+*  @brief
+*    Find a library using a specific dynamic linker cache
+*
+*  @param[in] name
+*    Soname (e.g., 'libz.so.1'), file name (e.g., 'libz.so'), or library name (e.g., 'z')
+*  @param[in] cacheFile
+*    Path to cache file in the format of ldconfig (old, new, or combined format)
+*
+*  @return
+*    Path to library, empty string if not found
+*/
+CPPLOCATE_API std::string findSystemLibrary(const std::string & name, const std::string & cacheFile);
+
+/**
+*  @brief
+*    Discard all parsed dynamic linker caches (e.g., after running ldconfig)
+*/
+CPPLOCATE_API void clearSystemLibraryCache();
+
+/**
+*  @brief
+*    Find an executable in the directories listed in PATH
+*
+*  @param[in] name
+*    Name of executable (e.g., 'python3')
+*
+*  @return
+*    Path to the first executable file of that name in PATH, empty string if not found
+*
+*  @remark
+*    Each directory in PATH is listed once into an in-memory index, which
+*    is rebuilt when the modification time of the directory changes, so
+*    repeated lookups do not scan directories (on network filesystems,
+*    the modification time is checked at most once per second). Only
+*    files that are
+*    executable for the process are reported. Names containing a path
+*    delimiter are not searched, but returned if executable. On Windows,
+*    the extensions in PATHEXT are tried for names without extension.
+*/
+CPPLOCATE_API std::string findExecutable(const std::string & name);
+
+/**
+*  @brief
+*    Discard the index of the directories in PATH
+*/
+CPPLOCATE_API void clearExecutableCache();
+
+
+/**
+*  @brief
+*    Capture the environment variables used by cpplocate anew
+*
+*  @remark
+*    The variables used for directory queries (e.g., HOME, APPDATA,
+*    XDG_*, TMPDIR, PATH) are read from an immutable snapshot taken on
+*    first use. Call this function after changing them at runtime.
+*
+*  @remark
+*    Previous snapshots are kept for the lifetime of the process, as
+*    concurrent readers may still use them. A refresh only takes a new
+*    snapshot if a value changed; each change retains about the size of
+*    the captured values.
+*/
+CPPLOCATE_API void refreshEnvironment();
+
+/**
+*  @brief
+*    Get home directory of the current user
+*
+*  @return
+*    Home directory
+*
+*  @remark
+*    HOME is used if set (read from the environment snapshot, see
+*    refreshEnvironment). Otherwise, the user database is queried on
+*    the first call only (see clearHomeDirCache).
+*/
+CPPLOCATE_API std::string homeDir();
+
+/**
+*  @brief
+*    Discard the cached home directory of the user database
+*/
+CPPLOCATE_API void clearHomeDirCache();
+
+/**
+*  @brief
+*    Get profile directory of the current user
+*
+*  @return
+*    Profile directory
+*/
+CPPLOCATE_API std::string profileDir();
+
+/**
+*  @brief
+*    Get document directory of the current user
+*
+*  @return
+*    Document directory
+*/
+CPPLOCATE_API std::string documentDir();
+
+
+/**
+*  @brief
+*    Get config directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Config directory
+*/
+CPPLOCATE_API std::string configDir(const std::string & application);
+
+/**
+*  @brief
+*    Create a directory and all missing parent directories
+*
+*  @param[in] path
+*    Path to directory
+*  @param[in] mode
+*    Permissions of created directories (ignored on Windows)
+*
+*  @return
+*    Handle to the opened directory, invalid on error
+*
+*  @remark
+*    The deepest existing ancestor is opened once and the missing
+*    components are created relative to it (mkdirat), so each level
+*    costs a single mkdir and open. Directories created concurrently
+*    by other processes are accepted. The returned descriptor can be
+*    used with openat to create files within the directory.
+*/
+CPPLOCATE_API FileHandle ensureDir(const std::string & path, unsigned int mode);
+
+/**
+*  @brief
+*    Create the config directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Handle to the opened config directory, invalid on error
+*
+*  @remark
+*    Missing directories are created with mode 0700 (see ensureDir).
+*/
+CPPLOCATE_API FileHandle ensureConfigDir(const std::string & application);
+
+/**
+*  @brief
+*    Get roaming directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Roaming directory
+*/
+CPPLOCATE_API std::string roamingDir(const std::string & application);
+
+/**
+*  @brief
+*    Get local directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Local directory
+*/
+CPPLOCATE_API std::string localDir(const std::string & application);
+
+/**
+*  @brief
+*    Get temporary directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Temporary directory
+*/
+CPPLOCATE_API std::string tempDir(const std::string & application);
+
+/**
+*  @brief
+*    Get data directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Data directory
+*
+*  @remark
+*    '$XDG_DATA_HOME/<application>' (default '~/.local/share') on Linux
+*/
+CPPLOCATE_API std::string dataDir(const std::string & application);
+
+/**
+*  @brief
+*    Get cache directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Cache directory
+*
+*  @remark
+*    '$XDG_CACHE_HOME/<application>' (default '~/.cache') on Linux
+*/
+CPPLOCATE_API std::string cacheDir(const std::string & application);
+
+/**
+*  @brief
+*    Get state directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    State directory
+*
+*  @remark
+*    '$XDG_STATE_HOME/<application>' (default '~/.local/state') on Linux
+*/
+CPPLOCATE_API std::string stateDir(const std::string & application);
+
+/**
+*  @brief
+*    Get runtime directory for the named application
+*
+*  @param[in] application
+*    Application name
+*
+*  @return
+*    Runtime directory
+*
+*  @remark
+*    '$XDG_RUNTIME_DIR/<application>' on Linux, falling back to tempDir
+*/
+CPPLOCATE_API std::string runtimeDir(const std::string & application);
+
+/**
+*  @brief
+*    Get a scratch directory for temporary files of the named application
+*
+*  @param[in] application
+*    Application name
+*  @param[in] minFreeBytes
+*    Space required for the temporary files
+*
+*  @return
+*    Path to scratch directory, empty string if no candidate is usable
+*
+*  @remark
+*    The candidates XDG_RUNTIME_DIR, /dev/shm, TMPDIR, /tmp, and /var/tmp
+*    (the directory of GetTempPath on Windows) are queried with the
+*    filesystem probe. Writable candidates with enough free space are
+*    ranked memory-backed first, then local, then unknown filesystems,
+*    in candidate order otherwise; network filesystems are used only
+*    if nothing else qualifies. The decision is cached per application
+*    and size (see setScratchDirTimeToLive).
+*
+*  @remark
+*    The application subdirectory is created with owner-only access.
+*    Within shared directories (sticky bit set, e.g., /tmp), it is
+*    named '<application>-<uid>'. An existing subdirectory is only used
+*    if it is a real directory owned by the current user.
+*/
+CPPLOCATE_API std::string scratchDir(const std::string & application, std::uint64_t minFreeBytes);
+
+/**
+*  @brief
+*    Set how long scratchDir decisions are reused
+*
+*  @param[in] timeToLive
+*    Duration (default 60 seconds, 0 disables caching)
+*/
+CPPLOCATE_API void setScratchDirTimeToLive(std::chrono::seconds timeToLive);
+
+/**
+*  @brief
+*    Discard all cached scratchDir decisions
+*/
+CPPLOCATE_API void clearScratchDirCache();
+
+/**
+*  @brief
+*    Replace the function used to query filesystems
+*
+*  @param[in] probe
+*    Filesystem probe, nullptr to restore the default (based on filesystemInfo)
+*
+*  @remark
+*    Intended for tests and for environments with custom storage
+*    policies. Cached scratchDir decisions are discarded.
+*/
+CPPLOCATE_API void setFilesystemProbe(FilesystemProbe probe);
+
+/**
+*  @brief
+*    Get capabilities of the filesystem containing a path
+*
+*  @param[in] path
+*    Path to file or directory (e.g., a located data directory)
+*
+*  @return
+*    Filesystem report (valid is 'false' on error)
+*
+*  @remark
+*    On Linux, the mount is identified by the mount ID of statx (or the
+*    device number on older kernels) in a parsed copy of
+*    /proc/self/mountinfo. The copy is parsed again only after the
+*    kernel reports a change of the mount table. Sizes and flags are
+*    queried with statfs.
+*/
+CPPLOCATE_API FilesystemInfo filesystemInfo(const std::string & path);
+
+/**
+*  @brief
+*    Discard the parsed mount table
+*/
+CPPLOCATE_API void clearFilesystemInfoCache();
+
+
+/**
+*  @brief
+*    Prefetch files into the page cache in the background
+*
+*  @param[in] directory
+*    Base directory (e.g., as returned by locatePath)
+*  @param[in] relPaths
+*    Paths of the files relative to directory
+*
+*  @remark
+*    The call returns immediately. The files are opened on background
+*    threads and the operating system is advised to read them ahead
+*    (posix_fadvise on POSIX systems). On other systems, the files are
+*    read once to warm up the cache.
+*
+*  @remark
+*    Requests are queued without limit, only the number of background
+*    threads is bounded (see setMaxPrefetchRequests). Files that cannot
+*    be handed to any thread are counted as failed.
+*/
+CPPLOCATE_API void prefetch(const std::string & directory, const std::vector<std::string> & relPaths);
+
+/**
+*  @brief
+*    Prefetch all files of a directory matching a pattern in the background
+*
+*  @param[in] directory
+*    Base directory (e.g., as returned by locatePath)
+*  @param[in] pattern
+*    File name pattern, supporting '*' and '?' wildcards (e.g., '*.glsl')
+*
+*  @remark
+*    Only regular files directly within directory are considered.
+*/
+CPPLOCATE_API void prefetchMatching(const std::string & directory, const std::string & pattern);
+
+/**
+*  @brief
+*    Set maximum number of prefetch requests in flight
+*
+*  @param[in] count
+*    Maximum number of files prefetched concurrently (default: 4)
+*
+*  @remark
+*    Bounds the number of background threads, further requests wait in
+*    the queue, which is unbounded.
+*/
+CPPLOCATE_API void setMaxPrefetchRequests(std::size_t count);
+
+/**
+*  @brief
+*    Block until all pending prefetch requests are processed
+*/
+CPPLOCATE_API void waitForPrefetch();
+
+/**
+*  @brief
+*    Get cumulative prefetch statistics of the process
+*
+*  @return
+*    Prefetch statistics
+*/
+CPPLOCATE_API PrefetchStatistics prefetchStatistics();
+
+
+/**
+*  @brief
+*    Start recording or replaying the startup access trace of the application
+*
+*  @param[in] application
+*    Application name, the trace is stored in cacheDir(application)
+*
+*  @return
+*    Replaying if a valid trace of a previous run exists, else Recording
+*
+*  @remark
+*    While recording, all queries of locatePath and getLibraryPath are
+*    logged along with their results. When replaying, the recorded
+*    queries are located anew in parallel and their files are
+*    prefetched, and locatePath answers matching queries from the
+*    current results. The recorded results only serve as prefetch
+*    hints, so replayed queries resolve as they did at startAccessTrace.
+*    Queries not contained in the trace are recorded while replaying as
+*    well and merged into the trace.
+*
+*  @remark
+*    A trace is discarded if the executable changed since it was recorded.
+*/
+CPPLOCATE_API AccessTraceMode startAccessTrace(const std::string & application);
+
+/**
+*  @brief
+*    Stop recording or replaying the startup access trace
+*
+*  @remark
+*    The trace is written to the cache directory of the application
+*    passed to startAccessTrace, if queries were recorded that it does
+*    not contain yet or if recorded results became invalid.
+*/
+CPPLOCATE_API void stopAccessTrace();
+
+/**
+*  @brief
+*    Get current state of the startup access trace
+*
+*  @return
+*    Access trace mode
+*/
+CPPLOCATE_API AccessTraceMode accessTraceMode();
+
+
+/**
+*  @brief
+*    Register a table of embedded resources
+*
+*  @param[in] resources
+*    Resource table, sorted by path (e.g., generated by cpplocate_embed_resources)
+*  @param[in] count
+*    Number of entries in resources
+*
+*  @remark
+*    Tables registered later take precedence over tables registered earlier.
+*    The table is not copied and has to outlive its registration.
+*/
+CPPLOCATE_API void registerEmbeddedResources(const EmbeddedResource * resources, std::size_t count);
+
+/**
+*  @brief
+*    Unregister a previously registered table of embedded resources
+*
+*  @param[in] resources
+*    Resource table as passed to registerEmbeddedResources
+*/
+CPPLOCATE_API void unregisterEmbeddedResources(const EmbeddedResource * resources);
+
+/**
+*  @brief
+*    Find an embedded resource
+*
+*  @param[in] relPath
+*    Relative path of the resource (e.g., 'data/config.json')
+*
+*  @return
+*    Resource entry, nullptr if no registered table contains relPath
+*
+*  @remark
+*    This function does not access the file system.
+*/
+CPPLOCATE_API const EmbeddedResource * findEmbeddedResource(const std::string & relPath);
+
+/**
+*  @brief
+*    Enable or disable overrides of embedded resources by files on disk
+*
+*  @param[in] enabled
+*    If 'true', locateResource prefers files on disk over embedded resources
+*
+*  @remark
+*    Overrides are disabled by default.
+*/
+CPPLOCATE_API void setEmbeddedResourceOverrides(bool enabled);
+
+/**
+*  @brief
+*    Locate a resource, searching embedded resources first
+*
+*  @param[in] relPath
+*    Relative path to a file (e.g., 'data/config.json')
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @return
+*    Located resource, with empty path and nullptr data if it could not be found
+*
+*  @remark
+*    Embedded resources are the highest-priority search root. Only if overrides
+*    are enabled (see setEmbeddedResourceOverrides), the file system is probed
+*    using locatePath before the embedded resources are consulted.
+*/
+CPPLOCATE_API LocatedResource locateResource(const std::string & relPath, const std::string & systemDir, void * symbol);
 
 
 } // namespace cpplocate
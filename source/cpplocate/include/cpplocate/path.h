@@ -0,0 +1,329 @@
+
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+#if __cplusplus >= 201703L
+    #include <string_view>
+
+    #if defined(__has_include)
+        #if __has_include(<filesystem>)
+            #include <filesystem>
+            #define CPPLOCATE_PATH_FILESYSTEM
+        #endif
+    #endif
+#endif
+
+#include <cpplocate/cpplocate_api.h>
+
+#include <cpplocate/pathview.h>
+
+
+namespace cpplocate
+{
+
+
+namespace detail
+{
+
+
+/**
+*  @brief
+*    Entry of the process-wide path table
+*/
+struct InternedPath
+{
+    const std::string * string;           ///< Characters, owned by the table
+    std::atomic<std::size_t> references;  ///< Number of Path handles referring to the entry
+};
+
+/**
+*  @brief
+*    Get the empty string shared by all empty paths
+*/
+CPPLOCATE_API const std::string & emptyPath();
+
+/**
+*  @brief
+*    Drop a reference to an entry, removing it from the table with the last one
+*/
+CPPLOCATE_API void releasePath(InternedPath * entry);
+
+
+} // namespace detail
+
+
+class Path;
+
+CPPLOCATE_API Path internPath(const std::string & path);
+
+
+/**
+*  @brief
+*    Handle to an immutable path in a process-wide string table
+*
+*  @remark
+*    Equal paths share one entry of the table, so copying a handle does
+*    not allocate and comparing two handles compares pointers. Entries
+*    are reference-counted and removed when the last handle referring
+*    to them is destroyed. Handles are obtained by internPath or by the
+*    overloads of the path queries taking a Path out-parameter.
+*/
+class Path
+{
+public:
+    /**
+    *  @brief
+    *    Constructor (empty path)
+    */
+    Path()
+    : m_entry(nullptr)
+    {
+    }
+
+    /**
+    *  @brief
+    *    Copy constructor
+    */
+    Path(const Path & other)
+    : m_entry(other.m_entry)
+    {
+        if (m_entry != nullptr)
+        {
+            m_entry->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+    *  @brief
+    *    Move constructor
+    */
+    Path(Path && other)
+    : m_entry(other.m_entry)
+    {
+        other.m_entry = nullptr;
+    }
+
+    /**
+    *  @brief
+    *    Destructor
+    */
+    ~Path()
+    {
+        if (m_entry != nullptr)
+        {
+            detail::releasePath(m_entry);
+        }
+    }
+
+    /**
+    *  @brief
+    *    Copy assignment
+    */
+    Path & operator=(const Path & other)
+    {
+        Path(other).swap(*this);
+
+        return *this;
+    }
+
+    /**
+    *  @brief
+    *    Move assignment
+    */
+    Path & operator=(Path && other)
+    {
+        Path(std::move(other)).swap(*this);
+
+        return *this;
+    }
+
+    /**
+    *  @brief
+    *    Exchange the entries of two handles
+    */
+    void swap(Path & other)
+    {
+        const auto entry = m_entry;
+        m_entry = other.m_entry;
+        other.m_entry = entry;
+    }
+
+    /**
+    *  @brief
+    *    Get the path as string
+    *
+    *  @return
+    *    String in the table (valid as long as a handle refers to it)
+    */
+    const std::string & str() const
+    {
+        return m_entry != nullptr ? *m_entry->string : detail::emptyPath();
+    }
+
+    /**
+    *  @brief
+    *    Get characters of the path
+    *
+    *  @return
+    *    Null-terminated characters
+    */
+    const char * c_str() const
+    {
+        return str().c_str();
+    }
+
+    /**
+    *  @brief
+    *    Get number of characters
+    */
+    std::size_t size() const
+    {
+        return str().size();
+    }
+
+    /**
+    *  @brief
+    *    Check if the path is empty
+    *
+    *  @return
+    *    'true' if the path has no characters, else 'false'
+    */
+    bool empty() const
+    {
+        return m_entry == nullptr;
+    }
+
+    /**
+    *  @brief
+    *    Convert to path view
+    */
+    operator PathView() const
+    {
+        return PathView(str().data(), str().size());
+    }
+
+#if __cplusplus >= 201703L
+    /**
+    *  @brief
+    *    Convert to string view
+    */
+    operator std::string_view() const
+    {
+        return std::string_view(str());
+    }
+#endif
+
+#if defined(CPPLOCATE_PATH_FILESYSTEM)
+    /**
+    *  @brief
+    *    Convert to filesystem path
+    */
+    operator std::filesystem::path() const
+    {
+        return std::filesystem::path(str());
+    }
+#endif
+
+    /**
+    *  @brief
+    *    Compare two paths
+    *
+    *  @return
+    *    'true' if both handles refer to the same entry (and thus to equal paths), else 'false'
+    */
+    bool operator==(const Path & other) const
+    {
+        return m_entry == other.m_entry;
+    }
+
+    /**
+    *  @brief
+    *    Compare two paths
+    */
+    bool operator!=(const Path & other) const
+    {
+        return m_entry != other.m_entry;
+    }
+
+protected:
+    friend Path internPath(const std::string & path);
+    friend struct std::hash<Path>;
+
+    explicit Path(detail::InternedPath * entry)
+    : m_entry(entry)
+    {
+    }
+
+protected:
+    detail::InternedPath * m_entry; ///< Entry in the table, nullptr for the empty path
+};
+
+
+/**
+*  @brief
+*    Statistics of the process-wide path table
+*/
+struct PathTableStatistics
+{
+    std::size_t paths;      ///< Number of distinct paths in the table
+    std::size_t references; ///< Number of handles referring to them
+    std::size_t characters; ///< Accumulated length of the paths
+    std::size_t bytes;      ///< Estimated memory held by the table (paths, entries, and buckets)
+    std::size_t lookups;    ///< Number of calls to internPath with a non-empty path
+    std::size_t hits;       ///< Number of lookups answered by an existing entry
+};
+
+
+/**
+*  @brief
+*    Get handle to a path in the process-wide table
+*
+*  @param[in] path
+*    Path
+*
+*  @return
+*    Handle sharing the entry of all equal paths, empty if path is empty
+*
+*  @remark
+*    The path is copied into the table only if it is not contained yet.
+*/
+CPPLOCATE_API Path internPath(const std::string & path);
+
+/**
+*  @brief
+*    Get statistics of the process-wide path table
+*
+*  @return
+*    Current size and cumulative lookup counts
+*/
+CPPLOCATE_API PathTableStatistics pathTableStatistics();
+
+
+} // namespace cpplocate
+
+
+namespace std
+{
+
+
+/**
+*  @brief
+*    Hash of a path handle (hashes the entry, not the characters)
+*/
+template <>
+struct hash<cpplocate::Path>
+{
+    std::size_t operator()(const cpplocate::Path & path) const
+    {
+        return std::hash<const void *>()(path.m_entry);
+    }
+};
+
+
+} // namespace std
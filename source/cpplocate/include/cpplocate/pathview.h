@@ -0,0 +1,370 @@
+
+#pragma once
+
+
+#include <cstddef>
+#include <string>
+
+#if __cplusplus >= 201703L
+    #include <string_view>
+#endif
+
+
+namespace cpplocate
+{
+
+
+/**
+*  @brief
+*    Non-owning, constexpr view of a path
+*
+*  @remark
+*    Allows path computations on string literals at compile time. The
+*    viewed characters are not required to be null-terminated.
+*/
+class PathView
+{
+public:
+    /**
+    *  @brief
+    *    Constructor (empty path)
+    */
+    constexpr PathView()
+    : m_data("")
+    , m_size(0)
+    {
+    }
+
+    /**
+    *  @brief
+    *    Constructor
+    *
+    *  @param[in] data
+    *    Characters of the path
+    *  @param[in] size
+    *    Number of characters
+    */
+    constexpr PathView(const char * data, std::size_t size)
+    : m_data(data)
+    , m_size(size)
+    {
+    }
+
+    /**
+    *  @brief
+    *    Constructor for string literals
+    *
+    *  @param[in] literal
+    *    String literal (the terminating null byte is not part of the path)
+    */
+    template <std::size_t N>
+    constexpr PathView(const char (&literal)[N])
+    : m_data(literal)
+    , m_size(N - 1)
+    {
+    }
+
+    /**
+    *  @brief
+    *    Get characters of the path
+    *
+    *  @return
+    *    Characters (not necessarily null-terminated)
+    */
+    constexpr const char * data() const
+    {
+        return m_data;
+    }
+
+    /**
+    *  @brief
+    *    Get number of characters
+    *
+    *  @return
+    *    Number of characters
+    */
+    constexpr std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+    *  @brief
+    *    Check if the path is empty
+    *
+    *  @return
+    *    'true' if the path has no characters, else 'false'
+    */
+    constexpr bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+    *  @brief
+    *    Get character
+    *
+    *  @param[in] index
+    *    Index of the character (must be less than size())
+    *
+    *  @return
+    *    Character
+    */
+    constexpr char operator[](std::size_t index) const
+    {
+        return m_data[index];
+    }
+
+    /**
+    *  @brief
+    *    Get part of the path
+    *
+    *  @param[in] pos
+    *    Index of the first character (must not exceed size())
+    *  @param[in] count
+    *    Maximum number of characters
+    *
+    *  @return
+    *    View of the characters [pos, pos + count)
+    */
+    constexpr PathView substr(std::size_t pos, std::size_t count) const
+    {
+        return PathView(m_data + pos, count < m_size - pos ? count : m_size - pos);
+    }
+
+    /**
+    *  @brief
+    *    Convert to string
+    *
+    *  @return
+    *    Copy of the characters
+    */
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+#if __cplusplus >= 201703L
+    /**
+    *  @brief
+    *    Convert to string view
+    */
+    constexpr operator std::string_view() const
+    {
+        return std::string_view(m_data, m_size);
+    }
+#endif
+
+protected:
+    const char * m_data; ///< Characters of the path
+    std::size_t m_size;  ///< Number of characters
+};
+
+
+/**
+*  @brief
+*    Index denoting 'not found'
+*/
+constexpr std::size_t pathNotFound = static_cast<std::size_t>(-1);
+
+
+namespace detail
+{
+
+
+constexpr bool equalsAt(PathView path, std::size_t pos, PathView pattern, std::size_t index)
+{
+    return index == pattern.size() || (path[pos + index] == pattern[index] && equalsAt(path, pos, pattern, index + 1));
+}
+
+constexpr std::size_t findLastFrom(PathView path, PathView pattern, std::size_t pos)
+{
+    return equalsAt(path, pos, pattern, 0) ? pos : (pos == 0 ? pathNotFound : findLastFrom(path, pattern, pos - 1));
+}
+
+constexpr std::size_t lastDelimiterBefore(PathView path, std::size_t end)
+{
+    return end == 0 ? path.size()
+        : (path[end - 1] == '/' || path[end - 1] == '\\') ? end - 1
+        : lastDelimiterBefore(path, end - 1);
+}
+
+constexpr PathView directoryPartAt(PathView path, std::size_t delimiter)
+{
+    return delimiter > 0 && delimiter < path.size() ? path.substr(0, delimiter) : path;
+}
+
+constexpr bool containsBackslashFrom(PathView path, std::size_t index)
+{
+    return index < path.size() && (path[index] == '\\' || containsBackslashFrom(path, index + 1));
+}
+
+constexpr PathView systemBasePathFrom(PathView path, std::size_t pattern);
+
+constexpr PathView systemBasePathMatch(PathView path, std::size_t pattern, std::size_t pos, std::size_t baseLength)
+{
+    return pos != pathNotFound ? path.substr(0, pos + baseLength) : systemBasePathFrom(path, pattern + 1);
+}
+
+// Patterns of getSystemBasePath for the default prefixes, in priority order
+constexpr PathView systemPattern(std::size_t pattern)
+{
+    return pattern == 0 ? PathView("/usr/bin/")
+        : pattern == 1 ? PathView("/usr/lib/")
+        : pattern == 2 ? PathView("/usr/lib32/")
+        : pattern == 3 ? PathView("/usr/lib64/")
+        : pattern == 4 ? PathView("/usr/local/bin/")
+        : pattern == 5 ? PathView("/usr/local/lib/")
+        : pattern == 6 ? PathView("/usr/local/lib32/")
+        : PathView("/usr/local/lib64/");
+}
+
+constexpr PathView systemBasePathFrom(PathView path, std::size_t pattern)
+{
+    return pattern == 8 ? PathView(path.data(), 0)
+        : systemBasePathMatch(path, pattern,
+            path.size() >= systemPattern(pattern).size() ? findLastFrom(path, systemPattern(pattern), path.size() - systemPattern(pattern).size()) : pathNotFound,
+            pattern < 4 ? 5 : 11);
+}
+
+
+} // namespace detail
+
+
+/**
+*  @brief
+*    Check if a character is a path delimiter
+*
+*  @param[in] c
+*    Character
+*
+*  @return
+*    'true' for '/' and '\', else 'false'
+*/
+constexpr bool isPathDelimiter(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+/**
+*  @brief
+*    Find the last occurrence of a pattern
+*
+*  @param[in] path
+*    Path
+*  @param[in] pattern
+*    Pattern to search for
+*
+*  @return
+*    Index of the last occurrence, pathNotFound if path does not contain pattern
+*/
+constexpr std::size_t findLast(PathView path, PathView pattern)
+{
+    return path.size() >= pattern.size() ? detail::findLastFrom(path, pattern, path.size() - pattern.size()) : pathNotFound;
+}
+
+/**
+*  @brief
+*    Check if a path starts with a prefix
+*
+*  @param[in] path
+*    Path
+*  @param[in] prefix
+*    Prefix
+*
+*  @return
+*    'true' if path starts with prefix, else 'false'
+*/
+constexpr bool startsWith(PathView path, PathView prefix)
+{
+    return path.size() >= prefix.size() && detail::equalsAt(path, 0, prefix, 0);
+}
+
+/**
+*  @brief
+*    Find the last path delimiter ('/' or '\')
+*
+*  @param[in] path
+*    Path
+*
+*  @return
+*    Index of the last delimiter, path.size() if path contains none
+*/
+constexpr std::size_t lastPathDelimiter(PathView path)
+{
+    return detail::lastDelimiterBefore(path, path.size());
+}
+
+/**
+*  @brief
+*    Cut away filename portion of a path
+*
+*  @param[in] path
+*    Path (e.g., '/path/to/file.txt')
+*
+*  @return
+*    Path to directory (e.g., '/path/to')
+*
+*  @remark
+*    Equivalent to getDirectoryPart of liblocate; a path without
+*    delimiter (apart from a leading one) is returned as a whole.
+*/
+constexpr PathView directoryPart(PathView path)
+{
+    return detail::directoryPartAt(path, lastPathDelimiter(path));
+}
+
+/**
+*  @brief
+*    Get path to the macOS application bundle of an executable directory
+*
+*  @param[in] path
+*    Path to executable directory (e.g., '/Applications/App.app/Contents/MacOS')
+*
+*  @return
+*    Path to bundle (e.g., '/Applications/App.app'), empty if path is not within a bundle
+*/
+constexpr PathView bundlePart(PathView path)
+{
+    return path.size() >= 15 && detail::equalsAt(path, path.size() - 15, PathView("/Contents/MacOS"), 0)
+        ? path.substr(0, path.size() - 15)
+        : PathView(path.data(), 0);
+}
+
+/**
+*  @brief
+*    Get the system base path of a path
+*
+*  @param[in] path
+*    Path (e.g., '/usr/local/lib/mylib.so')
+*
+*  @return
+*    Base path including the trailing delimiter (e.g., '/usr/local/'), empty if path is not a system path
+*
+*  @remark
+*    Equivalent to getSystemBasePath of liblocate for the default
+*    prefixes '/usr' and '/usr/local'. Prefixes registered at runtime
+*    (addSystemPrefix, LIBLOCATE_SYSTEM_PREFIXES) are not considered.
+*/
+constexpr PathView systemBasePath(PathView path)
+{
+    return detail::systemBasePathFrom(path, 0);
+}
+
+/**
+*  @brief
+*    Check if a path uses '/' as its only delimiter
+*
+*  @param[in] path
+*    Path
+*
+*  @return
+*    'true' if path contains no '\', else 'false'
+*/
+constexpr bool isUnified(PathView path)
+{
+    return !detail::containsBackslashFrom(path, 0);
+}
+
+
+} // namespace cpplocate
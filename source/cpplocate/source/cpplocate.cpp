@@ -1,43 +1,93 @@
 
 #include <cpplocate/cpplocate.h>
 
-#include <stdlib.h>
-
 #include <liblocate/liblocate.h>
 
+#include <core.h>
+
+#include "trace.h"
+
 
 namespace
 {
 
 
+char * reserveString(void * context, unsigned int length)
+{
+    auto & target = *static_cast<std::string *>(context);
+
+    // Keeps the capacity of reused strings
+    target.resize(length);
+
+    return &target[0];
+}
+
+void clearString(void * context)
+{
+    static_cast<std::string *>(context)->clear();
+}
+
 /**
 *  @brief
-*    Convert c-string to std::string.
+*    Get sink that lets the liblocate core write into a string
 *
-*  @param[in] path
-*    The character array
-*  @param[in] length
-*    The length of the character array (i.e., the number of characters)
+*  @param[in] target
+*    String (must outlive the sink)
 *
 *  @return
-*    The contents of path as string
+*    Sink
+*/
+StringSink stringSink(std::string & target)
+{
+    return StringSink{ &reserveString, &clearString, &target };
+}
+
+/**
+*  @brief
+*    Locate path, answering from and recording to the access trace
 *
-*  @remark
-*    The path-pointer is freed.
+*  @param[in] relPath
+*    Relative path to a file or directory
+*  @param[in] systemDir
+*    Subdirectory for system installs
+*  @param[in] symbol
+*    A symbol from the library
+*  @param[in] depth
+*    Upward search depth, part of the traced query
+*  @param[out] path
+*    Path to file or directory, empty if it could not be located
 */
-std::string obtainStringFromLibLocate(char * path, unsigned int length)
+void locateTraced(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth, std::string & path)
 {
-    if (path == nullptr || length == 0)
+    // Answer from the validated results of a previous run, if available
+    if (cpplocate::trace::replayLocatePath(relPath, systemDir, symbol, depth, path))
     {
-        return std::string();
+        return;
     }
 
-    auto result = std::string(path, length);
+    auto sink = stringSink(path);
 
-    // liblocate transfer ownership of pointer behind path variable
-    free(path);
+    ::locatePathTo(&sink, relPath.c_str(), (unsigned int)relPath.size(), systemDir.c_str(), (unsigned int)systemDir.size(), symbol, depth);
 
-    return result;
+    cpplocate::trace::recordLocatePath(relPath, systemDir, symbol, depth, path);
+}
+
+/**
+*  @brief
+*    Get buffer for results that are interned afterwards
+*
+*  @return
+*    Buffer of the calling thread
+*
+*  @remark
+*    Keeps its capacity, so looking up results that are already in the
+*    path table does not allocate.
+*/
+std::string & internBuffer()
+{
+    thread_local std::string buffer;
+
+    return buffer;
 }
 
 
@@ -50,191 +100,479 @@ namespace cpplocate
 
 std::string getExecutablePath()
 {
-    char * path = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::getExecutablePath(&path, &length);
+    ::executablePathTo(&sink);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(path, length);
+    return result;
 }
 
 std::string getBundlePath()
 {
-    char * path = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::getBundlePath(&path, &length);
+    ::bundlePathTo(&sink);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(path, length);
+    return result;
 }
 
 std::string getModulePath()
 {
-    char * path = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::getModulePath(&path, &length);
+    ::modulePathTo(&sink);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(path, length);
+    return result;
 }
 
 std::string getLibraryPath(void * symbol)
 {
-    char * path = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+
+    getLibraryPath(symbol, result);
+
+    return result;
+}
+
+void getLibraryPath(void * symbol, std::string & path)
+{
+    auto sink = stringSink(path);
+
+    ::libraryPathTo(symbol, &sink);
+
+    trace::recordLibraryPath(path);
+}
+
+void getLibraryPath(void * symbol, Path & path)
+{
+    auto & buffer = internBuffer();
+
+    getLibraryPath(symbol, buffer);
+
+    path = internPath(buffer);
+}
+
+std::string getCanonicalLibraryPath(void * symbol)
+{
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::canonicalLibraryPathTo(symbol, &sink);
+
+    return result;
+}
+
+std::string getCanonicalModulePath()
+{
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::canonicalModulePathTo(&sink);
+
+    return result;
+}
+
+std::string canonicalPath(const std::string & path)
+{
+    auto result = std::string();
+
+    canonicalPath(path, result);
+
+    return result;
+}
+
+void canonicalPath(const std::string & path, std::string & canonical)
+{
+    auto sink = stringSink(canonical);
+
+    ::canonicalPathTo(path.c_str(), (unsigned int)path.size(), &sink);
+}
+
+void canonicalPath(const std::string & path, Path & canonical)
+{
+    auto & buffer = internBuffer();
+
+    canonicalPath(path, buffer);
 
-    ::getLibraryPath(symbol, &path, &length);
+    canonical = internPath(buffer);
+}
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(path, length);
+void clearCanonicalCache()
+{
+    ::clearCanonicalCache();
 }
 
 std::string locatePath(const std::string & relPath, const std::string & systemDir, void * symbol)
 {
-    char * path = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
 
-    ::locatePath(&path, &length, relPath.c_str(), (unsigned int)relPath.size(), systemDir.c_str(), (unsigned int)systemDir.size(), symbol);
+    locatePath(relPath, systemDir, symbol, result);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(path, length);
+    return result;
 }
 
-std::string pathSeparator()
+void locatePath(const std::string & relPath, const std::string & systemDir, void * symbol, std::string & path)
 {
-    char sep;
+    locateTraced(relPath, systemDir, symbol, ::getSearchDepth(), path);
+}
 
-    ::pathSeparator(&sep);
+void locatePath(const std::string & relPath, const std::string & systemDir, void * symbol, Path & path)
+{
+    auto & buffer = internBuffer();
 
-    return std::string(1, sep);
+    locatePath(relPath, systemDir, symbol, buffer);
+
+    path = internPath(buffer);
 }
 
-std::string libPrefix()
+std::string locatePath(PathView relPath, PathView systemDir, void * symbol)
+{
+    // Recording and replaying work on strings
+    if (accessTraceMode() != AccessTraceMode::Disabled)
+    {
+        return locatePath(relPath.str(), systemDir.str(), symbol);
+    }
+
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::locatePathTo(&sink, relPath.data(), (unsigned int)relPath.size(), systemDir.data(), (unsigned int)systemDir.size(), symbol, ::getSearchDepth());
+
+    return result;
+}
+
+std::string locateCanonicalPath(const std::string & relPath, const std::string & systemDir, void * symbol)
 {
-    char * prefix = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
 
-    ::libPrefix(&prefix, &length);
+    locateCanonicalPath(relPath, systemDir, symbol, result);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(prefix, length);
+    return result;
 }
 
-std::string libExtension()
+void locateCanonicalPath(const std::string & relPath, const std::string & systemDir, void * symbol, std::string & path)
+{
+    auto sink = stringSink(path);
+
+    ::locateCanonicalPathTo(&sink, relPath.c_str(), (unsigned int)relPath.size(), systemDir.c_str(), (unsigned int)systemDir.size(), symbol);
+}
+
+std::string locatePath(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth)
 {
-    char * extension = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
 
-    ::libExtension(&extension, &length);
+    locateTraced(relPath, systemDir, symbol, depth, result);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(extension, length);
+    return result;
 }
 
-std::vector<std::string> libExtensions()
+void setNormalizedResults(bool enabled)
+{
+    ::setNormalizedResults(enabled ? 1 : 0);
+}
+
+std::string normalizePath(const std::string & path)
+{
+    return normalizePaths(std::vector<std::string>{ path }).front();
+}
+
+std::vector<std::string> normalizePaths(const std::vector<std::string> & paths)
 {
-    char ** extensions = nullptr;
+    // Store paths back to back as null-terminated strings
+    auto size = std::size_t(0);
+
+    for (const auto & path : paths)
+    {
+        size += path.size() + 1;
+    }
+
+    auto arena = std::vector<char>();
+    arena.reserve(size);
+
+    auto lengths = std::vector<unsigned int>();
+    lengths.reserve(paths.size());
+
+    for (const auto & path : paths)
+    {
+        arena.insert(arena.end(), path.begin(), path.end());
+        arena.push_back(0);
+        lengths.push_back(static_cast<unsigned int>(path.size()));
+    }
+
+    if (!paths.empty())
+    {
+        ::normalizePaths(arena.data(), lengths.data(), static_cast<unsigned int>(lengths.size()));
+    }
+
+    auto result = std::vector<std::string>();
+    result.reserve(paths.size());
+
+    auto offset = std::size_t(0);
+
+    for (const auto length : lengths)
+    {
+        result.emplace_back(arena.data() + offset, length);
+        offset += length + 1;
+    }
+
+    return result;
+}
+
+void setSearchDepth(unsigned int depth)
+{
+    ::setSearchDepth(depth);
+}
+
+unsigned int searchDepth()
+{
+    return ::getSearchDepth();
+}
+
+void setSearchCacheTimeToLive(std::chrono::milliseconds timeToLive)
+{
+    const auto milliseconds = timeToLive.count() > 0 ? timeToLive.count() : 0;
+
+    ::setSearchCacheTimeToLive(milliseconds < 0xFFFFFFFF ? static_cast<unsigned int>(milliseconds) : 0xFFFFFFFFu);
+}
+
+void clearSearchCache()
+{
+    ::clearSearchCache();
+}
+
+std::vector<LocatedPath> locateAllPaths(const std::string & relPath, const std::string & systemDir, void * symbol)
+{
+    char * paths = nullptr;
     unsigned int * lengths = nullptr;
+    unsigned char * stages = nullptr;
     unsigned int count = 0;
 
-    ::libExtensions(&extensions, &lengths, &count);
+    ::locateAllPaths(&paths, &lengths, &stages, &count, relPath.c_str(), (unsigned int)relPath.size(),
+        systemDir.c_str(), (unsigned int)systemDir.size(), symbol);
 
-    // Convert c-array of c-strings and handle memory ownership
-    auto result = std::vector<std::string>(count);
+    // Convert arena of c-strings and handle memory ownership
+    auto result = std::vector<LocatedPath>();
+    result.reserve(count);
 
+    auto offset = 0u;
     for (auto i = 0u; i < count; ++i)
     {
-        // Convert to string and free memory from liblocate
-        result[i] = obtainStringFromLibLocate(extensions[i], lengths[i]);
+        result.push_back(LocatedPath{ std::string(paths + offset, lengths[i]), static_cast<LocateStage>(stages[i]) });
+        offset += lengths[i] + 1;
     }
 
-    if (count > 0)
+    ::releaseMemory(paths);
+    ::releaseMemory(lengths);
+    ::releaseMemory(stages);
+
+    return result;
+}
+
+void addSystemPrefix(const std::string & prefix)
+{
+    ::addSystemPrefix(prefix.c_str(), (unsigned int)prefix.size());
+}
+
+void resetSystemPrefixes()
+{
+    ::resetSystemPrefixes();
+}
+
+std::string pathSeparator()
+{
+    char sep;
+
+    ::pathSeparator(&sep);
+
+    return std::string(1, sep);
+}
+
+std::string libPrefix()
+{
+    return traits::libPrefix().str();
+}
+
+std::string libExtension()
+{
+    return traits::libExtension().str();
+}
+
+std::vector<std::string> libExtensions()
+{
+    auto result = std::vector<std::string>();
+
+    for (const auto & extension : traits::libExtensions())
     {
-        free(extensions);
-        free(lengths);
+        result.push_back(extension.str());
     }
 
     return result;
 }
 
+std::vector<std::size_t> composeLibraryFileNames(const std::vector<std::string> & names, std::string & buffer)
+{
+    const auto prefix = traits::libPrefix();
+    const auto extensions = traits::libExtensions();
+
+    auto extensionsSize = std::size_t(0);
+    for (const auto & extension : extensions)
+    {
+        extensionsSize += extension.size();
+    }
+
+    // Each file name is '<prefix><name>.<extension>' followed by a null byte
+    auto size = std::size_t(0);
+    for (const auto & name : names)
+    {
+        size += (prefix.size() + name.size() + 2) * extensions.size() + extensionsSize;
+    }
+
+    buffer.clear();
+    buffer.reserve(size);
+
+    auto offsets = std::vector<std::size_t>();
+    offsets.reserve(names.size() * extensions.size() + 1);
+
+    for (const auto & name : names)
+    {
+        for (const auto & extension : extensions)
+        {
+            offsets.push_back(buffer.size());
+
+            buffer.append(prefix.data(), prefix.size());
+            buffer.append(name);
+            buffer.push_back('.');
+            buffer.append(extension.data(), extension.size());
+            buffer.push_back('\0');
+        }
+    }
+
+    offsets.push_back(buffer.size());
+
+    return offsets;
+}
+
 std::string homeDir()
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::homeDirTo(&sink);
+
+    return result;
+}
 
-    ::homeDir(&dir, &length);
+void refreshEnvironment()
+{
+    ::refreshEnvironment();
+}
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+void clearHomeDirCache()
+{
+    ::clearHomeDirCache();
 }
 
 std::string profileDir()
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::profileDir(&dir, &length);
+    ::homeDirTo(&sink);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+    return result;
 }
 
 std::string documentDir()
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::documentDir(&dir, &length);
+    ::homeDirTo(&sink);
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+    return result;
 }
 
 std::string roamingDir(const std::string & application)
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::roamingDir(&dir, &length, application.c_str(), (unsigned int)application.size());
+    ::applicationDirectoryTo(&sink, ConfigDirectory, application.c_str(), (unsigned int)application.size());
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+    return result;
 }
 
 std::string localDir(const std::string & application)
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::localDir(&dir, &length, application.c_str(), (unsigned int)application.size());
+    ::applicationDirectoryTo(&sink, LocalDirectory, application.c_str(), (unsigned int)application.size());
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+    return result;
 }
 
 std::string configDir(const std::string & application)
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::configDir(&dir, &length, application.c_str(), (unsigned int)application.size());
+    ::applicationDirectoryTo(&sink, ConfigDirectory, application.c_str(), (unsigned int)application.size());
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+    return result;
 }
 
 std::string tempDir(const std::string & application)
 {
-    char * dir = nullptr;
-    unsigned int length = 0;
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::applicationDirectoryTo(&sink, TemporaryDirectory, application.c_str(), (unsigned int)application.size());
+
+    return result;
+}
+
+std::string dataDir(const std::string & application)
+{
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::applicationDirectoryTo(&sink, DataDirectory, application.c_str(), (unsigned int)application.size());
+
+    return result;
+}
+
+std::string cacheDir(const std::string & application)
+{
+    auto result = std::string();
+    auto sink = stringSink(result);
 
-    ::tempDir(&dir, &length, application.c_str(), (unsigned int)application.size());
+    ::applicationDirectoryTo(&sink, CacheDirectory, application.c_str(), (unsigned int)application.size());
 
-    // Convert to string and free memory from liblocate
-    return obtainStringFromLibLocate(dir, length);
+    return result;
+}
+
+std::string stateDir(const std::string & application)
+{
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::applicationDirectoryTo(&sink, StateDirectory, application.c_str(), (unsigned int)application.size());
+
+    return result;
+}
+
+std::string runtimeDir(const std::string & application)
+{
+    auto result = std::string();
+    auto sink = stringSink(result);
+
+    ::applicationDirectoryTo(&sink, RuntimeDirectory, application.c_str(), (unsigned int)application.size());
+
+    return result;
 }
 
 
@@ -0,0 +1,121 @@
+
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+
+#if !defined(SYSTEM_WINDOWS)
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(SYSTEM_LINUX)
+    #include <sys/syscall.h>
+#endif
+
+
+namespace cpplocate
+{
+
+
+#if defined(SYSTEM_LINUX) && defined(SYS_getdents64)
+
+/**
+*  @brief
+*    Directory entry as returned by getdents64
+*/
+struct DirectoryEntry64
+{
+    std::uint64_t inode;
+    std::int64_t offset;
+    unsigned short length;
+    unsigned char type;
+    char name[1];
+};
+
+#endif
+
+#if !defined(SYSTEM_WINDOWS)
+
+/**
+*  @brief
+*    Visit all entries of a directory
+*
+*  @param[in] directory
+*    Path to directory
+*  @param[in] visit
+*    Callback invoked with the descriptor of the open directory, the
+*    entry name, and the entry type (DT_* constant, 0 if unknown)
+*
+*  @return
+*    'true' if the directory could be opened, else 'false'
+*
+*  @remark
+*    On Linux, entries are read in large batches with getdents64, so
+*    that a directory is usually listed with very few system calls.
+*/
+template <typename Visitor>
+bool forEachDirectoryEntry(const std::string & directory, Visitor && visit)
+{
+#if defined(SYSTEM_LINUX) && defined(SYS_getdents64)
+    const auto descriptor = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+    // Read many entries per system call
+    std::uint64_t buffer[8192];
+
+    for (;;)
+    {
+        const auto bytes = syscall(SYS_getdents64, descriptor, buffer, sizeof(buffer));
+
+        if (bytes <= 0)
+        {
+            break;
+        }
+
+        const auto data = reinterpret_cast<const char *>(buffer);
+
+        for (auto position = 0l; position < bytes; )
+        {
+            const auto entry = reinterpret_cast<const DirectoryEntry64 *>(data + position);
+
+            visit(descriptor, static_cast<const char *>(entry->name), entry->type);
+
+            position += entry->length;
+        }
+    }
+
+    close(descriptor);
+#else
+    const auto dir = opendir(directory.c_str());
+
+    if (dir == nullptr)
+    {
+        return false;
+    }
+
+    while (const auto entry = readdir(dir))
+    {
+    #if defined(DT_REG)
+        visit(dirfd(dir), static_cast<const char *>(entry->d_name), static_cast<unsigned char>(entry->d_type));
+    #else
+        visit(dirfd(dir), static_cast<const char *>(entry->d_name), static_cast<unsigned char>(0));
+    #endif
+    }
+
+    closedir(dir);
+#endif
+
+    return true;
+}
+
+#endif
+
+
+} // namespace cpplocate
@@ -0,0 +1,368 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <liblocate/liblocate.h>
+
+#include "directory.h"
+
+
+namespace
+{
+
+
+#if defined(SYSTEM_WINDOWS)
+    const char pathListDelimiter = ';';
+#else
+    const char pathListDelimiter = ':';
+#endif
+
+/**
+*  @brief
+*    Names of the entries of a directory in PATH
+*/
+struct DirectoryIndex
+{
+    DirectoryIndex()
+    : exists(false)
+    , stable(false)
+    , network(false)
+    , modified(0)
+    {
+    }
+
+    bool exists;                                     ///< 'true' if the directory could be listed
+    bool stable;                                     ///< 'false' if the directory changed too recently to trust its modification time
+    bool network;                                    ///< 'true' if the directory is on a network filesystem
+    std::int64_t modified;                           ///< Modification time of the directory (nanoseconds)
+    std::chrono::steady_clock::time_point validated; ///< Time of the last modification time check
+    std::unordered_set<std::string> names;           ///< Names of the entries that may be executables
+};
+
+/**
+*  @brief
+*    Process-wide index of the directories in PATH
+*/
+struct ExecutableIndex
+{
+    std::mutex mutex;
+    std::string path;                             ///< Value of PATH the directories were taken from
+    std::vector<std::string> directories;         ///< Directories in PATH, in search order
+    std::map<std::string, DirectoryIndex> indices; ///< Index by directory, built on first use
+};
+
+ExecutableIndex & executableIndex()
+{
+    static ExecutableIndex instance;
+
+    return instance;
+}
+
+#if defined(SYSTEM_WINDOWS)
+std::string normalizeName(const std::string & name)
+{
+    // File names are case-insensitive
+    auto result = name;
+    std::transform(result.begin(), result.end(), result.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+    return result;
+}
+#endif
+
+std::vector<std::string> splitPathList(const std::string & list)
+{
+    auto directories = std::vector<std::string>();
+
+    for (auto start = std::size_t(0); start <= list.size(); )
+    {
+        auto end = list.find(pathListDelimiter, start);
+
+        if (end == std::string::npos)
+        {
+            end = list.size();
+        }
+
+        // An empty entry denotes the current directory
+        directories.push_back(end > start ? list.substr(start, end - start) : std::string("."));
+
+        start = end + 1;
+    }
+
+    return directories;
+}
+
+/**
+*  @brief
+*    Get candidate file names of an executable
+*
+*  @remark
+*    On Windows, the extensions in PATHEXT are appended to names without extension.
+*/
+std::vector<std::string> candidateNames(const std::string & name)
+{
+#if defined(SYSTEM_WINDOWS)
+    if (name.find('.') != std::string::npos)
+    {
+        return std::vector<std::string>{ normalizeName(name) };
+    }
+
+    const auto extensions = ::environmentValue("PATHEXT", 7, nullptr);
+    auto candidates = std::vector<std::string>();
+
+    for (const auto & extension : splitPathList(extensions != nullptr ? extensions : ".COM;.EXE;.BAT;.CMD"))
+    {
+        if (extension != ".")
+        {
+            candidates.push_back(normalizeName(name + extension));
+        }
+    }
+
+    return candidates;
+#else
+    return std::vector<std::string>{ name };
+#endif
+}
+
+std::string joinPath(const std::string & directory, const std::string & fileName)
+{
+    const auto last = directory.back();
+
+    return last == '/' || last == '\\' ? directory + fileName : directory + '/' + fileName;
+}
+
+bool isExecutable(const std::string & path)
+{
+#if defined(SYSTEM_WINDOWS)
+    const auto attributes = GetFileAttributesA(path.c_str());
+
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+#else
+    struct stat info;
+
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) && access(path.c_str(), X_OK) == 0;
+#endif
+}
+
+/**
+*  @brief
+*    Get modification time of a directory
+*
+*  @return
+*    'true' if the directory exists, else 'false'
+*/
+bool directoryModified(const std::string & directory, std::int64_t & modified)
+{
+#if defined(SYSTEM_WINDOWS)
+    WIN32_FILE_ATTRIBUTE_DATA info;
+
+    if (!GetFileAttributesExA(directory.c_str(), GetFileExInfoStandard, &info) || (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+    {
+        return false;
+    }
+
+    // Convert from 100ns intervals since 1601 to nanoseconds since 1970
+    const auto fileTime = (static_cast<std::uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+    modified = (static_cast<std::int64_t>(fileTime) - 116444736000000000ll) * 100;
+#else
+    struct stat info;
+
+    if (stat(directory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+    {
+        return false;
+    }
+
+    #if defined(SYSTEM_LINUX)
+        modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000ll + info.st_mtim.tv_nsec;
+    #elif defined(SYSTEM_DARWIN)
+        modified = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000ll + info.st_mtimespec.tv_nsec;
+    #else
+        modified = static_cast<std::int64_t>(info.st_mtime) * 1000000000ll;
+    #endif
+#endif
+
+    return true;
+}
+
+void listDirectory(const std::string & directory, DirectoryIndex & result)
+{
+    result.names.clear();
+
+#if defined(SYSTEM_WINDOWS)
+    WIN32_FIND_DATAA entry;
+    const auto handle = FindFirstFileA(joinPath(directory, "*").c_str(), &entry);
+
+    result.exists = handle != INVALID_HANDLE_VALUE;
+
+    if (!result.exists)
+    {
+        return;
+    }
+
+    do
+    {
+        if ((entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+        {
+            result.names.insert(normalizeName(entry.cFileName));
+        }
+    }
+    while (FindNextFileA(handle, &entry));
+
+    FindClose(handle);
+#else
+    result.exists = cpplocate::forEachDirectoryEntry(directory, [&result](int, const char * fileName, unsigned char type)
+    {
+        #if defined(DT_REG)
+            if (type != DT_REG && type != DT_LNK && type != DT_UNKNOWN)
+            {
+                return;
+            }
+        #else
+            (void)type;
+        #endif
+
+        result.names.insert(fileName);
+    });
+#endif
+}
+
+/**
+*  @brief
+*    Bring the index of a directory up to date
+*
+*  @return
+*    'true' if the directory exists, else 'false'
+*/
+bool updateIndex(const std::string & directory, DirectoryIndex & result)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    // Each check is a round trip on network filesystems, so it is done at most once per second there
+    if (result.exists && result.stable && result.network && now - result.validated < std::chrono::seconds(1))
+    {
+        return true;
+    }
+
+    result.validated = now;
+
+    auto modified = std::int64_t(0);
+
+    if (!directoryModified(directory, modified))
+    {
+        result = DirectoryIndex();
+        return false;
+    }
+
+    if (result.exists && result.stable && result.modified == modified)
+    {
+        return true;
+    }
+
+    listDirectory(directory, result);
+
+    result.network = cpplocate::filesystemInfo(directory).kind == cpplocate::FilesystemKind::Network;
+
+    // Changes within the same clock tick may not update the modification
+    // time, so the index of a recently modified directory is rebuilt until
+    // the modification lies at least a second in the past
+    const auto wallClock = static_cast<std::int64_t>(std::time(nullptr)) * 1000000000ll;
+
+    result.modified = modified;
+    result.stable = modified < wallClock - 1000000000ll;
+
+    return result.exists;
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+std::string findExecutable(const std::string & name)
+{
+    if (name.empty())
+    {
+        return std::string();
+    }
+
+    // Paths are not searched in PATH
+    if (name.find_first_of("/\\") != std::string::npos)
+    {
+        return isExecutable(name) ? name : std::string();
+    }
+
+    const auto candidates = candidateNames(name);
+
+    auto & instance = executableIndex();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    const auto path = ::environmentValue("PATH", 4, nullptr);
+
+    if (path == nullptr)
+    {
+        return std::string();
+    }
+
+    // Directories of PATH, updated when the environment is refreshed
+    if (instance.path != path || instance.directories.empty())
+    {
+        instance.path = path;
+        instance.directories = splitPathList(instance.path);
+    }
+
+    for (const auto & directory : instance.directories)
+    {
+        auto & directoryIndex = instance.indices[directory];
+
+        if (!updateIndex(directory, directoryIndex))
+        {
+            continue;
+        }
+
+        for (const auto & candidate : candidates)
+        {
+            if (directoryIndex.names.count(candidate) == 0)
+            {
+                continue;
+            }
+
+            const auto result = joinPath(directory, candidate);
+
+            if (isExecutable(result))
+            {
+                return result;
+            }
+        }
+    }
+
+    return std::string();
+}
+
+void clearExecutableCache()
+{
+    auto & instance = executableIndex();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    instance.path.clear();
+    instance.directories.clear();
+    instance.indices.clear();
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,526 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+    #include <io.h>
+    #include <direct.h>
+    #include <fcntl.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <liblocate/liblocate.h>
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Identity of a file (device and inode, or volume and file index on Windows)
+*/
+using FileIdentity = std::pair<std::uint64_t, std::uint64_t>;
+
+/**
+*  @brief
+*    Shared mapping of a file and the state of the file it was created from
+*/
+struct RegisteredMapping
+{
+    std::size_t size;                                   ///< Size of the file
+    std::int64_t modified;                              ///< Last modification time of the file (nanoseconds since epoch)
+    std::weak_ptr<const cpplocate::MappedFile> mapping; ///< Mapping, expired once released by all callers
+};
+
+/**
+*  @brief
+*    Process-wide registry of shared mappings
+*/
+struct MappingRegistry
+{
+    MappingRegistry()
+    : sweepSize(64)
+    {
+    }
+
+    std::mutex mutex;
+    std::map<FileIdentity, RegisteredMapping> mappings;
+    std::size_t sweepSize; ///< Number of entries at which released mappings are dropped
+};
+
+MappingRegistry & registry()
+{
+    static MappingRegistry instance;
+
+    return instance;
+}
+
+void closeDescriptor(int descriptor)
+{
+#if defined(SYSTEM_WINDOWS)
+    _close(descriptor);
+#else
+    close(descriptor);
+#endif
+}
+
+/**
+*  @brief
+*    Get identity, size, and modification time of an open file
+*
+*  @return
+*    'true' on success, else 'false'
+*/
+bool fileIdentity(int descriptor, FileIdentity & identity, std::size_t & size, std::int64_t & modified)
+{
+#if defined(SYSTEM_WINDOWS)
+    BY_HANDLE_FILE_INFORMATION info;
+
+    if (!GetFileInformationByHandle(reinterpret_cast<HANDLE>(_get_osfhandle(descriptor)), &info))
+    {
+        return false;
+    }
+
+    identity.first = info.dwVolumeSerialNumber;
+    identity.second = (static_cast<std::uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    size = static_cast<std::size_t>((static_cast<std::uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow);
+
+    // Convert from 100ns intervals since 1601 to nanoseconds since 1970
+    const auto fileTime = (static_cast<std::uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+    modified = (static_cast<std::int64_t>(fileTime) - 116444736000000000ll) * 100;
+#else
+    struct stat info;
+
+    if (fstat(descriptor, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        return false;
+    }
+
+    identity.first = static_cast<std::uint64_t>(info.st_dev);
+    identity.second = static_cast<std::uint64_t>(info.st_ino);
+    size = static_cast<std::size_t>(info.st_size);
+
+    #if defined(SYSTEM_LINUX)
+        modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000ll + info.st_mtim.tv_nsec;
+    #elif defined(SYSTEM_DARWIN)
+        modified = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000ll + info.st_mtimespec.tv_nsec;
+    #else
+        modified = static_cast<std::int64_t>(info.st_mtime) * 1000000000ll;
+    #endif
+#endif
+
+    return true;
+}
+
+/**
+*  @brief
+*    Map an open file read-only into memory
+*
+*  @return
+*    Mapping, nullptr on error
+*/
+std::shared_ptr<const cpplocate::MappedFile> mapDescriptor(int descriptor, std::size_t size)
+{
+    if (size == 0)
+    {
+        return std::make_shared<const cpplocate::MappedFile>(nullptr, 0, nullptr);
+    }
+
+#if defined(SYSTEM_WINDOWS)
+    const auto mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(_get_osfhandle(descriptor)), nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr)
+    {
+        return nullptr;
+    }
+
+    const auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        return nullptr;
+    }
+
+    return std::make_shared<const cpplocate::MappedFile>(static_cast<const char *>(data), size, mapping);
+#else
+    const auto data = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    return std::make_shared<const cpplocate::MappedFile>(static_cast<const char *>(data), size, nullptr);
+#endif
+}
+
+bool isDelimiter(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+/**
+*  @brief
+*    Open an existing directory
+*
+*  @return
+*    File descriptor, -1 on error
+*/
+int openDirectory(const std::string & path)
+{
+#if defined(SYSTEM_WINDOWS)
+    const auto handle = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        errno = GetLastError() == ERROR_FILE_NOT_FOUND || GetLastError() == ERROR_PATH_NOT_FOUND ? ENOENT : EACCES;
+        return -1;
+    }
+
+    const auto descriptor = _open_osfhandle(reinterpret_cast<intptr_t>(handle), _O_RDONLY);
+
+    if (descriptor < 0)
+    {
+        CloseHandle(handle);
+    }
+
+    return descriptor;
+#else
+    return open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+}
+
+/**
+*  @brief
+*    Create a directory below an open directory and open it
+*
+*  @param[in] parent
+*    Descriptor of the parent directory
+*  @param[in] parentPath
+*    Path of the parent directory (used where no *at() functions exist)
+*  @param[in] name
+*    Name of the directory
+*  @param[in] mode
+*    Permissions of the directory, if created
+*
+*  @return
+*    File descriptor of the directory, -1 on error
+*
+*  @remark
+*    A directory created concurrently by another process is accepted.
+*/
+int createDirectoryAt(int parent, const std::string & parentPath, const std::string & name, unsigned int mode)
+{
+#if defined(SYSTEM_WINDOWS)
+    (void)parent;
+    (void)mode;
+
+    const auto path = parentPath.empty() || isDelimiter(parentPath.back()) ? parentPath + name : parentPath + '\\' + name;
+
+    if (_mkdir(path.c_str()) != 0 && errno != EEXIST)
+    {
+        return -1;
+    }
+
+    return openDirectory(path);
+#else
+    (void)parentPath;
+
+    // Retry once if a concurrent process removed the directory in between
+    for (auto attempt = 0; attempt < 2; ++attempt)
+    {
+        if (mkdirat(parent, name.c_str(), static_cast<mode_t>(mode)) != 0 && errno != EEXIST)
+        {
+            return -1;
+        }
+
+        const auto descriptor = openat(parent, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+        if (descriptor >= 0 || errno != ENOENT)
+        {
+            return descriptor;
+        }
+    }
+
+    return -1;
+#endif
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+FileHandle::FileHandle()
+: m_descriptor(-1)
+{
+}
+
+FileHandle::FileHandle(int descriptor)
+: m_descriptor(descriptor)
+{
+}
+
+FileHandle::FileHandle(FileHandle && other)
+: m_descriptor(other.release())
+{
+}
+
+FileHandle::~FileHandle()
+{
+    if (m_descriptor >= 0)
+    {
+        closeDescriptor(m_descriptor);
+    }
+}
+
+FileHandle & FileHandle::operator=(FileHandle && other)
+{
+    if (this != &other)
+    {
+        if (m_descriptor >= 0)
+        {
+            closeDescriptor(m_descriptor);
+        }
+
+        m_descriptor = other.release();
+    }
+
+    return *this;
+}
+
+int FileHandle::get() const
+{
+    return m_descriptor;
+}
+
+bool FileHandle::valid() const
+{
+    return m_descriptor >= 0;
+}
+
+int FileHandle::release()
+{
+    const auto descriptor = m_descriptor;
+    m_descriptor = -1;
+
+    return descriptor;
+}
+
+
+MappedFile::MappedFile(const char * data, std::size_t size, void * mapping)
+: m_data(data)
+, m_size(size)
+, m_mapping(mapping)
+{
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(SYSTEM_WINDOWS)
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+#else
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<char *>(m_data), m_size);
+    }
+#endif
+}
+
+const char * MappedFile::data() const
+{
+    return m_data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+
+FileHandle openLocated(const std::string & relPath, const std::string & systemDir, void * symbol)
+{
+    const auto descriptor = ::openLocatedFile(nullptr, nullptr, relPath.c_str(), (unsigned int)relPath.size(),
+        systemDir.c_str(), (unsigned int)systemDir.size(), symbol);
+
+    return FileHandle(descriptor);
+}
+
+std::shared_ptr<const MappedFile> mapLocated(const std::string & relPath, const std::string & systemDir, void * symbol)
+{
+    const auto file = openLocated(relPath, systemDir, symbol);
+
+    if (!file.valid())
+    {
+        return nullptr;
+    }
+
+    auto identity = FileIdentity();
+    auto size = std::size_t(0);
+    auto modified = std::int64_t(0);
+
+    if (!fileIdentity(file.get(), identity, size, modified))
+    {
+        return nullptr;
+    }
+
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    const auto it = instance.mappings.find(identity);
+
+    // Reuse the mapping only if the file was not rewritten in place since
+    if (it != instance.mappings.end() && it->second.size == size && it->second.modified == modified)
+    {
+        if (auto mapping = it->second.mapping.lock())
+        {
+            return mapping;
+        }
+    }
+
+    auto mapping = mapDescriptor(file.get(), size);
+
+    if (mapping == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (it != instance.mappings.end())
+    {
+        it->second = RegisteredMapping{ size, modified, mapping };
+
+        return mapping;
+    }
+
+    // Drop entries of released mappings of other files once the registry doubled in size, keeping insertion amortized constant
+    if (instance.mappings.size() >= instance.sweepSize)
+    {
+        for (auto entry = instance.mappings.begin(); entry != instance.mappings.end(); )
+        {
+            entry = entry->second.mapping.expired() ? instance.mappings.erase(entry) : std::next(entry);
+        }
+
+        instance.sweepSize = std::max(std::size_t(64), 2 * instance.mappings.size());
+    }
+
+    instance.mappings.emplace(identity, RegisteredMapping{ size, modified, mapping });
+
+    return mapping;
+}
+
+FileHandle ensureDir(const std::string & path, unsigned int mode)
+{
+    auto end = path.size();
+
+    while (end > 1 && isDelimiter(path[end - 1]))
+    {
+        --end;
+    }
+
+    if (end == 0)
+    {
+        return FileHandle();
+    }
+
+    // Find the deepest existing ancestor, probing backwards from the full path
+    auto existing = end;
+    auto descriptor = openDirectory(path.substr(0, existing));
+
+    while (descriptor < 0 && errno == ENOENT)
+    {
+        const auto previous = existing;
+
+        while (existing > 0 && !isDelimiter(path[existing - 1]))
+        {
+            --existing;
+        }
+
+        while (existing > 1 && isDelimiter(path[existing - 1]))
+        {
+            --existing;
+        }
+
+        if (existing == previous)
+        {
+            break;
+        }
+
+        descriptor = openDirectory(existing > 0 ? path.substr(0, existing) : std::string("."));
+    }
+
+    if (descriptor < 0)
+    {
+        return FileHandle();
+    }
+
+    // Create missing components relative to their parent
+    auto handle = FileHandle(descriptor);
+
+    for (auto begin = existing; begin < end; )
+    {
+        while (begin < end && isDelimiter(path[begin]))
+        {
+            ++begin;
+        }
+
+        auto next = begin;
+
+        while (next < end && !isDelimiter(path[next]))
+        {
+            ++next;
+        }
+
+        if (next == begin)
+        {
+            break;
+        }
+
+        handle = FileHandle(createDirectoryAt(handle.get(), path.substr(0, begin), path.substr(begin, next - begin), mode));
+
+        if (!handle.valid())
+        {
+            break;
+        }
+
+        begin = next;
+    }
+
+    return handle;
+}
+
+FileHandle ensureConfigDir(const std::string & application)
+{
+    const auto dir = configDir(application);
+
+    return dir.empty() ? FileHandle() : ensureDir(dir, 0700);
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,440 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(SYSTEM_LINUX)
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/statvfs.h>
+    #include <sys/sysmacros.h>
+    #include <sys/vfs.h>
+#elif defined(SYSTEM_DARWIN) || defined(SYSTEM_FREEBSD)
+    #include <sys/param.h>
+    #include <sys/mount.h>
+#elif !defined(SYSTEM_WINDOWS)
+    #include <sys/statvfs.h>
+#endif
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Classify a filesystem by its type name
+*/
+cpplocate::FilesystemKind kindOfType(const std::string & type)
+{
+    static const char * const memoryTypes[] = { "tmpfs", "ramfs" };
+    static const char * const networkTypes[] = {
+        "nfs", "nfs4", "cifs", "smb3", "smbfs", "afs", "ceph", "9p", "lustre", "gpfs", "glusterfs",
+        "fuse.sshfs", "fuse.glusterfs", "fuse.s3fs", "fuse.gcsfuse", "fuse.cephfs", "webdav", "afpfs"
+    };
+
+    for (const auto memoryType : memoryTypes)
+    {
+        if (type == memoryType)
+        {
+            return cpplocate::FilesystemKind::Memory;
+        }
+    }
+
+    for (const auto networkType : networkTypes)
+    {
+        if (type == networkType)
+        {
+            return cpplocate::FilesystemKind::Network;
+        }
+    }
+
+    return type.empty() ? cpplocate::FilesystemKind::Unknown : cpplocate::FilesystemKind::Local;
+}
+
+#if defined(SYSTEM_LINUX)
+
+/**
+*  @brief
+*    Entry of /proc/self/mountinfo
+*/
+struct MountEntry
+{
+    std::uint64_t device;
+    std::string mountPoint;
+    std::string type;
+    std::string source;
+    bool readOnly;
+    bool noAccessTime;
+};
+
+/**
+*  @brief
+*    Parsed mount table, indexed by mount ID
+*
+*  @remark
+*    The kernel signals changes of the mount table by POLLPRI on an open
+*    mountinfo descriptor, so the table is only parsed again after
+*    something was mounted or unmounted.
+*/
+struct MountTable
+{
+    MountTable()
+    : descriptor(-1)
+    , parsed(false)
+    {
+    }
+
+    std::mutex mutex;
+    int descriptor;
+    bool parsed;
+    std::map<std::uint64_t, MountEntry> mounts;
+};
+
+MountTable & mountTable()
+{
+    static MountTable instance;
+
+    return instance;
+}
+
+/**
+*  @brief
+*    Decode octal escapes of mountinfo fields (e.g., '\040' for space)
+*/
+std::string unescape(const std::string & field)
+{
+    auto result = std::string();
+    result.reserve(field.size());
+
+    for (auto i = std::size_t(0); i < field.size(); ++i)
+    {
+        if (field[i] == '\\' && i + 3 < field.size() && field[i + 1] >= '0' && field[i + 1] <= '7')
+        {
+            result.push_back(static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0')));
+            i += 3;
+        }
+        else
+        {
+            result.push_back(field[i]);
+        }
+    }
+
+    return result;
+}
+
+bool hasOption(const std::string & options, const char * option)
+{
+    std::istringstream stream(options);
+
+    for (auto value = std::string(); std::getline(stream, value, ','); )
+    {
+        if (value == option)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void parseMountInfo(std::map<std::uint64_t, MountEntry> & mounts)
+{
+    mounts.clear();
+
+    std::ifstream stream("/proc/self/mountinfo");
+
+    for (auto line = std::string(); std::getline(stream, line); )
+    {
+        std::istringstream fields(line);
+
+        auto id = std::uint64_t(0);
+        auto parent = std::uint64_t(0);
+        auto device = std::string();
+        auto root = std::string();
+        auto mountPoint = std::string();
+        auto options = std::string();
+
+        if (!(fields >> id >> parent >> device >> root >> mountPoint >> options))
+        {
+            continue;
+        }
+
+        // Skip optional fields up to the separator
+        auto field = std::string();
+
+        while (fields >> field && field != "-")
+        {
+        }
+
+        auto entry = MountEntry();
+
+        if (!(fields >> entry.type >> entry.source))
+        {
+            continue;
+        }
+
+        const auto colon = device.find(':');
+
+        if (colon == std::string::npos)
+        {
+            continue;
+        }
+
+        entry.device = makedev(std::stoul(device.substr(0, colon)), std::stoul(device.substr(colon + 1)));
+        entry.mountPoint = unescape(mountPoint);
+        entry.source = unescape(entry.source);
+        entry.readOnly = hasOption(options, "ro");
+        entry.noAccessTime = hasOption(options, "noatime");
+
+        mounts[id] = std::move(entry);
+    }
+}
+
+/**
+*  @brief
+*    Find the mount entry of a path
+*
+*  @return
+*    'true' if the mount was found, else 'false'
+*/
+bool findMount(const std::string & path, const struct stat & info, MountEntry & result)
+{
+    auto mountId = std::uint64_t(0);
+    auto hasMountId = false;
+
+#if defined(STATX_MNT_ID)
+    struct statx extended;
+
+    if (statx(AT_FDCWD, path.c_str(), 0, STATX_MNT_ID, &extended) == 0 && (extended.stx_mask & STATX_MNT_ID) != 0)
+    {
+        mountId = extended.stx_mnt_id;
+        hasMountId = true;
+    }
+#else
+    (void)path;
+#endif
+
+    auto & table = mountTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    if (table.descriptor < 0)
+    {
+        table.descriptor = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+    }
+
+    // Parse again if the mount table changed since
+    auto changed = !table.parsed;
+
+    if (table.descriptor >= 0)
+    {
+        struct pollfd request = { table.descriptor, POLLPRI, 0 };
+
+        // Polling also acknowledges the change
+        if (poll(&request, 1, 0) > 0 && (request.revents & (POLLPRI | POLLERR)) != 0)
+        {
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        parseMountInfo(table.mounts);
+        table.parsed = true;
+    }
+
+    if (hasMountId)
+    {
+        const auto it = table.mounts.find(mountId);
+
+        if (it != table.mounts.end())
+        {
+            result = it->second;
+            return true;
+        }
+    }
+
+    // Without mount IDs, use the most recent mount of the device
+    const MountEntry * match = nullptr;
+
+    for (const auto & mount : table.mounts)
+    {
+        if (mount.second.device == static_cast<std::uint64_t>(info.st_dev))
+        {
+            match = &mount.second;
+        }
+    }
+
+    if (match != nullptr)
+    {
+        result = *match;
+    }
+
+    return match != nullptr;
+}
+
+#endif
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+FilesystemInfo filesystemInfo(const std::string & path)
+{
+    auto result = FilesystemInfo();
+    result.kind = FilesystemKind::Unknown;
+    result.blockSize = 0;
+    result.freeBytes = 0;
+    result.totalBytes = 0;
+    result.readOnly = false;
+    result.noAccessTime = false;
+    result.valid = false;
+
+#if defined(SYSTEM_LINUX)
+    struct stat info;
+    struct statfs filesystem;
+
+    if (path.empty() || stat(path.c_str(), &info) != 0 || statfs(path.c_str(), &filesystem) != 0)
+    {
+        return result;
+    }
+
+    result.valid = true;
+    result.blockSize = static_cast<std::uint64_t>(filesystem.f_bsize);
+    result.freeBytes = static_cast<std::uint64_t>(filesystem.f_bavail) * static_cast<std::uint64_t>(filesystem.f_frsize);
+    result.totalBytes = static_cast<std::uint64_t>(filesystem.f_blocks) * static_cast<std::uint64_t>(filesystem.f_frsize);
+    result.readOnly = (filesystem.f_flags & ST_RDONLY) != 0;
+    result.noAccessTime = (filesystem.f_flags & ST_NOATIME) != 0;
+
+    auto mount = MountEntry();
+
+    if (findMount(path, info, mount))
+    {
+        result.type = mount.type;
+        result.mountPoint = mount.mountPoint;
+        result.source = mount.source;
+        result.readOnly = result.readOnly || mount.readOnly;
+        result.noAccessTime = result.noAccessTime || mount.noAccessTime;
+        result.kind = kindOfType(mount.type);
+    }
+    else
+    {
+        // No mount table (e.g., /proc not mounted), classify by magic number
+        switch (static_cast<std::uint32_t>(filesystem.f_type))
+        {
+        case 0x01021994u: result.type = "tmpfs"; break;
+        case 0x858458f6u: result.type = "ramfs"; break;
+        case 0x0000ef53u: result.type = "ext4"; break;
+        case 0x58465342u: result.type = "xfs"; break;
+        case 0x9123683eu: result.type = "btrfs"; break;
+        case 0x794c7630u: result.type = "overlay"; break;
+        case 0x65735546u: result.type = "fuse"; break;
+        case 0x00006969u: result.type = "nfs"; break;
+        case 0xff534d42u: result.type = "cifs"; break;
+        case 0xfe534d42u: result.type = "smb3"; break;
+        default: break;
+        }
+
+        result.kind = kindOfType(result.type);
+    }
+#elif defined(SYSTEM_DARWIN) || defined(SYSTEM_FREEBSD)
+    struct statfs filesystem;
+
+    if (path.empty() || statfs(path.c_str(), &filesystem) != 0)
+    {
+        return result;
+    }
+
+    result.valid = true;
+    result.type = filesystem.f_fstypename;
+    result.mountPoint = filesystem.f_mntonname;
+    result.source = filesystem.f_mntfromname;
+    result.blockSize = static_cast<std::uint64_t>(filesystem.f_iosize);
+    result.freeBytes = static_cast<std::uint64_t>(filesystem.f_bavail) * static_cast<std::uint64_t>(filesystem.f_bsize);
+    result.totalBytes = static_cast<std::uint64_t>(filesystem.f_blocks) * static_cast<std::uint64_t>(filesystem.f_bsize);
+    result.readOnly = (filesystem.f_flags & MNT_RDONLY) != 0;
+    result.noAccessTime = (filesystem.f_flags & MNT_NOATIME) != 0;
+    result.kind = result.type == "tmpfs" ? FilesystemKind::Memory
+        : (filesystem.f_flags & MNT_LOCAL) != 0 ? FilesystemKind::Local : FilesystemKind::Network;
+#elif defined(SYSTEM_WINDOWS)
+    char root[MAX_PATH];
+    char type[MAX_PATH + 1];
+    DWORD flags = 0;
+    DWORD sectorsPerCluster = 0;
+    DWORD bytesPerSector = 0;
+    DWORD freeClusters = 0;
+    DWORD clusters = 0;
+    ULARGE_INTEGER available;
+    ULARGE_INTEGER total;
+
+    if (path.empty() || !GetVolumePathNameA(path.c_str(), root, MAX_PATH)
+        || !GetVolumeInformationA(root, nullptr, 0, nullptr, nullptr, &flags, type, MAX_PATH + 1)
+        || !GetDiskFreeSpaceExA(path.c_str(), &available, &total, nullptr))
+    {
+        return result;
+    }
+
+    result.valid = true;
+    result.type = type;
+    result.mountPoint = root;
+    result.freeBytes = available.QuadPart;
+    result.totalBytes = total.QuadPart;
+    result.readOnly = (flags & FILE_READ_ONLY_VOLUME) != 0;
+
+    if (GetDiskFreeSpaceA(root, &sectorsPerCluster, &bytesPerSector, &freeClusters, &clusters))
+    {
+        result.blockSize = static_cast<std::uint64_t>(sectorsPerCluster) * bytesPerSector;
+    }
+
+    const auto driveType = GetDriveTypeA(root);
+    result.kind = driveType == DRIVE_RAMDISK ? FilesystemKind::Memory
+        : driveType == DRIVE_REMOTE ? FilesystemKind::Network
+        : driveType == DRIVE_FIXED ? FilesystemKind::Local
+        : FilesystemKind::Unknown;
+#else
+    struct statvfs filesystem;
+
+    if (path.empty() || statvfs(path.c_str(), &filesystem) != 0)
+    {
+        return result;
+    }
+
+    result.valid = true;
+    result.blockSize = static_cast<std::uint64_t>(filesystem.f_bsize);
+    result.freeBytes = static_cast<std::uint64_t>(filesystem.f_bavail) * static_cast<std::uint64_t>(filesystem.f_frsize);
+    result.totalBytes = static_cast<std::uint64_t>(filesystem.f_blocks) * static_cast<std::uint64_t>(filesystem.f_frsize);
+    result.readOnly = (filesystem.f_flag & ST_RDONLY) != 0;
+#endif
+
+    return result;
+}
+
+void clearFilesystemInfoCache()
+{
+#if defined(SYSTEM_LINUX)
+    auto & table = mountTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    table.parsed = false;
+    table.mounts.clear();
+#endif
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,214 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+#include "directory.h"
+#include "pattern.h"
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Check if a file name denotes a library matching the name pattern
+*
+*  @param[in] fileName
+*    File name
+*  @param[in] fileNameLength
+*    Length of fileName
+*  @param[in] pattern
+*    Pattern for the library name
+*  @param[out] name
+*    Library name part of fileName
+*
+*  @return
+*    'true' if the file name matches, else 'false'
+*/
+bool matchesLibrary(const char * fileName, std::size_t fileNameLength, const std::string & pattern, cpplocate::PathView & name)
+{
+    const auto prefix = cpplocate::traits::libPrefix();
+
+    if (fileNameLength <= prefix.size() || std::memcmp(fileName, prefix.data(), prefix.size()) != 0)
+    {
+        return false;
+    }
+
+    for (const auto & extension : cpplocate::traits::libExtensions())
+    {
+        const auto suffixLength = extension.size() + 1;
+
+        if (fileNameLength < prefix.size() + suffixLength
+            || fileName[fileNameLength - suffixLength] != '.'
+            || std::memcmp(fileName + fileNameLength - extension.size(), extension.data(), extension.size()) != 0)
+        {
+            continue;
+        }
+
+        name = cpplocate::PathView(fileName + prefix.size(), fileNameLength - prefix.size() - suffixLength);
+
+        return cpplocate::matchesPattern(name.data(), name.size(), pattern.data(), pattern.size());
+    }
+
+    return false;
+}
+
+std::string joinPath(const std::string & directory, const char * fileName)
+{
+    const auto last = directory.empty() ? '/' : directory.back();
+
+    return last == '/' || last == '\\' ? directory + fileName : directory + '/' + fileName;
+}
+
+#if !defined(SYSTEM_WINDOWS)
+
+/**
+*  @brief
+*    Add a directory entry to the result if it is a matching regular file
+*/
+void addEntry(cpplocate::LibraryDirectory & result, int descriptor, const char * fileName, unsigned char type, const std::string & pattern)
+{
+    #if defined(DT_REG)
+        if (type != DT_REG && type != DT_LNK && type != DT_UNKNOWN)
+        {
+            return;
+        }
+    #else
+        (void)type;
+    #endif
+
+    auto name = cpplocate::PathView();
+
+    if (!matchesLibrary(fileName, std::strlen(fileName), pattern, name))
+    {
+        return;
+    }
+
+    // Query relative to the open directory, following links
+    struct stat info;
+
+    if (fstatat(descriptor, fileName, &info, 0) != 0 || !S_ISREG(info.st_mode))
+    {
+        return;
+    }
+
+    result.libraries.push_back(cpplocate::LibraryFile{ joinPath(result.directory, fileName), name.str(),
+        static_cast<std::uint64_t>(info.st_size), static_cast<std::int64_t>(info.st_mtime) });
+}
+
+#endif
+
+#if defined(SYSTEM_WINDOWS)
+
+void scanDirectory(cpplocate::LibraryDirectory & result, const std::string & pattern)
+{
+    WIN32_FIND_DATAA entry;
+    const auto handle = FindFirstFileA(joinPath(result.directory, "*").c_str(), &entry);
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    result.scanned = true;
+
+    do
+    {
+        auto name = cpplocate::PathView();
+
+        if ((entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0
+            || !matchesLibrary(entry.cFileName, std::strlen(entry.cFileName), pattern, name))
+        {
+            continue;
+        }
+
+        // Convert from 100ns intervals since 1601 to seconds since 1970
+        const auto fileTime = (static_cast<std::uint64_t>(entry.ftLastWriteTime.dwHighDateTime) << 32) | entry.ftLastWriteTime.dwLowDateTime;
+
+        result.libraries.push_back(cpplocate::LibraryFile{ joinPath(result.directory, entry.cFileName), name.str(),
+            (static_cast<std::uint64_t>(entry.nFileSizeHigh) << 32) | entry.nFileSizeLow,
+            static_cast<std::int64_t>(fileTime / 10000000ull) - 11644473600ll });
+    }
+    while (FindNextFileA(handle, &entry));
+
+    FindClose(handle);
+}
+
+#else
+
+void scanDirectory(cpplocate::LibraryDirectory & result, const std::string & pattern)
+{
+    result.scanned = cpplocate::forEachDirectoryEntry(result.directory, [&result, &pattern](int descriptor, const char * fileName, unsigned char type)
+    {
+        addEntry(result, descriptor, fileName, type, pattern);
+    });
+}
+
+#endif
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+std::vector<LibraryDirectory> findLibraries(const std::vector<std::string> & directories, const std::string & namePattern)
+{
+    auto results = std::vector<LibraryDirectory>(directories.size());
+    std::atomic<std::size_t> next(0);
+
+    const auto work = [&results, &directories, &namePattern, &next]()
+    {
+        for (auto i = next++; i < directories.size(); i = next++)
+        {
+            auto & result = results[i];
+            result.directory = directories[i];
+            result.scanned = false;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            scanDirectory(result, namePattern);
+
+            std::sort(result.libraries.begin(), result.libraries.end(), [](const LibraryFile & first, const LibraryFile & second)
+            {
+                return first.path < second.path;
+            });
+
+            result.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        }
+    };
+
+    const auto threadCount = std::min(static_cast<std::size_t>(std::max(1u, std::thread::hardware_concurrency())), directories.size());
+    auto threads = std::vector<std::thread>();
+
+    for (auto i = std::size_t(1); i < threadCount; ++i)
+    {
+        threads.emplace_back(work);
+    }
+
+    work();
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    return results;
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,445 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <dlfcn.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(SYSTEM_LINUX) || defined(SYSTEM_FREEBSD)
+    #include <elf.h>
+    #define ELF_DEPENDENCIES
+#endif
+
+
+namespace
+{
+
+
+#if defined(ELF_DEPENDENCIES)
+
+/**
+*  @brief
+*    Translate a virtual address into a file offset using the loadable segments
+*
+*  @return
+*    'true' if the address lies within a loadable segment, else 'false'
+*/
+template <typename Phdr>
+bool fileOffset(const Phdr * headers, std::size_t count, std::uint64_t address, std::uint64_t & offset)
+{
+    for (auto i = std::size_t(0); i < count; ++i)
+    {
+        if (headers[i].p_type == PT_LOAD && address >= headers[i].p_vaddr && address < headers[i].p_vaddr + headers[i].p_filesz)
+        {
+            offset = address - headers[i].p_vaddr + headers[i].p_offset;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+*  @brief
+*    Read DT_NEEDED and DT_SONAME entries of a mapped ELF file
+*
+*  @return
+*    'true' on success, 'false' if the file is malformed
+*/
+template <typename Ehdr, typename Phdr, typename Dyn>
+bool readDynamicSection(const char * data, std::size_t size, std::vector<std::string> & needed, std::string & soname)
+{
+    if (size < sizeof(Ehdr))
+    {
+        return false;
+    }
+
+    Ehdr header;
+    std::memcpy(&header, data, sizeof(Ehdr));
+
+    if (header.e_phentsize != sizeof(Phdr) || header.e_phoff > size
+        || static_cast<std::uint64_t>(header.e_phnum) * sizeof(Phdr) > size - header.e_phoff)
+    {
+        return false;
+    }
+
+    auto headers = std::vector<Phdr>(header.e_phnum);
+    std::memcpy(headers.data(), data + header.e_phoff, headers.size() * sizeof(Phdr));
+
+    const auto dynamic = std::find_if(headers.begin(), headers.end(), [](const Phdr & segment) { return segment.p_type == PT_DYNAMIC; });
+
+    if (dynamic == headers.end())
+    {
+        // Statically linked
+        return true;
+    }
+
+    if (dynamic->p_offset > size || dynamic->p_filesz > size - dynamic->p_offset)
+    {
+        return false;
+    }
+
+    auto entries = std::vector<Dyn>(dynamic->p_filesz / sizeof(Dyn));
+    std::memcpy(entries.data(), data + dynamic->p_offset, entries.size() * sizeof(Dyn));
+
+    // Locate string table
+    auto stringTable = std::uint64_t(0);
+    auto stringTableSize = std::uint64_t(0);
+
+    for (const auto & entry : entries)
+    {
+        if (entry.d_tag == DT_STRTAB)
+        {
+            stringTable = entry.d_un.d_ptr;
+        }
+        else if (entry.d_tag == DT_STRSZ)
+        {
+            stringTableSize = entry.d_un.d_val;
+        }
+    }
+
+    auto offset = std::uint64_t(0);
+
+    if (!fileOffset(headers.data(), headers.size(), stringTable, offset) || offset > size || stringTableSize > size - offset)
+    {
+        return false;
+    }
+
+    const auto strings = data + offset;
+
+    const auto stringAt = [strings, stringTableSize](std::uint64_t index)
+    {
+        if (index >= stringTableSize)
+        {
+            return std::string();
+        }
+
+        const auto begin = strings + index;
+        const auto end = static_cast<const char *>(std::memchr(begin, 0, static_cast<std::size_t>(stringTableSize - index)));
+
+        return end != nullptr ? std::string(begin, end) : std::string();
+    };
+
+    for (const auto & entry : entries)
+    {
+        if (entry.d_tag == DT_NULL)
+        {
+            break;
+        }
+
+        if (entry.d_tag == DT_NEEDED)
+        {
+            needed.push_back(stringAt(entry.d_un.d_val));
+        }
+        else if (entry.d_tag == DT_SONAME)
+        {
+            soname = stringAt(entry.d_un.d_val);
+        }
+    }
+
+    return true;
+}
+
+#endif
+
+/**
+*  @brief
+*    Read dependencies and soname of a shared library
+*
+*  @remark
+*    Only ELF files of the host byte order are supported; for other
+*    formats, no dependencies are reported.
+*/
+void readDependencies(const std::string & path, std::vector<std::string> & needed, std::string & soname)
+{
+#if defined(ELF_DEPENDENCIES)
+    const auto descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0)
+    {
+        return;
+    }
+
+    struct stat info;
+
+    if (fstat(descriptor, &info) != 0 || info.st_size < EI_NIDENT)
+    {
+        close(descriptor);
+        return;
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    const auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        return;
+    }
+
+    const auto data = static_cast<const char *>(mapping);
+    const auto one = std::uint16_t(1);
+    const auto hostData = *reinterpret_cast<const unsigned char *>(&one) == 1 ? ELFDATA2LSB : ELFDATA2MSB;
+
+    if (std::memcmp(data, ELFMAG, SELFMAG) == 0 && data[EI_DATA] == hostData)
+    {
+        if (data[EI_CLASS] == ELFCLASS64)
+        {
+            readDynamicSection<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn>(data, size, needed, soname);
+        }
+        else if (data[EI_CLASS] == ELFCLASS32)
+        {
+            readDynamicSection<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn>(data, size, needed, soname);
+        }
+    }
+
+    munmap(mapping, size);
+#else
+    (void)path;
+    (void)needed;
+    (void)soname;
+#endif
+}
+
+std::string fileNameOf(const std::string & path)
+{
+    const auto pos = path.find_last_of("/\\");
+
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+void * openLibrary(const std::string & path, std::string & error)
+{
+#if defined(SYSTEM_WINDOWS)
+    const auto handle = LoadLibraryA(path.c_str());
+
+    if (handle == nullptr)
+    {
+        error = "LoadLibrary failed with error " + std::to_string(GetLastError());
+    }
+
+    return reinterpret_cast<void *>(handle);
+#else
+    const auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+    if (handle == nullptr)
+    {
+        const auto message = dlerror();
+        error = message != nullptr ? message : "dlopen failed";
+    }
+
+    return handle;
+#endif
+}
+
+/**
+*  @brief
+*    Dependency graph of the libraries to load
+*/
+struct LoadGraph
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::size_t> ready;               ///< Libraries whose dependencies are loaded
+    std::vector<std::vector<std::size_t>> users; ///< Libraries depending on each library
+    std::vector<std::size_t> pending;            ///< Number of dependencies not yet loaded
+    std::vector<bool> started;                   ///< Loading of the library has started
+    std::size_t running = 0;                     ///< Libraries currently loading
+    std::size_t remaining = 0;                   ///< Libraries not yet started
+};
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+std::vector<std::string> libraryDependencies(const std::string & path)
+{
+    auto needed = std::vector<std::string>();
+    auto soname = std::string();
+
+    readDependencies(path, needed, soname);
+
+    return needed;
+}
+
+std::vector<LoadedLibrary> loadLibraries(const std::vector<std::string> & paths, std::size_t threadCount)
+{
+    const auto count = paths.size();
+    auto results = std::vector<LoadedLibrary>(count);
+
+    // Warm up the page cache while the headers are parsed
+    prefetch(std::string(), paths);
+
+    auto needed = std::vector<std::vector<std::string>>(count);
+    auto sonames = std::vector<std::string>(count);
+
+    for (auto i = std::size_t(0); i < count; ++i)
+    {
+        results[i].path = paths[i];
+        results[i].handle = nullptr;
+        results[i].duration = std::chrono::microseconds(0);
+
+        readDependencies(paths[i], needed[i], sonames[i]);
+    }
+
+    // Build dependency graph: a library depends on another if it needs its soname or file name
+    LoadGraph graph;
+    graph.users.resize(count);
+    graph.pending.resize(count, 0);
+    graph.started.resize(count, false);
+    graph.remaining = count;
+
+    for (auto i = std::size_t(0); i < count; ++i)
+    {
+        for (auto j = std::size_t(0); j < count; ++j)
+        {
+            if (i == j)
+            {
+                continue;
+            }
+
+            const auto fileName = fileNameOf(paths[j]);
+            const auto dependsOn = std::any_of(needed[i].begin(), needed[i].end(), [&](const std::string & name)
+            {
+                return name == fileName || (!sonames[j].empty() && name == sonames[j]);
+            });
+
+            if (dependsOn)
+            {
+                results[i].dependencies.push_back(paths[j]);
+                graph.users[j].push_back(i);
+                ++graph.pending[i];
+            }
+        }
+
+        if (graph.pending[i] == 0)
+        {
+            graph.ready.push_back(i);
+        }
+    }
+
+    const auto work = [&graph, &results]()
+    {
+        std::unique_lock<std::mutex> lock(graph.mutex);
+
+        for (;;)
+        {
+            graph.changed.wait(lock, [&graph]() { return !graph.ready.empty() || graph.remaining == 0 || graph.running == 0; });
+
+            if (graph.remaining == 0)
+            {
+                return;
+            }
+
+            if (graph.ready.empty())
+            {
+                // Dependency cycle: continue with the first library not yet started
+                const auto next = std::find(graph.started.begin(), graph.started.end(), false) - graph.started.begin();
+                graph.ready.push_back(static_cast<std::size_t>(next));
+            }
+
+            const auto index = graph.ready.front();
+            graph.ready.pop_front();
+
+            if (graph.started[index])
+            {
+                continue;
+            }
+
+            graph.started[index] = true;
+            --graph.remaining;
+            ++graph.running;
+
+            lock.unlock();
+
+            auto & result = results[index];
+            const auto start = std::chrono::steady_clock::now();
+
+            result.handle = openLibrary(result.path, result.error);
+            result.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+            lock.lock();
+
+            --graph.running;
+
+            for (const auto user : graph.users[index])
+            {
+                if (--graph.pending[user] == 0 && !graph.started[user])
+                {
+                    graph.ready.push_back(user);
+                }
+            }
+
+            graph.changed.notify_all();
+        }
+    };
+
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    threadCount = std::min(threadCount, std::max(count, std::size_t(1)));
+
+    auto threads = std::vector<std::thread>();
+
+    for (auto i = std::size_t(1); i < threadCount; ++i)
+    {
+        threads.emplace_back(work);
+    }
+
+    if (count > 0)
+    {
+        work();
+    }
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    return results;
+}
+
+void unloadLibraries(std::vector<LoadedLibrary> & libraries)
+{
+    // Unload in reverse order, so users are released before their dependencies
+    for (auto library = libraries.rbegin(); library != libraries.rend(); ++library)
+    {
+        if (library->handle == nullptr)
+        {
+            continue;
+        }
+
+#if defined(SYSTEM_WINDOWS)
+        FreeLibrary(reinterpret_cast<HMODULE>(library->handle));
+#else
+        dlclose(library->handle);
+#endif
+
+        library->handle = nullptr;
+    }
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,156 @@
+
+#include <cpplocate/path.h>
+
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Process-wide table of interned paths
+*
+*  @remark
+*    The map is node-based, so entries and their keys keep their
+*    addresses when the table grows. Handles point to them directly.
+*/
+struct PathTable
+{
+    PathTable()
+    : characters(0)
+    , lookups(0)
+    , hits(0)
+    {
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, cpplocate::detail::InternedPath> entries;
+    std::size_t characters;
+    std::size_t lookups;
+    std::size_t hits;
+};
+
+PathTable & table()
+{
+    // Never destroyed, as handles in static objects may be released during shutdown
+    static auto instance = new PathTable;
+
+    return *instance;
+}
+
+std::size_t heapBytes(const std::string & value)
+{
+    const auto data = value.data();
+    const auto object = reinterpret_cast<const char *>(&value);
+
+    // Short strings are stored within the object itself
+    return data >= object && data < object + sizeof(std::string) ? 0 : value.capacity() + 1;
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+namespace detail
+{
+
+
+const std::string & emptyPath()
+{
+    static const auto empty = new std::string();
+
+    return *empty;
+}
+
+void releasePath(InternedPath * entry)
+{
+    auto references = entry->references.load(std::memory_order_relaxed);
+
+    // Other handles keep the entry alive, no need to lock the table
+    while (references > 1)
+    {
+        if (entry->references.compare_exchange_weak(references, references - 1, std::memory_order_release, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+
+    // Possibly the last handle; internPath may add references concurrently, but only while holding the lock
+    auto & paths = table();
+    std::lock_guard<std::mutex> lock(paths.mutex);
+
+    if (entry->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+
+    paths.characters -= entry->string->size();
+    paths.entries.erase(paths.entries.find(*entry->string));
+}
+
+
+} // namespace detail
+
+
+Path internPath(const std::string & path)
+{
+    if (path.empty())
+    {
+        return Path();
+    }
+
+    auto & paths = table();
+    std::lock_guard<std::mutex> lock(paths.mutex);
+
+    ++paths.lookups;
+
+    const auto it = paths.entries.find(path);
+
+    if (it != paths.entries.end())
+    {
+        ++paths.hits;
+        it->second.references.fetch_add(1, std::memory_order_relaxed);
+
+        return Path(&it->second);
+    }
+
+    const auto inserted = paths.entries.emplace(std::piecewise_construct, std::forward_as_tuple(path), std::forward_as_tuple()).first;
+
+    inserted->second.string = &inserted->first;
+    inserted->second.references.store(1, std::memory_order_relaxed);
+    paths.characters += path.size();
+
+    return Path(&inserted->second);
+}
+
+PathTableStatistics pathTableStatistics()
+{
+    auto & paths = table();
+    std::lock_guard<std::mutex> lock(paths.mutex);
+
+    // Each node holds the key, the entry, the cached hash, and the link to the next node
+    const auto nodeSize = sizeof(std::pair<const std::string, detail::InternedPath>) + sizeof(std::size_t) + sizeof(void *);
+
+    auto statistics = PathTableStatistics{ paths.entries.size(), 0, paths.characters, 0, paths.lookups, paths.hits };
+
+    statistics.bytes = paths.entries.bucket_count() * sizeof(void *) + paths.entries.size() * nodeSize;
+
+    for (const auto & entry : paths.entries)
+    {
+        statistics.references += entry.second.references.load(std::memory_order_relaxed);
+        statistics.bytes += heapBytes(entry.first);
+    }
+
+    return statistics;
+}
+
+
+} // namespace cpplocate
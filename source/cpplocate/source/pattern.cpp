@@ -0,0 +1,54 @@
+
+#include "pattern.h"
+
+
+namespace cpplocate
+{
+
+
+bool matchesPattern(const char * name, std::size_t nameLength, const char * pattern, std::size_t patternLength)
+{
+    std::size_t n = 0;
+    std::size_t p = 0;
+
+    // Position after the last '*' and the name position it is currently matched up to
+    bool star = false;
+    std::size_t starPattern = 0;
+    std::size_t starName = 0;
+
+    while (n < nameLength)
+    {
+        if (p < patternLength && (pattern[p] == '?' || pattern[p] == name[n]))
+        {
+            ++n;
+            ++p;
+        }
+        else if (p < patternLength && pattern[p] == '*')
+        {
+            star = true;
+            starPattern = ++p;
+            starName = n;
+        }
+        else if (star)
+        {
+            // Let the last '*' consume one more character
+            p = starPattern;
+            n = ++starName;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // Remaining pattern may only consist of '*'
+    while (p < patternLength && pattern[p] == '*')
+    {
+        ++p;
+    }
+
+    return p == patternLength;
+}
+
+
+} // namespace cpplocate
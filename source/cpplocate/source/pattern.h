@@ -0,0 +1,34 @@
+
+#pragma once
+
+
+#include <cstddef>
+
+
+namespace cpplocate
+{
+
+
+/**
+*  @brief
+*    Match a file name against a wildcard pattern
+*
+*  @param[in] name
+*    File name (e.g., 'libfoo.so')
+*  @param[in] nameLength
+*    Length of name
+*  @param[in] pattern
+*    Pattern, supporting '*' (any sequence) and '?' (any character) wildcards
+*  @param[in] patternLength
+*    Length of pattern
+*
+*  @return
+*    'true' if name matches pattern, else 'false'
+*
+*  @remark
+*    The match does not allocate memory.
+*/
+bool matchesPattern(const char * name, std::size_t nameLength, const char * pattern, std::size_t patternLength);
+
+
+} // namespace cpplocate
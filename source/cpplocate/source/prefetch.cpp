@@ -0,0 +1,311 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+    #include <io.h>
+    #include <fcntl.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "pattern.h"
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Issue read-ahead of a single file
+*
+*  @param[in] path
+*    Path to file
+*  @param[out] size
+*    Size of the file
+*
+*  @return
+*    'true' if the file could be opened, else 'false'
+*/
+bool prefetchFile(const std::string & path, std::uint64_t & size)
+{
+#if defined(SYSTEM_WINDOWS)
+    const auto descriptor = _open(path.c_str(), _O_RDONLY | _O_BINARY | _O_SEQUENTIAL);
+#else
+    const auto descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+#if defined(SYSTEM_WINDOWS)
+    size = static_cast<std::uint64_t>(_filelengthi64(descriptor));
+
+    // No asynchronous read-ahead available, read once to populate the cache
+    char buffer[65536];
+    while (_read(descriptor, buffer, sizeof(buffer)) > 0)
+    {
+    }
+
+    _close(descriptor);
+#else
+    struct stat info;
+    size = fstat(descriptor, &info) == 0 ? static_cast<std::uint64_t>(info.st_size) : 0;
+
+    #if defined(POSIX_FADV_WILLNEED)
+        // Starts asynchronous read-ahead of the whole file without waiting for it
+        posix_fadvise(descriptor, 0, 0, POSIX_FADV_WILLNEED);
+    #elif defined(F_RDADVISE)
+        struct radvisory advisory;
+        advisory.ra_offset = 0;
+        advisory.ra_count = static_cast<int>(size);
+        fcntl(descriptor, F_RDADVISE, &advisory);
+    #else
+        char buffer[65536];
+        while (read(descriptor, buffer, sizeof(buffer)) > 0)
+        {
+        }
+    #endif
+
+    close(descriptor);
+#endif
+
+    return true;
+}
+
+/**
+*  @brief
+*    Bounded pool of background prefetch workers
+*
+*  @remark
+*    Workers are started on demand and terminate when the queue runs empty.
+*    Only the number of workers is bounded, the queue is not.
+*/
+class Prefetcher
+{
+public:
+    Prefetcher()
+    : m_maxWorkers(4)
+    , m_workers(0)
+    , m_statistics{ 0, 0, 0, 0 }
+    {
+    }
+
+    void enqueue(std::deque<std::string> && paths)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_statistics.filesRequested += paths.size();
+
+        for (auto & path : paths)
+        {
+            m_queue.push_back(std::move(path));
+        }
+
+        // Workers block on the lock until it is released, so they are counted after they were started
+        while (m_workers < m_maxWorkers && m_workers < m_queue.size())
+        {
+            try
+            {
+                std::thread(&Prefetcher::work, this).detach();
+            }
+            catch (const std::system_error &)
+            {
+                break;
+            }
+
+            ++m_workers;
+        }
+
+        // Without any worker, the queue would never drain and wait would block
+        if (m_workers == 0)
+        {
+            m_statistics.filesFailed += m_queue.size();
+            m_queue.clear();
+        }
+    }
+
+    void setMaxWorkers(std::size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_maxWorkers = count > 0 ? count : 1;
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_idle.wait(lock, [this]() { return m_workers == 0 && m_queue.empty(); });
+    }
+
+    cpplocate::PrefetchStatistics statistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        return m_statistics;
+    }
+
+protected:
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (!m_queue.empty())
+        {
+            const auto path = std::move(m_queue.front());
+            m_queue.pop_front();
+
+            lock.unlock();
+
+            auto size = std::uint64_t(0);
+            const auto success = prefetchFile(path, size);
+
+            lock.lock();
+
+            if (success)
+            {
+                ++m_statistics.filesPrefetched;
+                m_statistics.bytesPrefetched += size;
+            }
+            else
+            {
+                ++m_statistics.filesFailed;
+            }
+        }
+
+        if (--m_workers == 0)
+        {
+            m_idle.notify_all();
+        }
+    }
+
+protected:
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::deque<std::string> m_queue;
+    std::size_t m_maxWorkers;
+    std::size_t m_workers;
+    cpplocate::PrefetchStatistics m_statistics;
+};
+
+Prefetcher & prefetcher()
+{
+    // Never destroyed, as detached workers may still access it during shutdown
+    static auto instance = new Prefetcher;
+
+    return *instance;
+}
+
+std::string joinPath(const std::string & directory, const std::string & relPath)
+{
+    if (directory.empty())
+    {
+        return relPath;
+    }
+
+    const auto last = directory.back();
+
+    return last == '/' || last == '\\' ? directory + relPath : directory + '/' + relPath;
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+void prefetch(const std::string & directory, const std::vector<std::string> & relPaths)
+{
+    auto paths = std::deque<std::string>();
+
+    for (const auto & relPath : relPaths)
+    {
+        paths.push_back(joinPath(directory, relPath));
+    }
+
+    prefetcher().enqueue(std::move(paths));
+}
+
+void prefetchMatching(const std::string & directory, const std::string & pattern)
+{
+    auto paths = std::deque<std::string>();
+
+#if defined(SYSTEM_WINDOWS)
+    WIN32_FIND_DATAA entry;
+    const auto handle = FindFirstFileA(joinPath(directory, "*").c_str(), &entry);
+
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if ((entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0
+                && matchesPattern(entry.cFileName, std::strlen(entry.cFileName), pattern.data(), pattern.size()))
+            {
+                paths.push_back(joinPath(directory, entry.cFileName));
+            }
+        }
+        while (FindNextFileA(handle, &entry));
+
+        FindClose(handle);
+    }
+#else
+    const auto dir = opendir(directory.c_str());
+
+    if (dir != nullptr)
+    {
+        while (const auto entry = readdir(dir))
+        {
+            #if defined(DT_REG)
+                if (entry->d_type != DT_REG && entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN)
+                {
+                    continue;
+                }
+            #endif
+
+            if (matchesPattern(entry->d_name, std::strlen(entry->d_name), pattern.data(), pattern.size()))
+            {
+                paths.push_back(joinPath(directory, entry->d_name));
+            }
+        }
+
+        closedir(dir);
+    }
+#endif
+
+    prefetcher().enqueue(std::move(paths));
+}
+
+void setMaxPrefetchRequests(std::size_t count)
+{
+    prefetcher().setMaxWorkers(count);
+}
+
+void waitForPrefetch()
+{
+    prefetcher().wait();
+}
+
+PrefetchStatistics prefetchStatistics()
+{
+    return prefetcher().statistics();
+}
+
+
+} // namespace cpplocate
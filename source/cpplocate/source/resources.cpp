@@ -0,0 +1,145 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Process-wide registry of embedded resource tables
+*/
+struct EmbeddedResourceRegistry
+{
+    std::mutex mutex;
+    std::vector<std::pair<const cpplocate::EmbeddedResource *, std::size_t>> tables;
+    bool overrides = false;
+};
+
+EmbeddedResourceRegistry & registry()
+{
+    static EmbeddedResourceRegistry instance;
+
+    return instance;
+}
+
+/**
+*  @brief
+*    Order resource entries by path in byte order
+*/
+bool lessThan(const cpplocate::EmbeddedResource & resource, const std::string & path)
+{
+    const auto length = std::min(resource.pathLength, path.size());
+    const auto result = std::memcmp(resource.path, path.data(), length);
+
+    return result < 0 || (result == 0 && resource.pathLength < path.size());
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+void registerEmbeddedResources(const EmbeddedResource * resources, std::size_t count)
+{
+    if (resources == nullptr || count == 0)
+    {
+        return;
+    }
+
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    instance.tables.emplace_back(resources, count);
+}
+
+void unregisterEmbeddedResources(const EmbeddedResource * resources)
+{
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    instance.tables.erase(std::remove_if(instance.tables.begin(), instance.tables.end(),
+        [resources](const std::pair<const EmbeddedResource *, std::size_t> & table)
+        {
+            return table.first == resources;
+        }), instance.tables.end());
+}
+
+const EmbeddedResource * findEmbeddedResource(const std::string & relPath)
+{
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    // Search most recently registered tables first
+    for (auto table = instance.tables.rbegin(); table != instance.tables.rend(); ++table)
+    {
+        const auto begin = table->first;
+        const auto end = table->first + table->second;
+        const auto entry = std::lower_bound(begin, end, relPath, lessThan);
+
+        if (entry != end && entry->pathLength == relPath.size()
+            && std::memcmp(entry->path, relPath.data(), relPath.size()) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void setEmbeddedResourceOverrides(bool enabled)
+{
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    instance.overrides = enabled;
+}
+
+LocatedResource locateResource(const std::string & relPath, const std::string & systemDir, void * symbol)
+{
+    bool overrides = false;
+
+    {
+        auto & instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+
+        overrides = instance.overrides;
+    }
+
+    if (!overrides)
+    {
+        if (const auto resource = findEmbeddedResource(relPath))
+        {
+            return LocatedResource{ std::string(), resource->data, resource->size };
+        }
+    }
+
+    auto path = locatePath(relPath, systemDir, symbol);
+
+    if (!path.empty())
+    {
+        return LocatedResource{ std::move(path), nullptr, 0 };
+    }
+
+    if (overrides)
+    {
+        if (const auto resource = findEmbeddedResource(relPath))
+        {
+            return LocatedResource{ std::string(), resource->data, resource->size };
+        }
+    }
+
+    return LocatedResource{ std::string(), nullptr, 0 };
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,310 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <liblocate/liblocate.h>
+
+
+namespace
+{
+
+
+/**
+*  @brief
+*    Cached scratch directory decision
+*/
+struct ScratchEntry
+{
+    std::string path;
+    std::chrono::steady_clock::time_point expiry;
+};
+
+/**
+*  @brief
+*    Process-wide scratch directory state
+*/
+struct ScratchState
+{
+    ScratchState()
+    : timeToLive(60)
+    {
+    }
+
+    std::mutex mutex;
+    cpplocate::FilesystemProbe probe;
+    std::chrono::seconds timeToLive;
+    std::map<std::pair<std::string, std::uint64_t>, ScratchEntry> decisions;
+};
+
+ScratchState & state()
+{
+    static ScratchState instance;
+
+    return instance;
+}
+
+/**
+*  @brief
+*    Query the filesystem of a directory using the system
+*/
+bool systemProbe(const std::string & directory, cpplocate::FilesystemStatus & status)
+{
+    const auto info = cpplocate::filesystemInfo(directory);
+
+    if (!info.valid)
+    {
+        return false;
+    }
+
+    status.kind = info.kind;
+    status.freeBytes = info.freeBytes;
+
+#if defined(SYSTEM_WINDOWS)
+    const auto attributes = GetFileAttributesA(directory.c_str());
+    status.writable = !info.readOnly && attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+    status.writable = !info.readOnly && access(directory.c_str(), W_OK | X_OK) == 0;
+#endif
+
+    return true;
+}
+
+std::vector<std::string> candidateDirectories()
+{
+    auto candidates = std::vector<std::string>();
+
+#if defined(SYSTEM_WINDOWS)
+    char buffer[MAX_PATH + 1];
+    const auto length = GetTempPathA(MAX_PATH + 1, buffer);
+
+    if (length > 0 && length <= MAX_PATH)
+    {
+        candidates.emplace_back(buffer, length);
+    }
+#else
+    for (const auto & variable : { std::make_pair("XDG_RUNTIME_DIR", "/dev/shm"), std::make_pair("TMPDIR", "/tmp") })
+    {
+        auto length = 0u;
+        const auto value = ::environmentValue(variable.first, static_cast<unsigned int>(std::strlen(variable.first)), &length);
+
+        // Relative paths are ignored
+        if (value != nullptr && value[0] == '/')
+        {
+            candidates.emplace_back(value, length);
+        }
+
+        candidates.emplace_back(variable.second);
+    }
+
+    candidates.emplace_back("/var/tmp");
+#endif
+
+    return candidates;
+}
+
+int rank(cpplocate::FilesystemKind kind)
+{
+    switch (kind)
+    {
+    case cpplocate::FilesystemKind::Memory:
+        return 0;
+    case cpplocate::FilesystemKind::Local:
+        return 1;
+    case cpplocate::FilesystemKind::Unknown:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+/**
+*  @brief
+*    Create the application subdirectory within a scratch candidate
+*
+*  @return
+*    Path to subdirectory, empty string if it cannot be used safely
+*/
+std::string createApplicationDir(std::string directory, const std::string & application)
+{
+    while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\'))
+    {
+        directory.pop_back();
+    }
+
+#if defined(SYSTEM_WINDOWS)
+    const auto path = directory + '\\' + application;
+
+    if (!CreateDirectoryA(path.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        return std::string();
+    }
+
+    const auto attributes = GetFileAttributesA(path.c_str());
+
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0
+        && (attributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0 ? path : std::string();
+#else
+    struct stat info;
+
+    if (stat(directory.c_str(), &info) != 0)
+    {
+        return std::string();
+    }
+
+    // Directories shared between users get a per-user name
+    const auto user = geteuid();
+    const auto path = (info.st_mode & S_ISVTX) != 0
+        ? directory + '/' + application + '-' + std::to_string(user)
+        : directory + '/' + application;
+
+    if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST)
+    {
+        return std::string();
+    }
+
+    // Reject links and directories of other users
+    if (lstat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode) || info.st_uid != user)
+    {
+        return std::string();
+    }
+
+    if ((info.st_mode & 0077) != 0 && chmod(path.c_str(), 0700) != 0)
+    {
+        return std::string();
+    }
+
+    return path;
+#endif
+}
+
+std::string selectScratchDir(const cpplocate::FilesystemProbe & probe, const std::string & application, std::uint64_t minFreeBytes)
+{
+    auto candidates = std::vector<std::pair<int, std::string>>();
+
+    for (const auto & directory : candidateDirectories())
+    {
+        auto status = cpplocate::FilesystemStatus{ cpplocate::FilesystemKind::Unknown, 0, false };
+
+        if (!probe(directory, status) || !status.writable || status.freeBytes < minFreeBytes)
+        {
+            continue;
+        }
+
+        candidates.emplace_back(rank(status.kind), directory);
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const std::pair<int, std::string> & lhs, const std::pair<int, std::string> & rhs)
+    {
+        return lhs.first < rhs.first;
+    });
+
+    for (const auto & candidate : candidates)
+    {
+        const auto path = createApplicationDir(candidate.second, application);
+
+        if (!path.empty())
+        {
+            return path;
+        }
+    }
+
+    return std::string();
+}
+
+bool isDirectory(const std::string & path)
+{
+#if defined(SYSTEM_WINDOWS)
+    const auto attributes = GetFileAttributesA(path.c_str());
+
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+    struct stat info;
+
+    return lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+std::string scratchDir(const std::string & application, std::uint64_t minFreeBytes)
+{
+    if (application.empty() || application.find_first_of("/\\") != std::string::npos || application == "..")
+    {
+        return std::string();
+    }
+
+    auto & scratch = state();
+    std::lock_guard<std::mutex> lock(scratch.mutex);
+
+    const auto key = std::make_pair(application, minFreeBytes);
+    const auto now = std::chrono::steady_clock::now();
+    const auto it = scratch.decisions.find(key);
+
+    // Reuse a recent decision as long as the directory still exists
+    if (it != scratch.decisions.end() && now < it->second.expiry && isDirectory(it->second.path))
+    {
+        return it->second.path;
+    }
+
+    const auto path = selectScratchDir(scratch.probe ? scratch.probe : FilesystemProbe(systemProbe), application, minFreeBytes);
+
+    if (!path.empty() && scratch.timeToLive.count() > 0)
+    {
+        scratch.decisions[key] = ScratchEntry{ path, now + scratch.timeToLive };
+    }
+    else
+    {
+        scratch.decisions.erase(key);
+    }
+
+    return path;
+}
+
+void setScratchDirTimeToLive(std::chrono::seconds timeToLive)
+{
+    auto & scratch = state();
+    std::lock_guard<std::mutex> lock(scratch.mutex);
+
+    scratch.timeToLive = timeToLive;
+    scratch.decisions.clear();
+}
+
+void clearScratchDirCache()
+{
+    auto & scratch = state();
+    std::lock_guard<std::mutex> lock(scratch.mutex);
+
+    scratch.decisions.clear();
+}
+
+void setFilesystemProbe(FilesystemProbe probe)
+{
+    auto & scratch = state();
+    std::lock_guard<std::mutex> lock(scratch.mutex);
+
+    scratch.probe = std::move(probe);
+    scratch.decisions.clear();
+}
+
+
+} // namespace cpplocate
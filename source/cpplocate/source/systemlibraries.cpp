@@ -0,0 +1,492 @@
+
+#include <cpplocate/cpplocate.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#if defined(SYSTEM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace
+{
+
+
+const char defaultCacheFile[] = "/etc/ld.so.cache";
+
+const char oldCacheMagic[] = "ld.so-1.7.0";
+const char newCacheMagic[] = "glibc-ld.so.cache1.1";
+
+const std::uint32_t flagTypeMask = 0x00ff;
+const std::uint32_t flagElfLibc6 = 0x0003;
+const std::uint32_t flagArchMask = 0xff00;
+
+/**
+*  @brief
+*    Layout of the old cache format ('ld.so-1.7.0')
+*/
+struct OldCacheHeader
+{
+    char magic[sizeof(oldCacheMagic) - 1];
+    std::uint32_t count;
+};
+
+struct OldCacheEntry
+{
+    std::int32_t flags;
+    std::uint32_t key;
+    std::uint32_t value;
+};
+
+/**
+*  @brief
+*    Layout of the new cache format ('glibc-ld.so.cache1.1')
+*/
+struct NewCacheHeader
+{
+    char magic[sizeof(newCacheMagic) - 1];
+    std::uint32_t count;
+    std::uint32_t stringsLength;
+    std::uint8_t flags;
+    std::uint8_t padding[3];
+    std::uint32_t extensionOffset;
+    std::uint32_t unused[3];
+};
+
+struct NewCacheEntry
+{
+    std::int32_t flags;
+    std::uint32_t key;
+    std::uint32_t value;
+    std::uint32_t osVersion;
+    std::uint64_t hwcap;
+};
+
+/**
+*  @brief
+*    Entry of the lookup table (soname and path of a library)
+*/
+struct CacheEntry
+{
+    std::string name;
+    std::string path;
+    std::uint32_t flags;
+};
+
+using CacheTable = std::vector<CacheEntry>;
+
+/**
+*  @brief
+*    Process-wide parsed caches, by cache file
+*/
+struct CacheRegistry
+{
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const CacheTable>> tables;
+};
+
+CacheRegistry & registry()
+{
+    static CacheRegistry instance;
+
+    return instance;
+}
+
+/**
+*  @brief
+*    Architecture flags of the libraries usable by this process
+*
+*  @return
+*    Flags as written by ldconfig, 0 if any entry is accepted
+*/
+std::uint32_t hostFlags()
+{
+#if defined(__x86_64__) && defined(__ILP32__)
+    return flagElfLibc6 | 0x0800;
+#elif defined(__x86_64__)
+    return flagElfLibc6 | 0x0300;
+#elif defined(__i386__)
+    return flagElfLibc6;
+#elif defined(__aarch64__)
+    return flagElfLibc6 | 0x0a00;
+#else
+    return 0;
+#endif
+}
+
+bool usable(const CacheEntry & entry)
+{
+    const auto flags = hostFlags();
+
+    return flags == 0 || ((entry.flags & flagTypeMask) == flagElfLibc6 && (entry.flags & flagArchMask) == (flags & flagArchMask));
+}
+
+/**
+*  @brief
+*    Get null-terminated string of the cache
+*
+*  @return
+*    'true' if the string lies within the cache, else 'false'
+*/
+bool stringAt(const char * data, std::size_t size, std::uint64_t offset, std::string & value)
+{
+    if (offset >= size)
+    {
+        return false;
+    }
+
+    const auto end = static_cast<const char *>(std::memchr(data + offset, 0, size - static_cast<std::size_t>(offset)));
+
+    if (end == nullptr)
+    {
+        return false;
+    }
+
+    value.assign(data + offset, end);
+
+    return true;
+}
+
+/**
+*  @brief
+*    Read entries of a cache in the given format
+*
+*  @param[in] data
+*    Contents of the cache file
+*  @param[in] size
+*    Size of the cache file
+*  @param[in] offset
+*    Offset of the header within the cache file
+*  @param[in] stringBase
+*    Offset to which string offsets are relative (given the header offset and count)
+*  @param[out] table
+*    Entries
+*
+*  @return
+*    'true' on success, 'false' if the cache is malformed
+*/
+template <typename Header, typename Entry>
+bool readEntries(const char * data, std::size_t size, std::size_t offset, std::size_t (*stringBase)(std::size_t, std::uint32_t), CacheTable & table)
+{
+    if (offset > size || size - offset < sizeof(Header))
+    {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data + offset, sizeof(Header));
+
+    const auto entries = offset + sizeof(Header);
+
+    if (header.count > (size - entries) / sizeof(Entry))
+    {
+        return false;
+    }
+
+    const auto strings = stringBase(offset, header.count);
+
+    table.clear();
+    table.reserve(header.count);
+
+    for (auto i = std::uint32_t(0); i < header.count; ++i)
+    {
+        Entry entry;
+        std::memcpy(&entry, data + entries + i * sizeof(Entry), sizeof(Entry));
+
+        auto result = CacheEntry{ std::string(), std::string(), static_cast<std::uint32_t>(entry.flags) };
+
+        if (!stringAt(data, size, std::uint64_t(strings) + entry.key, result.name)
+            || !stringAt(data, size, std::uint64_t(strings) + entry.value, result.path))
+        {
+            return false;
+        }
+
+        table.push_back(std::move(result));
+    }
+
+    return true;
+}
+
+std::size_t oldStringBase(std::size_t offset, std::uint32_t count)
+{
+    // Strings follow the entries
+    return offset + sizeof(OldCacheHeader) + count * sizeof(OldCacheEntry);
+}
+
+std::size_t newStringBase(std::size_t offset, std::uint32_t)
+{
+    // Strings are relative to the header
+    return offset;
+}
+
+/**
+*  @brief
+*    Parse the contents of a cache file
+*
+*  @remark
+*    Supports the old format, the new format, and the combined format
+*    (old format followed by the new one), preferring the new format.
+*/
+bool parseCache(const char * data, std::size_t size, CacheTable & table)
+{
+    const auto newMagicLength = sizeof(newCacheMagic) - 1;
+    const auto oldMagicLength = sizeof(oldCacheMagic) - 1;
+
+    if (size >= newMagicLength && std::memcmp(data, newCacheMagic, newMagicLength) == 0)
+    {
+        return readEntries<NewCacheHeader, NewCacheEntry>(data, size, 0, newStringBase, table);
+    }
+
+    if (size < sizeof(OldCacheHeader) || std::memcmp(data, oldCacheMagic, oldMagicLength) != 0)
+    {
+        return false;
+    }
+
+    OldCacheHeader header;
+    std::memcpy(&header, data, sizeof(OldCacheHeader));
+
+    // Combined format: new header follows the old entries, aligned like the new entries (ALIGN_CACHE of glibc)
+    if (header.count <= (size - sizeof(OldCacheHeader)) / sizeof(OldCacheEntry))
+    {
+        const auto alignment = alignof(NewCacheEntry);
+        const auto end = sizeof(OldCacheHeader) + header.count * sizeof(OldCacheEntry);
+        const auto offset = (end + alignment - 1) / alignment * alignment;
+
+        if (offset <= size && size - offset >= newMagicLength && std::memcmp(data + offset, newCacheMagic, newMagicLength) == 0)
+        {
+            return readEntries<NewCacheHeader, NewCacheEntry>(data, size, offset, newStringBase, table);
+        }
+    }
+
+    return readEntries<OldCacheHeader, OldCacheEntry>(data, size, 0, oldStringBase, table);
+}
+
+/**
+*  @brief
+*    Map and parse a cache file into a sorted lookup table
+*
+*  @return
+*    Table, nullptr if the cache file is absent or malformed
+*/
+std::shared_ptr<const CacheTable> loadCache(const std::string & cacheFile)
+{
+#if defined(SYSTEM_WINDOWS)
+    (void)cacheFile;
+
+    return nullptr;
+#else
+    const auto descriptor = open(cacheFile.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (descriptor < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+
+    if (fstat(descriptor, &info) != 0 || info.st_size <= 0)
+    {
+        close(descriptor);
+        return nullptr;
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    const auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto table = std::make_shared<CacheTable>();
+    const auto success = parseCache(static_cast<const char *>(mapping), size, *table);
+
+    munmap(mapping, size);
+
+    if (!success)
+    {
+        return nullptr;
+    }
+
+    // Keep file order among equal names, as ldconfig lists preferred entries first
+    std::stable_sort(table->begin(), table->end(), [](const CacheEntry & lhs, const CacheEntry & rhs)
+    {
+        return lhs.name < rhs.name;
+    });
+
+    return table;
+#endif
+}
+
+std::shared_ptr<const CacheTable> cacheTable(const std::string & cacheFile)
+{
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    const auto it = instance.tables.find(cacheFile);
+
+    if (it != instance.tables.end())
+    {
+        return it->second;
+    }
+
+    const auto table = loadCache(cacheFile);
+
+    instance.tables[cacheFile] = table;
+
+    return table;
+}
+
+/**
+*  @brief
+*    Find the first usable entry whose name starts with prefix (or equals it, if exact)
+*/
+std::string lookup(const CacheTable & table, const std::string & prefix, bool exact)
+{
+    auto it = std::lower_bound(table.begin(), table.end(), prefix, [](const CacheEntry & entry, const std::string & name)
+    {
+        return entry.name < name;
+    });
+
+    for (; it != table.end() && it->name.compare(0, prefix.size(), prefix) == 0; ++it)
+    {
+        if (exact && it->name.size() != prefix.size())
+        {
+            break;
+        }
+
+        if (usable(*it))
+        {
+            return it->path;
+        }
+    }
+
+    return std::string();
+}
+
+bool fileExists(const std::string & path)
+{
+#if defined(SYSTEM_WINDOWS)
+    return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat info;
+
+    return stat(path.c_str(), &info) == 0 && !S_ISDIR(info.st_mode);
+#endif
+}
+
+/**
+*  @brief
+*    Find a library by probing the system library directories
+*/
+std::string probeDirectories(const std::vector<std::string> & fileNames)
+{
+#if defined(SYSTEM_WINDOWS)
+    char buffer[MAX_PATH];
+    const auto length = GetSystemDirectoryA(buffer, MAX_PATH);
+
+    const auto directories = length > 0 && length < MAX_PATH
+        ? std::vector<std::string>{ std::string(buffer, length) }
+        : std::vector<std::string>();
+#else
+    const auto directories = std::vector<std::string>{
+    #if defined(__x86_64__) && defined(SYSTEM_LINUX)
+        "/lib/x86_64-linux-gnu",
+        "/usr/lib/x86_64-linux-gnu",
+    #elif defined(__aarch64__) && defined(SYSTEM_LINUX)
+        "/lib/aarch64-linux-gnu",
+        "/usr/lib/aarch64-linux-gnu",
+    #endif
+        "/lib",
+        "/usr/lib",
+        "/usr/lib64",
+        "/usr/local/lib",
+        "/usr/local/lib64"
+    };
+#endif
+
+    for (const auto & directory : directories)
+    {
+        for (const auto & fileName : fileNames)
+        {
+            const auto path = directory + '/' + fileName;
+
+            if (fileExists(path))
+            {
+                return path;
+            }
+        }
+    }
+
+    return std::string();
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+std::string findSystemLibrary(const std::string & name)
+{
+    return findSystemLibrary(name, defaultCacheFile);
+}
+
+std::string findSystemLibrary(const std::string & name, const std::string & cacheFile)
+{
+    if (name.empty() || name.find_first_of("/\\") != std::string::npos)
+    {
+        return std::string();
+    }
+
+    // Names without prefix and extension (e.g., 'z') are looked up as 'libz.so'
+    const auto prefix = libPrefix();
+    const auto extension = "." + libExtension();
+    const auto isFileName = name.find(extension) != std::string::npos;
+    const auto fileName = isFileName ? name : prefix + name + extension;
+
+    const auto table = cacheTable(cacheFile);
+
+    if (table != nullptr)
+    {
+        auto path = lookup(*table, fileName, true);
+
+        if (path.empty() && !isFileName)
+        {
+            // Versioned soname (e.g., 'libz.so.1')
+            path = lookup(*table, fileName + '.', false);
+        }
+
+        if (!path.empty())
+        {
+            return path;
+        }
+    }
+
+    return probeDirectories(std::vector<std::string>{ fileName });
+}
+
+void clearSystemLibraryCache()
+{
+    auto & instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    instance.tables.clear();
+}
+
+
+} // namespace cpplocate
@@ -0,0 +1,520 @@
+
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <cpplocate/cpplocate.h>
+
+#include <liblocate/liblocate.h>
+
+#include <core.h>
+
+
+namespace
+{
+
+
+const char traceMagic[4] = { 'C', 'P', 'L', 'T' };
+const std::uint32_t traceVersion = 2;
+const std::uint32_t maxStringLength = 1 << 16;
+
+
+/**
+*  @brief
+*    Kind of a recorded query
+*/
+enum class EntryKind : std::uint8_t
+{
+    LocatePath  = 0,
+    LibraryPath = 1
+};
+
+/**
+*  @brief
+*    Recorded query and its result
+*/
+struct Entry
+{
+    EntryKind kind;
+    std::string relPath;
+    std::string systemDir;
+    std::string libraryPath;
+    std::uint32_t depth;
+    std::string result;
+};
+
+/**
+*  @brief
+*    Identity of the executable a trace was recorded for
+*/
+struct ExecutableIdentity
+{
+    std::string path;
+    std::uint64_t size;
+    std::int64_t modified;
+};
+
+/**
+*  @brief
+*    Key of a locatePath query (relPath, systemDir, library path of symbol, search depth)
+*/
+using QueryKey = std::tuple<std::string, std::string, std::string, std::uint32_t>;
+
+/**
+*  @brief
+*    Process-wide trace state
+*/
+struct TraceState
+{
+    TraceState()
+    : mode(cpplocate::AccessTraceMode::Disabled)
+    , changed(false)
+    {
+    }
+
+    std::atomic<cpplocate::AccessTraceMode> mode;
+    std::mutex mutex;
+    std::string directory;
+    bool changed; ///< Recorded entries differ from the trace file
+    std::vector<Entry> recorded;
+    std::set<QueryKey> recordedQueries;
+    std::set<std::string> recordedLibraries;
+    std::map<QueryKey, std::string> replayed;
+};
+
+TraceState & state()
+{
+    static TraceState instance;
+
+    return instance;
+}
+
+std::string libraryPathOf(void * symbol)
+{
+    char * path = nullptr;
+    unsigned int length = 0;
+
+    ::getLibraryPath(symbol, &path, &length);
+
+    const auto result = path != nullptr ? std::string(path, length) : std::string();
+
+    ::releaseMemory(path);
+
+    return result;
+}
+
+/**
+*  @brief
+*    Repeat a recorded locatePath query
+*
+*  @param[in] entry
+*    Recorded query, its library path stands in for the symbol
+*
+*  @return
+*    Current result of the query, empty if the path could not be located
+*/
+std::string locateRecorded(const Entry & entry)
+{
+    auto result = std::string();
+
+    const auto sink = StringSink{
+        [](void * context, unsigned int length) -> char *
+        {
+            auto & target = *static_cast<std::string *>(context);
+            target.resize(length);
+
+            return &target[0];
+        },
+        [](void * context)
+        {
+            static_cast<std::string *>(context)->clear();
+        },
+        &result };
+
+    ::locatePathFromLibraryPathTo(&sink, entry.relPath.c_str(), (unsigned int)entry.relPath.size(),
+        entry.systemDir.c_str(), (unsigned int)entry.systemDir.size(),
+        entry.libraryPath.c_str(), (unsigned int)entry.libraryPath.size(), entry.depth);
+
+    return result;
+}
+
+bool fileStatus(const std::string & path, std::uint64_t & size, std::int64_t & modified)
+{
+    struct stat info;
+
+    if (path.empty() || stat(path.c_str(), &info) != 0)
+    {
+        return false;
+    }
+
+    size = static_cast<std::uint64_t>(info.st_size);
+    modified = static_cast<std::int64_t>(info.st_mtime);
+
+    return true;
+}
+
+ExecutableIdentity executableIdentity()
+{
+    auto identity = ExecutableIdentity{ cpplocate::getExecutablePath(), 0, 0 };
+
+    fileStatus(identity.path, identity.size, identity.modified);
+
+    return identity;
+}
+
+std::string traceFile(const std::string & directory)
+{
+    return directory + "/locate.trace";
+}
+
+template <typename T>
+void writeValue(std::ostream & stream, T value)
+{
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void writeString(std::ostream & stream, const std::string & value)
+{
+    writeValue<std::uint32_t>(stream, static_cast<std::uint32_t>(value.size()));
+    stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+template <typename T>
+bool readValue(std::istream & stream, T & value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+bool readString(std::istream & stream, std::string & value)
+{
+    auto length = std::uint32_t(0);
+
+    if (!readValue(stream, length) || length > maxStringLength)
+    {
+        return false;
+    }
+
+    value.resize(length);
+
+    return length == 0 || static_cast<bool>(stream.read(&value[0], length));
+}
+
+bool writeTrace(const std::string & file, const ExecutableIdentity & identity, const std::vector<Entry> & entries)
+{
+    std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+
+    if (!stream)
+    {
+        return false;
+    }
+
+    stream.write(traceMagic, sizeof(traceMagic));
+    writeValue(stream, traceVersion);
+    writeString(stream, identity.path);
+    writeValue(stream, identity.size);
+    writeValue(stream, identity.modified);
+    writeValue<std::uint32_t>(stream, static_cast<std::uint32_t>(entries.size()));
+
+    for (const auto & entry : entries)
+    {
+        writeValue(stream, static_cast<std::uint8_t>(entry.kind));
+        writeString(stream, entry.relPath);
+        writeString(stream, entry.systemDir);
+        writeString(stream, entry.libraryPath);
+        writeValue(stream, entry.depth);
+        writeString(stream, entry.result);
+    }
+
+    return static_cast<bool>(stream);
+}
+
+bool readTrace(const std::string & file, const ExecutableIdentity & identity, std::vector<Entry> & entries)
+{
+    std::ifstream stream(file, std::ios::binary);
+
+    char magic[sizeof(traceMagic)];
+    auto version = std::uint32_t(0);
+    auto recordedIdentity = ExecutableIdentity{ std::string(), 0, 0 };
+    auto count = std::uint32_t(0);
+
+    if (!stream.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), traceMagic)
+        || !readValue(stream, version) || version != traceVersion
+        || !readString(stream, recordedIdentity.path)
+        || !readValue(stream, recordedIdentity.size)
+        || !readValue(stream, recordedIdentity.modified)
+        || !readValue(stream, count))
+    {
+        return false;
+    }
+
+    // Invalidate trace if the executable changed
+    if (recordedIdentity.path != identity.path || recordedIdentity.size != identity.size
+        || recordedIdentity.modified != identity.modified)
+    {
+        return false;
+    }
+
+    entries.clear();
+
+    for (auto i = std::uint32_t(0); i < count; ++i)
+    {
+        auto kind = std::uint8_t(0);
+        auto entry = Entry{ EntryKind::LocatePath, std::string(), std::string(), std::string(), 0, std::string() };
+
+        if (!readValue(stream, kind) || kind > static_cast<std::uint8_t>(EntryKind::LibraryPath)
+            || !readString(stream, entry.relPath) || !readString(stream, entry.systemDir)
+            || !readString(stream, entry.libraryPath) || !readValue(stream, entry.depth)
+            || !readString(stream, entry.result))
+        {
+            return false;
+        }
+
+        entry.kind = static_cast<EntryKind>(kind);
+        entries.push_back(std::move(entry));
+    }
+
+    return true;
+}
+
+bool isRecording(cpplocate::AccessTraceMode mode)
+{
+    return mode == cpplocate::AccessTraceMode::Recording || mode == cpplocate::AccessTraceMode::Replaying;
+}
+
+/**
+*  @brief
+*    Repeat recorded queries in parallel and prefetch their files
+*
+*  @remark
+*    The recorded results only hint which files to prefetch while the
+*    queries are repeated, the current results are replayed.
+*/
+void replay(TraceState & trace, const std::vector<Entry> & entries)
+{
+    std::atomic<std::size_t> next(0);
+
+    const auto work = [&trace, &entries, &next]()
+    {
+        for (auto i = next++; i < entries.size(); i = next++)
+        {
+            const auto & entry = entries[i];
+
+            if (entry.kind == EntryKind::LibraryPath)
+            {
+                cpplocate::prefetch(std::string(), std::vector<std::string>{ entry.result });
+                continue;
+            }
+
+            if (!entry.result.empty())
+            {
+                cpplocate::prefetch(entry.result, std::vector<std::string>{ entry.relPath });
+            }
+
+            const auto result = locateRecorded(entry);
+
+            // Misses are located again when queried, the path may appear meanwhile
+            if (result.empty())
+            {
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(trace.mutex);
+                trace.replayed[QueryKey(entry.relPath, entry.systemDir, entry.libraryPath, entry.depth)] = result;
+            }
+
+            if (result != entry.result)
+            {
+                cpplocate::prefetch(result, std::vector<std::string>{ entry.relPath });
+            }
+        }
+    };
+
+    const auto threadCount = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+    auto threads = std::vector<std::thread>();
+
+    for (auto i = 1u; i < threadCount; ++i)
+    {
+        threads.emplace_back(work);
+    }
+
+    work();
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+} // namespace
+
+
+namespace cpplocate
+{
+
+
+AccessTraceMode startAccessTrace(const std::string & application)
+{
+    stopAccessTrace();
+
+    auto & trace = state();
+    const auto directory = cacheDir(application);
+
+    auto entries = std::vector<Entry>();
+
+    if (!directory.empty() && readTrace(traceFile(directory), executableIdentity(), entries))
+    {
+        replay(trace, entries);
+
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        trace.directory = directory;
+
+        // Keep the located entries with their current results, so that queries not seen in the previous run are merged in
+        auto updated = false;
+
+        for (auto & entry : entries)
+        {
+            const auto key = QueryKey(entry.relPath, entry.systemDir, entry.libraryPath, entry.depth);
+            const auto it = trace.replayed.find(key);
+
+            if (entry.kind == EntryKind::LibraryPath ? trace.recordedLibraries.insert(entry.result).second
+                : it != trace.replayed.end() && trace.recordedQueries.insert(key).second)
+            {
+                if (entry.kind == EntryKind::LocatePath && entry.result != it->second)
+                {
+                    entry.result = it->second;
+                    updated = true;
+                }
+
+                trace.recorded.push_back(std::move(entry));
+            }
+        }
+
+        trace.changed = updated || trace.recorded.size() != entries.size();
+        trace.mode = AccessTraceMode::Replaying;
+
+        return AccessTraceMode::Replaying;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        trace.directory = directory;
+        trace.changed = true;
+    }
+
+    trace.mode = AccessTraceMode::Recording;
+
+    return AccessTraceMode::Recording;
+}
+
+void stopAccessTrace()
+{
+    auto & trace = state();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+
+    const auto mode = trace.mode.exchange(AccessTraceMode::Disabled);
+
+    if (isRecording(mode) && trace.changed && !trace.directory.empty() && ensureDir(trace.directory, 0700).valid())
+    {
+        writeTrace(traceFile(trace.directory), executableIdentity(), trace.recorded);
+    }
+
+    trace.directory.clear();
+    trace.changed = false;
+    trace.recorded.clear();
+    trace.recordedQueries.clear();
+    trace.recordedLibraries.clear();
+    trace.replayed.clear();
+}
+
+AccessTraceMode accessTraceMode()
+{
+    return state().mode;
+}
+
+
+namespace trace
+{
+
+
+bool replayLocatePath(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth, std::string & result)
+{
+    auto & trace = state();
+
+    if (trace.mode != AccessTraceMode::Replaying)
+    {
+        return false;
+    }
+
+    const auto key = QueryKey(relPath, systemDir, libraryPathOf(symbol), depth);
+
+    std::lock_guard<std::mutex> lock(trace.mutex);
+
+    const auto it = trace.replayed.find(key);
+
+    if (it == trace.replayed.end())
+    {
+        return false;
+    }
+
+    result = it->second;
+
+    return true;
+}
+
+void recordLocatePath(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth, const std::string & result)
+{
+    auto & trace = state();
+
+    if (!isRecording(trace.mode))
+    {
+        return;
+    }
+
+    auto key = QueryKey(relPath, systemDir, libraryPathOf(symbol), depth);
+
+    std::lock_guard<std::mutex> lock(trace.mutex);
+
+    if (trace.recordedQueries.insert(key).second)
+    {
+        trace.recorded.push_back(Entry{ EntryKind::LocatePath, relPath, systemDir, std::get<2>(key), depth, result });
+        trace.changed = true;
+    }
+}
+
+void recordLibraryPath(const std::string & result)
+{
+    auto & trace = state();
+
+    if (!isRecording(trace.mode) || result.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(trace.mutex);
+
+    if (trace.recordedLibraries.insert(result).second)
+    {
+        trace.recorded.push_back(Entry{ EntryKind::LibraryPath, std::string(), std::string(), std::string(), 0, result });
+        trace.changed = true;
+    }
+}
+
+
+} // namespace trace
+
+
+} // namespace cpplocate
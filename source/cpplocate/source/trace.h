@@ -0,0 +1,48 @@
+
+#pragma once
+
+
+#include <string>
+
+
+namespace cpplocate
+{
+namespace trace
+{
+
+
+/**
+*  @brief
+*    Answer a locatePath query from the replayed trace
+*
+*  @param[in] relPath
+*    Relative path as passed to locatePath
+*  @param[in] systemDir
+*    System directory as passed to locatePath
+*  @param[in] symbol
+*    Symbol as passed to locatePath
+*  @param[in] depth
+*    Upward search depth of the query
+*  @param[out] result
+*    Result of the recorded query, located anew by startAccessTrace
+*
+*  @return
+*    'true' if the query could be answered, else 'false'
+*/
+bool replayLocatePath(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth, std::string & result);
+
+/**
+*  @brief
+*    Record a locatePath query and its result
+*/
+void recordLocatePath(const std::string & relPath, const std::string & systemDir, void * symbol, unsigned int depth, const std::string & result);
+
+/**
+*  @brief
+*    Record a getLibraryPath result
+*/
+void recordLibraryPath(const std::string & result);
+
+
+} // namespace trace
+} // namespace cpplocate
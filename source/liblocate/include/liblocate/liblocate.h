@@ -2,6 +2,8 @@
 #pragma once
 
 
+#include <stddef.h>
+
 #include <liblocate/liblocate_api.h>
 
 
@@ -11,6 +13,104 @@ extern "C"
 #endif
 
 
+/**
+*  @brief
+*    Search stage at which a path was located
+*/
+enum LocateStage
+{
+    LocateStageLibrary         = 0, ///< Relative to the library identified by the symbol
+    LocateStageExecutable      = 1, ///< Relative to the executable
+    LocateStageBundle          = 2, ///< Relative to the application bundle
+    LocateStageSystem          = 3, ///< Within a system install location
+    LocateStageBundleResources = 4  ///< Within the resources of the application bundle
+};
+
+/**
+*  @brief
+*    Limits of the location functions
+*/
+enum LocateLimit
+{
+    LocateMaxSearchDepth = 64 ///< Maximum upward search depth, larger depths are clamped
+};
+
+
+/**
+*  @brief
+*    Allocation function of a custom allocator
+*
+*  @param[in] size
+*    Number of bytes (greater than zero)
+*  @param[in] userData
+*    User data as passed to setAllocator
+*
+*  @return
+*    Memory, null pointer on failure
+*/
+typedef void * (*LocateAllocate)(size_t size, void * userData);
+
+/**
+*  @brief
+*    Release function of a custom allocator
+*
+*  @param[in] memory
+*    Memory as returned by the allocation function
+*  @param[in] userData
+*    User data as passed to setAllocator
+*/
+typedef void (*LocateRelease)(void * memory, void * userData);
+
+
+/**
+*  @brief
+*    Set the allocator for results and temporaries of all threads
+*
+*  @param[in] allocate
+*    Allocation function (null pointer restores malloc)
+*  @param[in] release
+*    Release function (null pointer restores free)
+*  @param[in] userData
+*    User data passed to both functions
+*
+*  @remark
+*    Results handed to the caller (e.g., paths of locatePath) and
+*    temporaries of each call are allocated with this allocator.
+*    Caches that live across calls always use malloc. Results must be
+*    released with releaseMemory, which uses the allocator each result
+*    stems from, so the allocator may be changed at any time. As long
+*    as no custom allocator was installed, results may also be
+*    released with free.
+*/
+LIBLOCATE_API void setAllocator(LocateAllocate allocate, LocateRelease release, void * userData);
+
+/**
+*  @brief
+*    Set the allocator for results and temporaries of the calling thread
+*
+*  @param[in] allocate
+*    Allocation function (null pointer restores the allocator of setAllocator)
+*  @param[in] release
+*    Release function (null pointer restores the allocator of setAllocator)
+*  @param[in] userData
+*    User data passed to both functions
+*
+*  @remark
+*    Overrides setAllocator for the calling thread. Installing an
+*    allocator around a single call, e.g., one backed by a per-request
+*    arena, scopes it to that call.
+*/
+LIBLOCATE_API void setThreadAllocator(LocateAllocate allocate, LocateRelease release, void * userData);
+
+/**
+*  @brief
+*    Release memory returned by liblocate
+*
+*  @param[in] memory
+*    Result of a liblocate function (may be null pointer)
+*/
+LIBLOCATE_API void releaseMemory(void * memory);
+
 /**
 *  @brief
 *    Get path to the current executable
@@ -77,6 +177,71 @@ LIBLOCATE_API void getModulePath(char ** path, unsigned int * pathLength);
 */
 LIBLOCATE_API void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength);
 
+/**
+*  @brief
+*    Get canonical path to dynamic library
+*
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[out] path
+*    Absolute path to library without symbolic links, or empty string on error
+*  @param[out] pathLength
+*    Length of path
+*
+*  @remark
+*    In contrast to getLibraryPath, which may return a relative path or
+*    the path of a symbolic link, symbolic links are resolved (see canonicalizePath).
+*
+*  @remark
+*    The caller takes memory ownership over *path.
+*/
+LIBLOCATE_API void getCanonicalLibraryPath(void * symbol, char ** path, unsigned int * pathLength);
+
+/**
+*  @brief
+*    Get canonical path to the current module
+*
+*  @param[out] path
+*    Absolute path to module without symbolic links, or empty string on error
+*  @param[out] pathLength
+*    Length of path
+*
+*  @remark
+*    The caller takes memory ownership over *path.
+*/
+LIBLOCATE_API void getCanonicalModulePath(char ** path, unsigned int * pathLength);
+
+/**
+*  @brief
+*    Resolve a path to its canonical form
+*
+*  @param[out] canonical
+*    Absolute path without symbolic links, '.' and '..' components, and
+*    duplicate delimiters, or empty string if path does not exist
+*  @param[out] canonicalLength
+*    Length of canonical
+*  @param[in] path
+*    Absolute or relative path
+*  @param[in] pathLength
+*    Length of path
+*
+*  @remark
+*    Like realpath, but the canonical form of each visited directory
+*    entry is kept in a process-wide cache. Resolving many paths that
+*    share ancestors therefore reads each symbolic link only once.
+*    Use clearCanonicalCache if links change at runtime.
+*
+*  @remark
+*    The caller takes memory ownership over *canonical.
+*/
+LIBLOCATE_API void canonicalizePath(char ** canonical, unsigned int * canonicalLength, const char * path, unsigned int pathLength);
+
+/**
+*  @brief
+*    Discard all cached canonical paths
+*/
+LIBLOCATE_API void clearCanonicalCache();
+
 /**
 *  @brief
 *    Locate path to a file or directory
@@ -104,11 +269,314 @@ LIBLOCATE_API void getLibraryPath(void * symbol, char ** path, unsigned int * pa
 *    string is returned.
 *
 *  @remark
+*    Besides each base directory, the number of parent directories set
+*    with setSearchDepth is checked (two by default).
+*
+*  @remark
+*    Directories found to contain the first component of relPath are
+*    remembered until clearSearchCache, the candidates below them are
+*    probed on each call. With a time to live set by
+*    setSearchCacheTimeToLive, directories found not to contain it are
+*    skipped for that time, so files created there meanwhile are found
+*    only after it expired or after clearSearchCache.
+*
+*  @remark
 *    The caller takes memory ownership over *path.
 */
 LIBLOCATE_API void locatePath(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
     const char * systemDir, unsigned int systemDirLength, void * symbol);
 
+/**
+*  @brief
+*    Locate canonical path to a file or directory
+*
+*  @param[out] path
+*    Canonical base path (with trailing delimiter), or empty string if relPath could not be located
+*  @param[out] pathLength
+*    Length of path
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] relPathLength
+*    Length of relPath
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] systemDirLength
+*    Length of systemDir
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @remark
+*    Like locatePath, but the base path is resolved with canonicalizePath.
+*
+*  @remark
+*    The caller takes memory ownership over *path.
+*/
+LIBLOCATE_API void locateCanonicalPath(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol);
+
+/**
+*  @brief
+*    Locate path to a file or directory with a custom upward search depth
+*
+*  @param[out] path
+*    Path to file or directory
+*  @param[out] pathLength
+*    Length of path
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] relPathLength
+*    Length of relPath
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] systemDirLength
+*    Length of systemDir
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*  @param[in] depth
+*    Number of parent directories checked above each base directory
+*    (e.g., 2 checks '<base>/', '<base>/../', and '<base>/../../'),
+*    clamped to LocateMaxSearchDepth
+*
+*  @remark
+*    Ancestors are memoized as described for locatePath.
+*
+*  @remark
+*    The caller takes memory ownership over *path.
+*/
+LIBLOCATE_API void locatePathWithDepth(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol, unsigned int depth);
+
+/**
+*  @brief
+*    Enable or disable lexical normalization of located paths
+*
+*  @param[in] enabled
+*    '1' to normalize, '0' to return candidate paths verbatim (default)
+*
+*  @remark
+*    If enabled, locatePath, locateAllPaths, and openLocatedFile return
+*    base paths without '.' and '..' components or duplicate delimiters
+*    (e.g., '/opt/app/' instead of '/opt/app/lib/../'), using '/' as
+*    delimiter. The normalization is purely lexical and does not access
+*    the filesystem (see normalizePaths).
+*/
+LIBLOCATE_API void setNormalizedResults(unsigned char enabled);
+
+/**
+*  @brief
+*    Lexically normalize paths in place
+*
+*  @param[inout] paths
+*    Paths, stored back to back as null-terminated strings in a single buffer
+*  @param[inout] pathLengths
+*    Length of each path (excluding null byte)
+*  @param[in] pathCount
+*    Number of paths
+*
+*  @remark
+*    Each path is converted to '/' delimiters, '.' components and
+*    duplicate delimiters are removed, and '..' components are resolved
+*    against the preceding component. Symbolic links are not taken into
+*    account. A root and a trailing delimiter are preserved. Paths are
+*    compacted to the front of the buffer, which stays in the layout
+*    returned by locateAllPaths.
+*/
+LIBLOCATE_API void normalizePaths(char * paths, unsigned int * pathLengths, unsigned int pathCount);
+
+/**
+*  @brief
+*    Convert paths into unified form (replace '\\' with '/')
+*
+*  @param[inout] paths
+*    Paths, stored back to back as null-terminated strings in a single buffer
+*  @param[in] pathLengths
+*    Length of each path (excluding null byte)
+*  @param[in] pathCount
+*    Number of paths
+*
+*  @remark
+*    The path scanning functions use SSE2 or AVX2 instructions if
+*    supported by the processor, which is detected at runtime.
+*/
+LIBLOCATE_API void unifyPaths(char * paths, const unsigned int * pathLengths, unsigned int pathCount);
+
+/**
+*  @brief
+*    Get the directory part of multiple paths
+*
+*  @param[in] paths
+*    Paths, stored back to back as null-terminated strings in a single buffer
+*  @param[in] pathLengths
+*    Length of each path (excluding null byte)
+*  @param[in] pathCount
+*    Number of paths
+*  @param[out] directoryLengths
+*    Length of the directory part of each path, i.e., the position of
+*    the last delimiter (e.g., '/path/to' for '/path/to/file.txt');
+*    paths without delimiter are kept as a whole
+*/
+LIBLOCATE_API void getDirectoryParts(const char * paths, const unsigned int * pathLengths, unsigned int pathCount, unsigned int * directoryLengths);
+
+/**
+*  @brief
+*    Check which paths start with a prefix
+*
+*  @param[in] paths
+*    Paths, stored back to back as null-terminated strings in a single buffer
+*  @param[in] pathLengths
+*    Length of each path (excluding null byte)
+*  @param[in] pathCount
+*    Number of paths
+*  @param[in] prefix
+*    Prefix (compared byte by byte)
+*  @param[in] prefixLength
+*    Length of prefix
+*  @param[out] matches
+*    '1' for each path starting with prefix, else '0'
+*/
+LIBLOCATE_API void matchPathPrefix(const char * paths, const unsigned int * pathLengths, unsigned int pathCount,
+    const char * prefix, unsigned int prefixLength, unsigned char * matches);
+
+/**
+*  @brief
+*    Set the default upward search depth of locatePath, locateAllPaths, and openLocatedFile
+*
+*  @param[in] depth
+*    Number of parent directories checked above each base directory (default: 2),
+*    clamped to LocateMaxSearchDepth
+*/
+LIBLOCATE_API void setSearchDepth(unsigned int depth);
+
+/**
+*  @brief
+*    Get the default upward search depth
+*
+*  @return
+*    Number of parent directories checked above each base directory
+*/
+LIBLOCATE_API unsigned int getSearchDepth();
+
+/**
+*  @brief
+*    Set how long missing ancestors are remembered during location
+*
+*  @param[in] milliseconds
+*    Time to live of memoized misses (default: 0, i.e., misses are not memoized)
+*
+*  @remark
+*    The existence of the first component of relPath is memoized for
+*    each canonical ancestor checked by locatePath, locateAllPaths, and
+*    openLocatedFile. Existing entries are memoized until
+*    clearSearchCache, the candidates below them are probed regardless.
+*    If set, missing entries are memoized as well, so deep searches
+*    probe each distinct ancestor at most once per time to live.
+*/
+LIBLOCATE_API void setSearchCacheTimeToLive(unsigned int milliseconds);
+
+/**
+*  @brief
+*    Discard the memoized existence of directories checked during location
+*/
+LIBLOCATE_API void clearSearchCache();
+
+/**
+*  @brief
+*    Locate all paths to a file or directory
+*
+*  @param[out] paths
+*    Base paths, stored back to back as null-terminated strings in a single buffer
+*  @param[out] pathLengths
+*    Length of each base path (excluding null byte)
+*  @param[out] stages
+*    Search stage of each base path (see LocateStage)
+*  @param[out] pathCount
+*    Number of base paths (the length of pathLengths and stages)
+*  @param[in] relPath
+*    Relative path to a file or directory (e.g., 'data/logo.png')
+*  @param[in] relPathLength
+*    Length of relPath
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] systemDirLength
+*    Length of systemDir
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @remark
+*    In contrast to locatePath, which stops at the first match, all
+*    candidates are evaluated in a single pass and every distinct base
+*    path that contains relPath is returned in priority order. The
+*    first entry equals the result of locatePath.
+*
+*  @remark
+*    The caller takes memory ownership over *paths, *pathLengths, and *stages.
+*/
+LIBLOCATE_API void locateAllPaths(char ** paths, unsigned int ** pathLengths, unsigned char ** stages, unsigned int * pathCount,
+    const char * relPath, unsigned int relPathLength, const char * systemDir, unsigned int systemDirLength, void * symbol);
+
+/**
+*  @brief
+*    Locate and open a file
+*
+*  @param[out] path
+*    Base path from which the relative path was resolved (may be null pointer)
+*  @param[out] pathLength
+*    Length of path
+*  @param[in] relPath
+*    Relative path to a file (e.g., 'data/logo.png')
+*  @param[in] relPathLength
+*    Length of relPath
+*  @param[in] systemDir
+*    Subdirectory for system installs (e.g., 'share/myappname')
+*  @param[in] systemDirLength
+*    Length of systemDir
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @return
+*    Read-only file descriptor, -1 if the file could not be found
+*
+*  @remark
+*    The candidates are the same as for locatePath, but each candidate
+*    is opened directly instead of being checked for existence. This
+*    saves a second path traversal and avoids the race between locating
+*    and opening the file.
+*
+*  @remark
+*    The caller takes ownership over the file descriptor and *path.
+*/
+LIBLOCATE_API int openLocatedFile(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol);
+
+/**
+*  @brief
+*    Register an additional system install prefix
+*
+*  @param[in] prefix
+*    Install prefix (e.g., '/opt/vendor')
+*  @param[in] prefixLength
+*    Length of prefix
+*
+*  @remark
+*    An executable or library in '<prefix>/bin', '<prefix>/lib',
+*    '<prefix>/lib32', or '<prefix>/lib64' is treated as system install,
+*    i.e., locatePath checks '<prefix>/<systemDir>/<relPath>'. The
+*    prefixes '/usr' and '/usr/local' are always recognized, additional
+*    prefixes can be passed through the environment variable
+*    LIBLOCATE_SYSTEM_PREFIXES (separated like PATH entries).
+*    Prefixes registered earlier take precedence.
+*/
+LIBLOCATE_API void addSystemPrefix(const char * prefix, unsigned int prefixLength);
+
+/**
+*  @brief
+*    Remove all system install prefixes registered with addSystemPrefix
+*
+*  @remark
+*    LIBLOCATE_SYSTEM_PREFIXES is read again on the next query.
+*/
+LIBLOCATE_API void resetSystemPrefixes();
+
 /**
 *  @brief
 *    Get platform specific path separator
@@ -162,6 +630,45 @@ LIBLOCATE_API void libExtension(char ** extension, unsigned int * extensionLengt
 */
 LIBLOCATE_API void libExtensions(char *** extensions, unsigned int ** extensionLengths, unsigned int * extensionCount);
 
+/**
+*  @brief
+*    Capture the environment variables used by liblocate anew
+*
+*  @remark
+*    The variables used by liblocate (e.g., HOME, APPDATA, XDG_*, TMPDIR,
+*    PATH, LIBLOCATE_SYSTEM_PREFIXES) are captured into an immutable
+*    snapshot on first use, so directory queries are safe against
+*    concurrent setenv calls and do not allocate for them. Call this
+*    function after changing these variables at runtime; this includes
+*    HOME, which homeDir reads from the snapshot as well.
+*
+*  @remark
+*    Values returned by environmentValue remain valid for the lifetime of
+*    the process, so previous snapshots are never freed. A refresh only
+*    takes a new snapshot if a value changed; each change retains about
+*    the size of the captured values.
+*/
+LIBLOCATE_API void refreshEnvironment();
+
+/**
+*  @brief
+*    Get value of an environment variable from the snapshot
+*
+*  @param[in] name
+*    Name of environment variable used by liblocate (e.g., 'PATH')
+*  @param[in] nameLength
+*    Length of name
+*  @param[out] valueLength
+*    Length of value (may be null)
+*
+*  @return
+*    Null-terminated value, null if the variable is unset, empty, or not part of the snapshot
+*
+*  @remark
+*    The value is owned by liblocate and remains valid for the lifetime of the process.
+*/
+LIBLOCATE_API const char * environmentValue(const char * name, unsigned int nameLength, unsigned int * valueLength);
+
 /**
 *  @brief
 *    Get home directory of the current user
@@ -172,10 +679,23 @@ LIBLOCATE_API void libExtensions(char *** extensions, unsigned int ** extensionL
 *    Length of directory
 *
 *  @remark
+*    HOME is used if set. Like the other variables, it is read from the
+*    environment snapshot, so use refreshEnvironment after changing it
+*    at runtime. Otherwise, the user database is queried (getpwuid_r)
+*    on the first call only, as it may involve network services; use
+*    clearHomeDirCache if the entry changes at runtime.
+*
+*  @remark
 *    The caller takes memory ownership over *dir.
 */
 LIBLOCATE_API void homeDir(char ** dir, unsigned int * dirLength);
 
+/**
+*  @brief
+*    Discard the cached home directory of the user database
+*/
+LIBLOCATE_API void clearHomeDirCache();
+
 /**
 *  @brief
 *    Get profile directory of the current user
@@ -218,6 +738,9 @@ LIBLOCATE_API void documentDir(char ** dir, unsigned int * dirLength);
 *    Length of application name
 *
 *  @remark
+*    Same as configDir.
+*
+*  @remark
 *    The caller takes memory ownership over *dir.
 */
 LIBLOCATE_API void roamingDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
@@ -236,6 +759,9 @@ LIBLOCATE_API void roamingDir(char ** dir, unsigned int * dirLength, const char
 *    Length of application name
 *
 *  @remark
+*    '%LOCALAPPDATA%\\<application>' on Windows, same as dataDir elsewhere.
+*
+*  @remark
 *    The caller takes memory ownership over *dir.
 */
 LIBLOCATE_API void localDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
@@ -254,6 +780,10 @@ LIBLOCATE_API void localDir(char ** dir, unsigned int * dirLength, const char *
 *    Length of application name
 *
 *  @remark
+*    '$XDG_CONFIG_HOME/<application>' (default '~/.config'), '~/Library/Preferences/<application>'
+*    on macOS, and '%APPDATA%\\<application>' on Windows.
+*
+*  @remark
 *    The caller takes memory ownership over *dir.
 */
 LIBLOCATE_API void configDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
@@ -272,10 +802,101 @@ LIBLOCATE_API void configDir(char ** dir, unsigned int * dirLength, const char *
 *    Length of application name
 *
 *  @remark
+*    '$TMPDIR/<application>' (default '/tmp'), or the directory of GetTempPath on Windows.
+*
+*  @remark
 *    The caller takes memory ownership over *dir.
 */
 LIBLOCATE_API void tempDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
 
+/**
+*  @brief
+*    Get data directory for the named application
+*
+*  @param[out] dir
+*    Data directory
+*  @param[out] dirLength
+*    Length of directory
+*  @param[in] application
+*    Application name
+*  @param[in] applicationLength
+*    Length of application name
+*
+*  @remark
+*    '$XDG_DATA_HOME/<application>' (default '~/.local/share'), '~/Library/Application Support/<application>'
+*    on macOS, and '%APPDATA%\\<application>' on Windows.
+*
+*  @remark
+*    The caller takes memory ownership over *dir.
+*/
+LIBLOCATE_API void dataDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
+
+/**
+*  @brief
+*    Get cache directory for the named application
+*
+*  @param[out] dir
+*    Cache directory
+*  @param[out] dirLength
+*    Length of directory
+*  @param[in] application
+*    Application name
+*  @param[in] applicationLength
+*    Length of application name
+*
+*  @remark
+*    '$XDG_CACHE_HOME/<application>' (default '~/.cache'), '~/Library/Caches/<application>'
+*    on macOS, and '%LOCALAPPDATA%\\<application>' on Windows.
+*
+*  @remark
+*    The caller takes memory ownership over *dir.
+*/
+LIBLOCATE_API void cacheDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
+
+/**
+*  @brief
+*    Get state directory for the named application
+*
+*  @param[out] dir
+*    State directory
+*  @param[out] dirLength
+*    Length of directory
+*  @param[in] application
+*    Application name
+*  @param[in] applicationLength
+*    Length of application name
+*
+*  @remark
+*    '$XDG_STATE_HOME/<application>' (default '~/.local/state'), '~/Library/Application Support/<application>'
+*    on macOS, and '%LOCALAPPDATA%\\<application>' on Windows.
+*
+*  @remark
+*    The caller takes memory ownership over *dir.
+*/
+LIBLOCATE_API void stateDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
+
+/**
+*  @brief
+*    Get runtime directory for the named application
+*
+*  @param[out] dir
+*    Runtime directory (e.g., for sockets)
+*  @param[out] dirLength
+*    Length of directory
+*  @param[in] application
+*    Application name
+*  @param[in] applicationLength
+*    Length of application name
+*
+*  @remark
+*    '$XDG_RUNTIME_DIR/<application>', falling back to tempDir if XDG_RUNTIME_DIR is
+*    unset and on Windows and macOS.
+*
+*  @remark
+*    The caller takes memory ownership over *dir.
+*/
+LIBLOCATE_API void runtimeDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength);
+
 
 #ifdef __cplusplus
 } // extern "C"
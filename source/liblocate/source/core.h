@@ -0,0 +1,159 @@
+
+#pragma once
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/**
+*  @brief
+*    Destination of a string result
+*
+*  @remark
+*    The core functions write their results through a sink. The C API
+*    uses sinks that allocate the out-parameters, cpplocate uses sinks
+*    that write into std::string directly.
+*/
+typedef struct
+{
+    char * (*reserve)(void * context, unsigned int length); // provide storage for length characters (terminated by the sink), 0x0 on failure
+    void (*invalidate)(void * context);                     // report that there is no result
+    void * context;                                         // destination passed to both functions
+} StringSink;
+
+/**
+*  @brief
+*    Sink writing into a string out-parameter of the C API
+*/
+typedef struct
+{
+    StringSink sink;             // sink, its context is the out-parameter itself
+    char ** target;              // out-parameter for the string
+    unsigned int * targetLength; // out-parameter for the length (may be 0x0)
+} StringOutParameter;
+
+/**
+*  @brief
+*    Kind of per-application directory
+*/
+typedef enum
+{
+    ConfigDirectory,    ///< Configuration (XDG_CONFIG_HOME)
+    DataDirectory,      ///< Data, possibly shared between machines (XDG_DATA_HOME)
+    LocalDirectory,     ///< Data specific to this machine
+    CacheDirectory,     ///< Non-essential data (XDG_CACHE_HOME)
+    StateDirectory,     ///< State that persists between restarts (XDG_STATE_HOME)
+    TemporaryDirectory, ///< Temporary files (TMPDIR)
+    RuntimeDirectory    ///< Runtime files (XDG_RUNTIME_DIR)
+} ApplicationDirectory;
+
+/**
+*  @brief
+*    Initialize a sink that allocates a string out-parameter
+*
+*  @param[out] out
+*    Sink (must outlive its use)
+*  @param[in] target
+*    Out-parameter for the string
+*  @param[in] targetLength
+*    Out-parameter for the length (may be 0x0)
+*/
+void initStringOutParameter(StringOutParameter * out, char ** target, unsigned int * targetLength);
+
+/**
+*  @brief
+*    Write a string to a sink
+*/
+void writeStringSink(const StringSink * sink, const char * source, unsigned int length);
+
+/**
+*  @brief
+*    Report that there is no result to a sink
+*/
+void invalidateStringSink(const StringSink * sink);
+
+/**
+*  @brief
+*    Core of getExecutablePath
+*/
+void executablePathTo(const StringSink * sink);
+
+/**
+*  @brief
+*    Core of getBundlePath
+*/
+void bundlePathTo(const StringSink * sink);
+
+/**
+*  @brief
+*    Core of getModulePath
+*/
+void modulePathTo(const StringSink * sink);
+
+/**
+*  @brief
+*    Core of getLibraryPath
+*/
+void libraryPathTo(void * symbol, const StringSink * sink);
+
+/**
+*  @brief
+*    Core of getCanonicalLibraryPath
+*/
+void canonicalLibraryPathTo(void * symbol, const StringSink * sink);
+
+/**
+*  @brief
+*    Core of getCanonicalModulePath
+*/
+void canonicalModulePathTo(const StringSink * sink);
+
+/**
+*  @brief
+*    Core of canonicalizePath
+*/
+void canonicalPathTo(const char * path, unsigned int pathLength, const StringSink * sink);
+
+/**
+*  @brief
+*    Core of locatePathWithDepth
+*/
+void locatePathTo(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol, unsigned int depth);
+
+/**
+*  @brief
+*    Core of locatePathWithDepth for a library path instead of a symbol
+*
+*  @remark
+*    Used to repeat recorded queries, whose symbols are not known anymore.
+*/
+void locatePathFromLibraryPathTo(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, const char * libraryPath, unsigned int libraryPathLength, unsigned int depth);
+
+/**
+*  @brief
+*    Core of locateCanonicalPath
+*/
+void locateCanonicalPathTo(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol);
+
+/**
+*  @brief
+*    Core of homeDir
+*/
+void homeDirTo(const StringSink * sink);
+
+/**
+*  @brief
+*    Core of configDir, dataDir, tempDir, and the other per-application directories
+*/
+void applicationDirectoryTo(const StringSink * sink, ApplicationDirectory kind, const char * application, unsigned int applicationLength);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,8 +1,10 @@
 
 #include <liblocate/liblocate.h>
 
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 #if defined(SYSTEM_LINUX)
     #include <unistd.h>
@@ -34,16 +36,26 @@
 #endif
 
 #include "utils.h"
+#include "core.h"
 
 
-void getExecutablePath(char ** path, unsigned int * pathLength)
+void setAllocator(LocateAllocate allocate, LocateRelease release, void * userData)
 {
-    // Early exit when invalid out-parameters are passed
-    if (!checkStringOutParameter(path, pathLength))
-    {
-        return;
-    }
+    installAllocator(allocate, release, userData, 0);
+}
+
+void setThreadAllocator(LocateAllocate allocate, LocateRelease release, void * userData)
+{
+    installAllocator(allocate, release, userData, 1);
+}
+
+void releaseMemory(void * memory)
+{
+    freeMemory(memory);
+}
 
+void executablePathTo(const StringSink * sink)
+{
 #if defined SYSTEM_LINUX
 
     // Preallocate PATH_MAX (e.g., 4096) characters and hope the executable path isn't longer (including null byte)
@@ -54,12 +66,12 @@ void getExecutablePath(char ** path, unsigned int * pathLength)
 
     if (len <= 0 || len == PATH_MAX) // memory not sufficient or general error occured
     {
-        invalidateStringOutParameter(path, pathLength);
+        invalidateStringSink(sink);
         return;
     }
 
-    // Copy contents to caller, create caller ownership
-    copyToStringOutParameter(exePath, len, path, pathLength);
+    // Write contents to caller
+    writeStringSink(sink, exePath, len);
 
 #elif defined SYSTEM_WINDOWS
 
@@ -70,12 +82,12 @@ void getExecutablePath(char ** path, unsigned int * pathLength)
     unsigned int len = GetModuleFileNameA(GetModuleHandleA(0x0), exePath, MAX_PATH);
     if (len == 0) // memory not sufficient or general error occured
     {
-        invalidateStringOutParameter(path, pathLength);
+        invalidateStringSink(sink);
         return;
     }
 
-    // Copy contents to caller, create caller ownership
-    copyToStringOutParameter(exePath, len, path, pathLength);
+    // Write contents to caller
+    writeStringSink(sink, exePath, len);
 
 #elif defined SYSTEM_SOLARIS
 
@@ -85,13 +97,13 @@ void getExecutablePath(char ** path, unsigned int * pathLength)
     // Convert executable path to canonical path, return null pointer on error
     if (realpath(getexecname(), exePath) == 0x0)
     {
-        invalidateStringOutParameter(path, pathLength);
+        invalidateStringSink(sink);
         return;
     }
 
-    // Copy contents to caller, create caller ownership
+    // Write contents to caller
     unsigned int len = strlen(exePath);
-    copyToStringOutParameter(exePath, len, path, pathLength);
+    writeStringSink(sink, exePath, len);
 
 #elif defined SYSTEM_DARWIN
 
@@ -108,42 +120,48 @@ void getExecutablePath(char ** path, unsigned int * pathLength)
 
         if (realPath == 0x0)
         {
-            invalidateStringOutParameter(path, pathLength);
+            invalidateStringSink(sink);
             return;
         }
 
-        // Copy contents to caller, create caller ownership
+        // Write contents to caller
         unsigned int len = strlen(realPath);
-        copyToStringOutParameter(realPath, len, path, pathLength);
+        writeStringSink(sink, realPath, len);
 
         free(realPath);
     }
     else // len is initialized with the required number of bytes (including zero byte)
     {
-        char * intermediatePath = (char *)malloc(sizeof(char) * len);
+        char * intermediatePath = (char *)allocateMemory(sizeof(char) * len);
+
+        if (intermediatePath == 0x0)
+        {
+            invalidateStringSink(sink);
+            return;
+        }
 
         // Convert executable path to canonical path, return null pointer on error
         if (_NSGetExecutablePath(intermediatePath, &len) != 0)
         {
-            free(intermediatePath);
-            invalidateStringOutParameter(path, pathLength);
+            freeMemory(intermediatePath);
+            invalidateStringSink(sink);
             return;
         }
 
         char * realPath = realpath(intermediatePath, 0x0);
 
-        free(intermediatePath);
+        freeMemory(intermediatePath);
 
         // Check if conversion to canonical path succeeded
         if (realPath == 0x0)
         {
-            invalidateStringOutParameter(path, pathLength);
+            invalidateStringSink(sink);
             return;
         }
 
-        // Copy contents to caller, create caller ownership
+        // Write contents to caller
         unsigned int len = strlen(realPath);
-        copyToStringOutParameter(realPath, len, path, pathLength);
+        writeStringSink(sink, realPath, len);
 
         free(realPath);
     }
@@ -160,22 +178,22 @@ void getExecutablePath(char ** path, unsigned int * pathLength)
     // Obtain executable path by syscall
     if (sysctl(mib, 4, exePath, &len, 0x0, 0) != 0)
     {
-        invalidateStringOutParameter(path, pathLength);
+        invalidateStringSink(sink);
         return;
     }
 
-    // Copy contents to caller, create caller ownership
-    copyToStringOutParameter(exePath, len, path, pathLength);
+    // Write contents to caller
+    writeStringSink(sink, exePath, len);
 
 #else
 
     // If no OS could be detected ... degrade gracefully
-    invalidateStringOutParameter(path, pathLength);
+    invalidateStringSink(sink);
 
 #endif
 }
 
-void getBundlePath(char ** path, unsigned int * pathLength)
+void getExecutablePath(char ** path, unsigned int * pathLength)
 {
     // Early exit when invalid out-parameters are passed
     if (!checkStringOutParameter(path, pathLength))
@@ -183,6 +201,14 @@ void getBundlePath(char ** path, unsigned int * pathLength)
         return;
     }
 
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
+
+    executablePathTo(&out.sink);
+}
+
+void bundlePathTo(const StringSink * sink)
+{
     // Get directory where the executable is located
     char * executablePath = 0x0;
     unsigned int executablePathLength = 0;
@@ -201,18 +227,18 @@ void getBundlePath(char ** path, unsigned int * pathLength)
 
     if (bundlePathLength == 0) // No bundle
     {
-        free(executablePath);
-        invalidateStringOutParameter(path, pathLength);
+        freeMemory(executablePath);
+        invalidateStringSink(sink);
         return;
     }
 
-    // Copy contents to caller, create caller ownership
-    copyToStringOutParameter(executablePath, bundlePathLength, path, pathLength);
+    // Write contents to caller
+    writeStringSink(sink, executablePath, bundlePathLength);
 
-    free(executablePath);
+    freeMemory(executablePath);
 }
 
-void getModulePath(char ** path, unsigned int * pathLength)
+void getBundlePath(char ** path, unsigned int * pathLength)
 {
     // Early exit when invalid out-parameters are passed
     if (!checkStringOutParameter(path, pathLength))
@@ -220,6 +246,14 @@ void getModulePath(char ** path, unsigned int * pathLength)
         return;
     }
 
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
+
+    bundlePathTo(&out.sink);
+}
+
+void modulePathTo(const StringSink * sink)
+{
     char * executablePath = 0x0;
     unsigned int executablePathLength = 0;
     getExecutablePath(&executablePath, &executablePathLength);
@@ -227,12 +261,12 @@ void getModulePath(char ** path, unsigned int * pathLength)
 
     getDirectoryPart(executablePath, executablePathLength, &executablePathDirectoryLength);
 
-    copyToStringOutParameter(executablePath, executablePathDirectoryLength, path, pathLength);
+    writeStringSink(sink, executablePath, executablePathDirectoryLength);
 
-    free(executablePath);
+    freeMemory(executablePath);
 }
 
-void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
+void getModulePath(char ** path, unsigned int * pathLength)
 {
     // Early exit when invalid out-parameters are passed
     if (!checkStringOutParameter(path, pathLength))
@@ -240,9 +274,17 @@ void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
         return;
     }
 
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
+
+    modulePathTo(&out.sink);
+}
+
+void libraryPathTo(void * symbol, const StringSink * sink)
+{
     if (!symbol)
     {
-        invalidateStringOutParameter(path, pathLength);
+        invalidateStringSink(sink);
         return;
     }
 
@@ -263,7 +305,7 @@ void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
 
     unsigned int len = (unsigned int)strnlen(systemPath, MAX_PATH);
 
-    copyToStringOutParameter(systemPath, len, path, pathLength);
+    writeStringSink(sink, systemPath, len);
 
 #else
 
@@ -272,12 +314,12 @@ void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
 
     if (!dlInfo.dli_fname)
     {
-        invalidateStringOutParameter(path, pathLength);
+        invalidateStringSink(sink);
         return;
     }
 
     unsigned int len = strlen(dlInfo.dli_fname);
-    copyToStringOutParameter(dlInfo.dli_fname, len, path, pathLength);
+    writeStringSink(sink, dlInfo.dli_fname, len);
 
 #endif
 
@@ -285,8 +327,60 @@ void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
     // unifyPathDelimiters(*path, *pathLength);
 }
 
-void locatePath(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
-    const char * systemDir, unsigned int systemDirLength, void * symbol)
+void getLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(path, pathLength))
+    {
+        return;
+    }
+
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
+
+    libraryPathTo(symbol, &out.sink);
+}
+
+void canonicalLibraryPathTo(void * symbol, const StringSink * sink)
+{
+    char * libraryPath = 0x0;
+    unsigned int libraryPathLength = 0;
+    getLibraryPath(symbol, &libraryPath, &libraryPathLength);
+
+    canonicalPathTo(libraryPath, libraryPathLength, sink);
+
+    freeMemory(libraryPath);
+}
+
+void getCanonicalLibraryPath(void * symbol, char ** path, unsigned int * pathLength)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(path, pathLength))
+    {
+        return;
+    }
+
+    char * libraryPath = 0x0;
+    unsigned int libraryPathLength = 0;
+    getLibraryPath(symbol, &libraryPath, &libraryPathLength);
+
+    canonicalPath(libraryPath, libraryPathLength, path, pathLength);
+
+    freeMemory(libraryPath);
+}
+
+void canonicalModulePathTo(const StringSink * sink)
+{
+    char * modulePath = 0x0;
+    unsigned int modulePathLength = 0;
+    getModulePath(&modulePath, &modulePathLength);
+
+    canonicalPathTo(modulePath, modulePathLength, sink);
+
+    freeMemory(modulePath);
+}
+
+void getCanonicalModulePath(char ** path, unsigned int * pathLength)
 {
     // Early exit when invalid out-parameters are passed
     if (!checkStringOutParameter(path, pathLength))
@@ -294,6 +388,278 @@ void locatePath(char ** path, unsigned int * pathLength, const char * relPath, u
         return;
     }
 
+    char * modulePath = 0x0;
+    unsigned int modulePathLength = 0;
+    getModulePath(&modulePath, &modulePathLength);
+
+    canonicalPath(modulePath, modulePathLength, path, pathLength);
+
+    freeMemory(modulePath);
+}
+
+void canonicalizePath(char ** canonical, unsigned int * canonicalLength, const char * path, unsigned int pathLength)
+{
+    canonicalPath(path, pathLength, canonical, canonicalLength);
+}
+
+void clearCanonicalCache()
+{
+    clearCanonicalPathCache();
+}
+
+/**
+*  @brief
+*    Process-wide memo of the existence of '<ancestor>/<first relPath component>'
+*
+*  @remark
+*    Open addressing hash table, keyed by the canonical ancestor, so an
+*    ancestor reached from several base directories shares one entry.
+*/
+typedef struct
+{
+    char ** keys;                 // memoized paths, 0x0 for empty slots
+    unsigned int * keyLengths;    // length of each memoized path
+    unsigned char * values;       // '1' if the path exists, else '0'
+    unsigned long long * expiries; // time after which a missing path is probed again (milliseconds)
+    unsigned int capacity;        // number of slots (power of two)
+    unsigned int count;           // number of used slots
+} AncestorMemo;
+
+static AncestorMemo ancestorMemo = { 0x0, 0x0, 0x0, 0x0, 0, 0 };
+static unsigned int searchCacheTimeToLive = 0;
+static unsigned int defaultSearchDepth = 2;
+static unsigned char normalizeResults = 0;
+
+static unsigned char getNormalizeResults()
+{
+    lockGlobalState();
+
+    const unsigned char enabled = normalizeResults;
+
+    unlockGlobalState();
+
+    return enabled;
+}
+
+static unsigned long long currentMilliseconds()
+{
+#if defined(SYSTEM_WINDOWS)
+    return (unsigned long long)GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long)now.tv_sec * 1000 + (unsigned long long)now.tv_nsec / 1000000;
+#endif
+}
+
+static unsigned int clampSearchDepth(unsigned int depth)
+{
+    return depth < LocateMaxSearchDepth ? depth : LocateMaxSearchDepth;
+}
+
+static unsigned int hashPath(const char * path, unsigned int pathLength)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+
+    for (unsigned int i = 0; i < pathLength; ++i)
+    {
+        hash ^= (unsigned char)path[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static unsigned int findAncestorMemoSlot(const AncestorMemo * memo, const char * path, unsigned int pathLength)
+{
+    unsigned int slot = hashPath(path, pathLength) & (memo->capacity - 1);
+
+    while (memo->keys[slot] != 0x0
+        && (memo->keyLengths[slot] != pathLength || memcmp(memo->keys[slot], path, pathLength) != 0))
+    {
+        slot = (slot + 1) & (memo->capacity - 1);
+    }
+
+    return slot;
+}
+
+static void growAncestorMemo(AncestorMemo * memo)
+{
+    AncestorMemo grown;
+    grown.capacity = memo->capacity > 0 ? memo->capacity * 2 : 64;
+    grown.count = memo->count;
+    grown.keys = (char **)calloc(grown.capacity, sizeof(char *));
+    grown.keyLengths = (unsigned int *)malloc(sizeof(unsigned int) * grown.capacity);
+    grown.values = (unsigned char *)malloc(sizeof(unsigned char) * grown.capacity);
+    grown.expiries = (unsigned long long *)malloc(sizeof(unsigned long long) * grown.capacity);
+
+    for (unsigned int i = 0; i < memo->capacity; ++i)
+    {
+        if (memo->keys[i] == 0x0)
+        {
+            continue;
+        }
+
+        const unsigned int slot = findAncestorMemoSlot(&grown, memo->keys[i], memo->keyLengths[i]);
+        grown.keys[slot] = memo->keys[i];
+        grown.keyLengths[slot] = memo->keyLengths[i];
+        grown.values[slot] = memo->values[i];
+        grown.expiries[slot] = memo->expiries[i];
+    }
+
+    free(memo->keys);
+    free(memo->keyLengths);
+    free(memo->values);
+    free(memo->expiries);
+
+    *memo = grown;
+}
+
+/**
+*  @brief
+*    Check if a path exists, consulting and updating the ancestor memo
+*
+*  @param[in] path
+*    Path to check (null-terminated)
+*  @param[in] pathLength
+*    Length of path
+*  @param[out] probed
+*    '1' if the filesystem was accessed, '0' if the memo answered
+*
+*  @return
+*    '1' if path exists, else '0'
+*
+*  @remark
+*    Existing paths are remembered until clearSearchCache, as every
+*    candidate below them is probed anyway. Missing paths are remembered
+*    for the time to live set with setSearchCacheTimeToLive.
+*/
+static unsigned char ancestorEntryExists(const char * path, unsigned int pathLength, unsigned char * probed)
+{
+    const unsigned long long now = currentMilliseconds();
+
+    lockGlobalState();
+
+    const unsigned int timeToLive = searchCacheTimeToLive;
+
+    if (ancestorMemo.capacity > 0)
+    {
+        const unsigned int slot = findAncestorMemoSlot(&ancestorMemo, path, pathLength);
+
+        if (ancestorMemo.keys[slot] != 0x0 && (ancestorMemo.values[slot] || now < ancestorMemo.expiries[slot]))
+        {
+            const unsigned char exists = ancestorMemo.values[slot];
+
+            unlockGlobalState();
+
+            *probed = 0;
+
+            return exists;
+        }
+    }
+
+    unlockGlobalState();
+
+    // Probe without holding the lock; concurrent queries may probe the same path once each
+    const unsigned char exists = fileExists(path, pathLength);
+
+    *probed = 1;
+
+    // Misses are only memoized with a time to live, existing entries always
+    if (!exists && timeToLive == 0)
+    {
+        return exists;
+    }
+
+    lockGlobalState();
+
+    if (2 * (ancestorMemo.count + 1) > ancestorMemo.capacity)
+    {
+        growAncestorMemo(&ancestorMemo);
+    }
+
+    const unsigned int slot = findAncestorMemoSlot(&ancestorMemo, path, pathLength);
+
+    if (ancestorMemo.keys[slot] == 0x0)
+    {
+        copyToString(path, pathLength, ancestorMemo.keys + slot, ancestorMemo.keyLengths + slot);
+        ++ancestorMemo.count;
+    }
+
+    ancestorMemo.values[slot] = exists;
+    ancestorMemo.expiries[slot] = now + timeToLive;
+
+    unlockGlobalState();
+
+    return exists;
+}
+
+/**
+*  @brief
+*    Check a candidate path during location
+*
+*  @param[in] candidate
+*    Candidate path (null-terminated)
+*  @param[in] candidateLength
+*    Length of candidate
+*  @param[in] baseLength
+*    Length of the base path part of candidate
+*  @param[in] stage
+*    Search stage of the candidate (see LocateStage)
+*  @param[in] context
+*    User data passed to locateCandidate
+*
+*  @return
+*    '1' if the candidate is accepted and the search should stop, else '0'
+*/
+typedef unsigned char (*LocateProbe)(const char * candidate, unsigned int candidateLength, unsigned int baseLength, unsigned char stage, void * context);
+
+static unsigned char probeFileExists(const char * candidate, unsigned int candidateLength, unsigned int baseLength, unsigned char stage, void * context);
+
+/**
+*  @brief
+*    Search the candidate locations of a relative path
+*
+*  @param[in] sink
+*    Destination of the base path of the accepted candidate (may be null pointer)
+*  @param[in] relPath
+*    Relative path to a file or directory
+*  @param[in] relPathLength
+*    Length of relPath
+*  @param[in] systemDir
+*    Subdirectory for system installs
+*  @param[in] systemDirLength
+*    Length of systemDir
+*  @param[in] libraryPath
+*    Path of the library whose directory is the first base directory (may be null pointer)
+*  @param[in] libraryPathLength
+*    Length of libraryPath
+*  @param[in] depth
+*    Number of parent directories checked above each base directory
+*  @param[in] probe
+*    Callback that decides whether a candidate is accepted
+*  @param[in] context
+*    User data passed to probe
+*
+*  @remark
+*    The candidates are visited in the order documented for locatePath.
+*    If no candidate is accepted, an empty string is returned.
+*/
+static void locateCandidateFrom(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, const char * libraryPath, unsigned int libraryPathLength,
+    unsigned int depth, LocateProbe probe, void * context)
+{
+    // Obtain length of the first component of relPath, whose existence is memoized per ancestor
+    unsigned int componentLength = 0;
+    while (componentLength < relPathLength && relPath[componentLength] != '/' && relPath[componentLength] != '\\')
+    {
+        ++componentLength;
+    }
+
+    const unsigned char memoize = componentLength > 0;
+
     // Obtain executable path
     char * executablePath = 0x0;
     unsigned int executablePathLength = 0;
@@ -305,10 +671,6 @@ void locatePath(char ** path, unsigned int * pathLength, const char * relPath, u
     unsigned int bundlePathLength = 0;
     getBundlePath(&bundlePath, &bundlePathLength);
 
-    // Obtain library path
-    char * libraryPath = 0x0;
-    unsigned int libraryPathLength = 0;
-    getLibraryPath(symbol, &libraryPath, &libraryPathLength);
     unsigned int libraryPathDirectoryLength = 0;
 
     // Extract directory parts of executable and library paths
@@ -316,15 +678,29 @@ void locatePath(char ** path, unsigned int * pathLength, const char * relPath, u
     getDirectoryPart(executablePath, executablePathLength, &executablePathDirectoryLength);
 
     // Compute the size of the maximal possible path to circumvent reallocation of output
-    unsigned int maxLength = executablePathDirectoryLength;
+    size_t maxLength = executablePathDirectoryLength;
     maxLength = maxLength > libraryPathDirectoryLength ? maxLength : libraryPathDirectoryLength;
-    maxLength = maxLength > bundlePathLength + 19 ? maxLength : bundlePathLength + 19; // for "/Contents/Resources"
-    maxLength += relPathLength + 7 + 2; // for the extra upward path checks, the extra path delimiter and null byte suffix
+    maxLength = maxLength > (size_t)bundlePathLength + 19 ? maxLength : (size_t)bundlePathLength + 19; // for "/Contents/Resources"
+    maxLength += (size_t)relPathLength + 3 * (size_t)depth + 1 + 2; // for the extra upward path checks, the extra path delimiter and null byte suffix
+    maxLength += systemDirLength; // for the system install checks
+
+    // Candidate lengths are unsigned int
+    char * subdir = maxLength <= (unsigned int)-1 ? (char *)allocateMemory(sizeof(char) * maxLength) : 0x0;
+
+    if (subdir == 0x0)
+    {
+        if (sink != 0x0)
+        {
+            invalidateStringSink(sink);
+        }
+
+        goto out;
+    }
 
     const char * dirs[] = { libraryPath, executablePath, bundlePath };
     const unsigned int lengths[] = { libraryPathDirectoryLength, executablePathDirectoryLength, bundlePathLength };
+    const unsigned char stages[] = { LocateStageLibrary, LocateStageExecutable, LocateStageBundle };
 
-    char * subdir = (char *)malloc(sizeof(char) * maxLength);
     unsigned int subdirLength = 0;
     unsigned int resultdirLength = 0;
 
@@ -344,28 +720,77 @@ void locatePath(char ** path, unsigned int * pathLength, const char * relPath, u
         // Initialize directory to test with base directory
         memcpy(subdir, dir, length);
 
-        // Check <basedir>/<relpath>, <basedir>/../<relpath>, and <basedir>/../../<relpath>
-        for (unsigned char j = 0; j < 3; ++j)
+        // Ancestors are memoized by their canonical form, '<base>/../' is the parent of the canonical base
+        char * canonicalBase = 0x0;
+        unsigned int canonicalBaseLength = 0;
+        char * key = 0x0;
+
+        if (memoize)
         {
-            unsigned char relDirLength = j * 3 + 1;
+            canonicalizePath(&canonicalBase, &canonicalBaseLength, dir, length);
+
+            key = canonicalBaseLength > 0 ? (char *)allocateMemory(sizeof(char) * (canonicalBaseLength + componentLength + 2)) : 0x0;
+        }
+
+        unsigned int ancestorLength = canonicalBaseLength;
+        unsigned char accepted = 0;
+
+        // Check <basedir>/<relpath>, <basedir>/../<relpath>, <basedir>/../../<relpath>, ..., up to depth levels
+        subdirLength = length;
+        subdir[subdirLength++] = '/';
+
+        for (unsigned int j = 0; j <= depth && !accepted; ++j)
+        {
+            if (j > 0)
+            {
+                memcpy(subdir+subdirLength, "../", 3);
+                subdirLength += 3;
+
+                if (key != 0x0)
+                {
+                    const unsigned int delimiter = findLastPathDelimiter(canonicalBase, ancestorLength);
+                    ancestorLength = delimiter < ancestorLength ? delimiter : ancestorLength;
+                }
+            }
 
-            subdirLength = length;
-            // Copy either '/', '/../', or '/../../', depending on current iteration
-            memcpy(subdir+subdirLength, "/../../", relDirLength);
-            subdirLength += relDirLength;
-            memcpy(subdir+subdirLength, relPath, relPathLength);
             resultdirLength = subdirLength;
-            subdirLength += relPathLength;
+            memcpy(subdir+resultdirLength, relPath, relPathLength);
 
             // End subdirectory with null byte for system functions
-            subdir[subdirLength] = 0;
+            subdir[resultdirLength + relPathLength] = 0;
 
-            if (fileExists(subdir, subdirLength)) // successfully found directory
+            // Skip ancestors that do not contain the first component of relPath
+            if (key != 0x0)
             {
-                copyToStringOutParameter(subdir, resultdirLength, path, pathLength);
-
-                goto out;
+                memcpy(key, canonicalBase, ancestorLength);
+                key[ancestorLength] = '/';
+                memcpy(key + ancestorLength + 1, relPath, componentLength);
+                key[ancestorLength + 1 + componentLength] = 0;
+
+                unsigned char probed = 0;
+
+                if (!ancestorEntryExists(key, ancestorLength + 1 + componentLength, &probed))
+                {
+                    continue;
+                }
+
+                // The candidate itself has just been probed
+                if (probed && componentLength == relPathLength && probe == probeFileExists)
+                {
+                    accepted = 1;
+                    continue;
+                }
             }
+
+            accepted = probe(subdir, resultdirLength + relPathLength, resultdirLength, stages[i], context);
+        }
+
+        freeMemory(key);
+        freeMemory(canonicalBase);
+
+        if (accepted) // successfully found directory
+        {
+            goto found;
         }
 
         if (systemDirLength <= 0)
@@ -393,11 +818,9 @@ void locatePath(char ** path, unsigned int * pathLength, const char * relPath, u
             // End subdirectory with null byte for system functions
             subdir[subdirLength] = 0;
 
-            if (fileExists(subdir, subdirLength)) // successfully found directory
+            if (probe(subdir, subdirLength, resultdirLength, LocateStageSystem, context)) // successfully found directory
             {
-                copyToStringOutParameter(subdir, resultdirLength, path, pathLength);
-
-                goto out;
+                goto found;
             }
         }
     }
@@ -421,154 +844,691 @@ void locatePath(char ** path, unsigned int * pathLength, const char * relPath, u
         // End subdirectory with null byte for system functions
         subdir[subdirLength] = 0;
 
-        if (fileExists(subdir, subdirLength)) // successfully found directory
+        if (probe(subdir, subdirLength, resultdirLength, LocateStageBundleResources, context)) // successfully found directory
         {
-            copyToStringOutParameter(subdir, resultdirLength, path, pathLength);
-
-            goto out;
+            goto found;
         }
     }
 
     // Could not find path
-    invalidateStringOutParameter(path, pathLength);
+    if (sink != 0x0)
+    {
+        invalidateStringSink(sink);
+    }
+
+    goto out;
+
+found:
+    if (sink != 0x0)
+    {
+        if (getNormalizeResults())
+        {
+            normalizePath(subdir, resultdirLength, &resultdirLength);
+        }
+
+        writeStringSink(sink, subdir, resultdirLength);
+    }
 
 out:
     // Free temporary memory
-    free(libraryPath);
-    free(executablePath);
-    free(bundlePath);
-    free(subdir);
+    freeMemory(executablePath);
+    freeMemory(bundlePath);
+    freeMemory(subdir);
 }
 
-void pathSeparator(char * sep)
+/**
+*  @brief
+*    Search the candidate locations of a relative path for the library of a symbol
+*
+*  @param[in] symbol
+*    A symbol from the library, e.g., a function or variable pointer
+*
+*  @remark
+*    The other parameters are the same as for locateCandidateFrom.
+*/
+static void locateCandidate(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol, unsigned int depth, LocateProbe probe, void * context)
 {
-    if (sep != 0x0)
-    {
-#ifdef SYSTEM_WINDOWS
-        *sep = '\\';
-#else
-        *sep = '/';
-#endif
-    }
+    // Obtain library path
+    char * libraryPath = 0x0;
+    unsigned int libraryPathLength = 0;
+    getLibraryPath(symbol, &libraryPath, &libraryPathLength);
+
+    locateCandidateFrom(sink, relPath, relPathLength, systemDir, systemDirLength, libraryPath, libraryPathLength, depth, probe, context);
+
+    freeMemory(libraryPath);
 }
 
-void libPrefix(char ** prefix, unsigned int * prefixLength)
+static unsigned char probeFileExists(const char * candidate, unsigned int candidateLength, unsigned int baseLength, unsigned char stage, void * context)
 {
-    // Early exit when invalid out-parameters are passed
-    if (!checkStringOutParameter(prefix, prefixLength))
-    {
-        return;
-    }
+    (void)baseLength;
+    (void)stage;
+    (void)context;
 
-#if defined SYSTEM_WINDOWS || defined SYSTEM_DARWIN
-    copyToStringOutParameter("", 0, prefix, prefixLength);
-#else
-    copyToStringOutParameter("lib", 3, prefix, prefixLength);
-#endif
+    return fileExists(candidate, candidateLength);
 }
 
-void libExtension(char ** extension, unsigned int * extensionLength)
+static unsigned char probeOpenFile(const char * candidate, unsigned int candidateLength, unsigned int baseLength, unsigned char stage, void * context)
 {
-    // Early exit when invalid out-parameters are passed
-    if (!checkStringOutParameter(extension, extensionLength))
-    {
-        return;
-    }
+    int * fd = (int *)context;
 
-#if defined SYSTEM_WINDOWS
-    copyToStringOutParameter("dll", 3, extension, extensionLength);
-#elif defined SYSTEM_DARWIN
-    copyToStringOutParameter("dylib", 5, extension, extensionLength);
-#else
-    copyToStringOutParameter("so", 2, extension, extensionLength);
-#endif
+    (void)baseLength;
+    (void)stage;
+
+    *fd = openFile(candidate, candidateLength);
+
+    return *fd >= 0;
 }
 
-void libExtensions(char *** extensions, unsigned int ** extensionLengths, unsigned int * extensionCount)
+/**
+*  @brief
+*    Matches collected by locateAllPaths
+*/
+typedef struct
 {
-    // Early exit when invalid out-parameters are passed
-    if (!checkStringVectorOutParameter(extensions, extensionLengths, extensionCount))
+    char * arena;             // null-terminated base paths, stored back to back
+    unsigned int arenaLength; // used bytes of arena
+    unsigned int arenaSize;   // allocated bytes of arena
+    unsigned int * lengths;   // length of each base path
+    unsigned char * stages;   // search stage of each base path
+    unsigned int count;       // number of base paths
+    unsigned char normalize;  // normalize base paths before comparison
+} LocateMatches;
+
+static unsigned char probeCollectMatches(const char * candidate, unsigned int candidateLength, unsigned int baseLength, unsigned char stage, void * context)
+{
+    LocateMatches * matches = (LocateMatches *)context;
+
+    if (!fileExists(candidate, candidateLength))
     {
-        return;
+        return 0;
     }
 
-#if defined SYSTEM_WINDOWS
-    *extensionCount = 1;
-    *extensions = (char **)malloc(sizeof(char *) * *extensionCount);
-    *extensionLengths = (unsigned int *)malloc(sizeof(unsigned int) * *extensionCount);
-    copyToStringOutParameter("dll", 3, *extensions + 0, *extensionLengths + 0);
-#elif defined SYSTEM_DARWIN
-    *extensionCount = 2;
-    *extensions = (char **)malloc(sizeof(char *) * *extensionCount);
-    *extensionLengths = (unsigned int *)malloc(sizeof(unsigned int) * *extensionCount);
-    copyToStringOutParameter("dylib", 5, *extensions + 0, *extensionLengths + 0);
-    copyToStringOutParameter("so", 2, *extensions + 1, *extensionLengths + 1);
-#else
-    *extensionCount = 1;
-    *extensions = (char **)malloc(sizeof(char *) * *extensionCount);
-    *extensionLengths = (unsigned int *)malloc(sizeof(unsigned int) * *extensionCount);
-    copyToStringOutParameter("so", 2, *extensions + 0, *extensionLengths + 0);
-#endif
-}
+    if (matches->arenaLength + baseLength + 1 > matches->arenaSize)
+    {
+        matches->arenaSize = (matches->arenaLength + baseLength + 1) * 2;
+        matches->arena = (char *)realloc(matches->arena, sizeof(char) * matches->arenaSize);
+    }
 
-void homeDir(char ** dir, unsigned int * dirLength)
+    // Append base path tentatively
+    char * base = matches->arena + matches->arenaLength;
+    memcpy(base, candidate, baseLength);
+
+    if (matches->normalize)
+    {
+        normalizePath(base, baseLength, &baseLength);
+    }
+
+    base[baseLength] = 0;
+
+    // Skip base paths that were already found at an earlier stage (e.g., library and executable in the same directory)
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < matches->count; ++i)
+    {
+        if (matches->lengths[i] == baseLength && memcmp(matches->arena + offset, base, baseLength) == 0)
+        {
+            return 0;
+        }
+
+        offset += matches->lengths[i] + 1;
+    }
+
+    matches->lengths = (unsigned int *)realloc(matches->lengths, sizeof(unsigned int) * (matches->count + 1));
+    matches->stages = (unsigned char *)realloc(matches->stages, sizeof(unsigned char) * (matches->count + 1));
+
+    matches->arenaLength += baseLength + 1;
+
+    matches->lengths[matches->count] = baseLength;
+    matches->stages[matches->count] = stage;
+    ++matches->count;
+
+    // Continue with the remaining candidates
+    return 0;
+}
+
+void locatePath(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol)
+{
+    locatePathWithDepth(path, pathLength, relPath, relPathLength, systemDir, systemDirLength, symbol, getSearchDepth());
+}
+
+void locatePathWithDepth(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol, unsigned int depth)
 {
     // Early exit when invalid out-parameters are passed
-    if (!checkStringOutParameter(dir, dirLength))
+    if (!checkStringOutParameter(path, pathLength))
     {
         return;
     }
 
-    #ifdef SYSTEM_WINDOWS
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
 
-        char * homeDrive, * homePath;
-        unsigned int homeDriveLen, homePathLen;
-        getEnv("HOMEDRIVE", 9, &homeDrive, &homeDriveLen);
-        getEnv("HOMEPATH", 8, &homePath, &homePathLen);
+    locatePathTo(&out.sink, relPath, relPathLength, systemDir, systemDirLength, symbol, depth);
+}
 
-        unsigned int homeLen = homeDriveLen + homePathLen;
-        char * home = (char *)malloc(sizeof(char) * homeLen);
-        memcpy(home, homeDrive, homeDriveLen);
-        memcpy(home + homeDriveLen, homePath, homePathLen);
+void locatePathTo(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol, unsigned int depth)
+{
+    locateCandidate(sink, relPath, relPathLength, systemDir, systemDirLength, symbol, clampSearchDepth(depth), probeFileExists, 0x0);
+}
 
-        copyToStringOutParameter(home, homeLen, dir, dirLength);
+void locatePathFromLibraryPathTo(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, const char * libraryPath, unsigned int libraryPathLength, unsigned int depth)
+{
+    locateCandidateFrom(sink, relPath, relPathLength, systemDir, systemDirLength, libraryPath, libraryPathLength, clampSearchDepth(depth), probeFileExists, 0x0);
+}
 
-        free(homePath);
-        free(homeDrive);
+void setNormalizedResults(unsigned char enabled)
+{
+    lockGlobalState();
 
-    #else // every other UNIX, including Linux and macOS
+    normalizeResults = enabled;
 
-        char * home;
-        unsigned int homeLen;
+    unlockGlobalState();
+}
 
-        // First, test
-        getEnv("HOME", 4, &home, &homeLen);
+void normalizePaths(char * paths, unsigned int * pathLengths, unsigned int pathCount)
+{
+    if (paths == 0x0 || pathLengths == 0x0)
+    {
+        return;
+    }
+
+    unsigned int read = 0;
+    unsigned int write = 0;
 
-        if (home != 0x0 && homeLen > 0) {
-            copyToStringOutParameter(home, homeLen, dir, dirLength);
+    // Normalize each path in place and close the gaps in the arena
+    for (unsigned int i = 0; i < pathCount; ++i)
+    {
+        const unsigned int length = pathLengths[i];
 
-            free(home);
+        normalizePath(paths + read, length, pathLengths + i);
 
-            return;
+        memmove(paths + write, paths + read, pathLengths[i]);
+        paths[write + pathLengths[i]] = 0;
+
+        read += length + 1;
+        write += pathLengths[i] + 1;
+    }
+}
+
+void unifyPaths(char * paths, const unsigned int * pathLengths, unsigned int pathCount)
+{
+    if (paths == 0x0 || pathLengths == 0x0)
+    {
+        return;
+    }
+
+    // The null bytes between paths are not affected, so the arena is processed in one pass
+    unsigned int arenaLength = 0;
+    for (unsigned int i = 0; i < pathCount; ++i)
+    {
+        arenaLength += pathLengths[i] + 1;
+    }
+
+    unifyPathDelimiters(paths, arenaLength);
+}
+
+void getDirectoryParts(const char * paths, const unsigned int * pathLengths, unsigned int pathCount, unsigned int * directoryLengths)
+{
+    if (paths == 0x0 || pathLengths == 0x0 || directoryLengths == 0x0)
+    {
+        return;
+    }
+
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < pathCount; ++i)
+    {
+        getDirectoryPart(paths + offset, pathLengths[i], directoryLengths + i);
+        offset += pathLengths[i] + 1;
+    }
+}
+
+void matchPathPrefix(const char * paths, const unsigned int * pathLengths, unsigned int pathCount,
+    const char * prefix, unsigned int prefixLength, unsigned char * matches)
+{
+    if (paths == 0x0 || pathLengths == 0x0 || matches == 0x0)
+    {
+        return;
+    }
+
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < pathCount; ++i)
+    {
+        matches[i] = pathLengths[i] >= prefixLength
+            && (prefixLength == 0 || commonPrefixLength(paths + offset, prefix, prefixLength) == prefixLength);
+        offset += pathLengths[i] + 1;
+    }
+}
+
+void setSearchDepth(unsigned int depth)
+{
+    lockGlobalState();
+
+    defaultSearchDepth = clampSearchDepth(depth);
+
+    unlockGlobalState();
+}
+
+unsigned int getSearchDepth()
+{
+    lockGlobalState();
+
+    const unsigned int depth = defaultSearchDepth;
+
+    unlockGlobalState();
+
+    return depth;
+}
+
+void setSearchCacheTimeToLive(unsigned int milliseconds)
+{
+    lockGlobalState();
+
+    searchCacheTimeToLive = milliseconds;
+
+    unlockGlobalState();
+}
+
+void clearSearchCache()
+{
+    lockGlobalState();
+
+    for (unsigned int i = 0; i < ancestorMemo.capacity; ++i)
+    {
+        free(ancestorMemo.keys[i]);
+    }
+
+    free(ancestorMemo.keys);
+    free(ancestorMemo.keyLengths);
+    free(ancestorMemo.values);
+    free(ancestorMemo.expiries);
+
+    ancestorMemo.keys = 0x0;
+    ancestorMemo.keyLengths = 0x0;
+    ancestorMemo.values = 0x0;
+    ancestorMemo.expiries = 0x0;
+    ancestorMemo.capacity = 0;
+    ancestorMemo.count = 0;
+
+    unlockGlobalState();
+}
+
+void locateCanonicalPath(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(path, pathLength))
+    {
+        return;
+    }
+
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
+
+    locateCanonicalPathTo(&out.sink, relPath, relPathLength, systemDir, systemDirLength, symbol);
+}
+
+void locateCanonicalPathTo(const StringSink * sink, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol)
+{
+    char * basePath = 0x0;
+    unsigned int basePathLength = 0;
+    locatePath(&basePath, &basePathLength, relPath, relPathLength, systemDir, systemDirLength, symbol);
+
+    char * canonical = 0x0;
+    unsigned int canonicalLength = 0;
+    canonicalPath(basePath, basePathLength, &canonical, &canonicalLength);
+
+    freeMemory(basePath);
+
+    if (canonicalLength == 0)
+    {
+        invalidateStringSink(sink);
+        freeMemory(canonical);
+        return;
+    }
+
+    // Keep the trailing delimiter of located base paths
+    const unsigned int delimiterLength = canonical[canonicalLength - 1] != '/' ? 1 : 0;
+    char * buffer = sink->reserve(sink->context, canonicalLength + delimiterLength);
+
+    if (buffer != 0x0)
+    {
+        memcpy(buffer, canonical, canonicalLength);
+
+        if (delimiterLength > 0)
+        {
+            buffer[canonicalLength] = '/';
+        }
+    }
+
+    freeMemory(canonical);
+}
+
+void locateAllPaths(char ** paths, unsigned int ** pathLengths, unsigned char ** stages, unsigned int * pathCount,
+    const char * relPath, unsigned int relPathLength, const char * systemDir, unsigned int systemDirLength, void * symbol)
+{
+    // Early exit when invalid out-parameters are passed
+    if (paths == 0x0 || pathLengths == 0x0 || stages == 0x0 || pathCount == 0x0)
+    {
+        if (paths != 0x0)
+        {
+            *paths = 0x0;
+        }
+
+        if (pathLengths != 0x0)
+        {
+            *pathLengths = 0x0;
+        }
+
+        if (stages != 0x0)
+        {
+            *stages = 0x0;
+        }
+
+        if (pathCount != 0x0)
+        {
+            *pathCount = 0;
+        }
+
+        return;
+    }
+
+    LocateMatches matches = { 0x0, 0, 0, 0x0, 0x0, 0, getNormalizeResults() };
+
+    locateCandidate(0x0, relPath, relPathLength, systemDir, systemDirLength, symbol, getSearchDepth(), probeCollectMatches, &matches);
+
+    // Buffers grow with realloc, hand them over in memory of the installed allocator
+    *paths = (char *)transferMemory(matches.arena, sizeof(char) * matches.arenaLength);
+    *pathLengths = (unsigned int *)transferMemory(matches.lengths, sizeof(unsigned int) * matches.count);
+    *stages = (unsigned char *)transferMemory(matches.stages, sizeof(unsigned char) * matches.count);
+    *pathCount = matches.count;
+
+    // Report no paths at all if the allocator could not provide one of the buffers
+    if (matches.count > 0 && (*paths == 0x0 || *pathLengths == 0x0 || *stages == 0x0))
+    {
+        freeMemory(*paths);
+        freeMemory(*pathLengths);
+        freeMemory(*stages);
+
+        *paths = 0x0;
+        *pathLengths = 0x0;
+        *stages = 0x0;
+        *pathCount = 0;
+    }
+}
+
+int openLocatedFile(char ** path, unsigned int * pathLength, const char * relPath, unsigned int relPathLength,
+    const char * systemDir, unsigned int systemDirLength, void * symbol)
+{
+    int fd = -1;
+
+    // The base path is only written if requested
+    StringOutParameter out;
+    initStringOutParameter(&out, path, pathLength);
+
+    // Open each candidate directly, so a match costs a single path traversal
+    locateCandidate(path != 0x0 ? &out.sink : 0x0, relPath, relPathLength, systemDir, systemDirLength, symbol, getSearchDepth(), probeOpenFile, &fd);
+
+    return fd;
+}
+
+void addSystemPrefix(const char * prefix, unsigned int prefixLength)
+{
+    addSystemBasePrefix(prefix, prefixLength);
+}
+
+void resetSystemPrefixes()
+{
+    resetSystemBasePrefixes();
+}
+
+void pathSeparator(char * sep)
+{
+    if (sep != 0x0)
+    {
+#ifdef SYSTEM_WINDOWS
+        *sep = '\\';
+#else
+        *sep = '/';
+#endif
+    }
+}
+
+void libPrefix(char ** prefix, unsigned int * prefixLength)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(prefix, prefixLength))
+    {
+        return;
+    }
+
+#if defined SYSTEM_WINDOWS || defined SYSTEM_DARWIN
+    copyToStringOutParameter("", 0, prefix, prefixLength);
+#else
+    copyToStringOutParameter("lib", 3, prefix, prefixLength);
+#endif
+}
+
+void libExtension(char ** extension, unsigned int * extensionLength)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(extension, extensionLength))
+    {
+        return;
+    }
+
+#if defined SYSTEM_WINDOWS
+    copyToStringOutParameter("dll", 3, extension, extensionLength);
+#elif defined SYSTEM_DARWIN
+    copyToStringOutParameter("dylib", 5, extension, extensionLength);
+#else
+    copyToStringOutParameter("so", 2, extension, extensionLength);
+#endif
+}
+
+void libExtensions(char *** extensions, unsigned int ** extensionLengths, unsigned int * extensionCount)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringVectorOutParameter(extensions, extensionLengths, extensionCount))
+    {
+        return;
+    }
+
+#if defined SYSTEM_WINDOWS
+    static const char * const names[] = { "dll" };
+#elif defined SYSTEM_DARWIN
+    static const char * const names[] = { "dylib", "so" };
+#else
+    static const char * const names[] = { "so" };
+#endif
+
+    const unsigned int count = sizeof(names) / sizeof(names[0]);
+
+    *extensions = (char **)allocateMemory(sizeof(char *) * count);
+    *extensionLengths = (unsigned int *)allocateMemory(sizeof(unsigned int) * count);
+    *extensionCount = 0;
+
+    if (*extensions == 0x0 || *extensionLengths == 0x0)
+    {
+        goto fail;
+    }
+
+    for (; *extensionCount < count; ++*extensionCount)
+    {
+        const unsigned int i = *extensionCount;
+
+        copyToStringOutParameter(names[i], (unsigned int)strlen(names[i]), *extensions + i, *extensionLengths + i);
+
+        if ((*extensions)[i] == 0x0)
+        {
+            goto fail;
+        }
+    }
+
+    return;
+
+fail:
+    // Release what was allocated before the allocator failed
+    for (unsigned int i = 0; *extensions != 0x0 && i < *extensionCount; ++i)
+    {
+        freeMemory((*extensions)[i]);
+    }
+
+    freeMemory(*extensions);
+    freeMemory(*extensionLengths);
+
+    *extensions = 0x0;
+    *extensionLengths = 0x0;
+    *extensionCount = 0;
+}
+
+#ifndef SYSTEM_WINDOWS
+
+// Home directory of the user database entry, resolved once per process
+static char * passwdHomeDir = 0x0;
+static unsigned int passwdHomeDirLength = 0;
+static unsigned char passwdHomeDirResolved = 0;
+
+/**
+*  @brief
+*    Look up the home directory of the current user in the user database
+*
+*  @remark
+*    Uses the reentrant getpwuid_r, so concurrent callers of getpwuid
+*    are not affected. Must be called with the global state locked.
+*/
+static void resolvePasswdHomeDir()
+{
+    long bufferSize = sysconf(_SC_GETPW_R_SIZE_MAX);
+
+    if (bufferSize <= 0)
+    {
+        bufferSize = 1024;
+    }
+
+    for (;;)
+    {
+        char * buffer = (char *)malloc(sizeof(char) * (size_t)bufferSize);
+        struct passwd entry;
+        struct passwd * result = 0x0;
+
+        const int error = getpwuid_r(getuid(), &entry, buffer, (size_t)bufferSize, &result);
+
+        if (error == ERANGE && bufferSize < 1024 * 1024)
+        {
+            free(buffer);
+            bufferSize *= 2;
+            continue;
         }
 
-        free(home);
+        if (error == 0 && result != 0x0 && result->pw_dir != 0x0)
+        {
+            copyToString(result->pw_dir, (unsigned int)strlen(result->pw_dir), &passwdHomeDir, &passwdHomeDirLength);
+        }
+
+        free(buffer);
 
-        // Fallback using UNIX passwd structure for the current user
-        struct passwd* pwd = getpwuid(getuid());
+        break;
+    }
 
-        if (pwd != 0x0)
+    passwdHomeDirResolved = 1;
+}
+
+#endif
+
+void homeDirTo(const StringSink * sink)
+{
+    #ifdef SYSTEM_WINDOWS
+
+        unsigned int homeDriveLen, homePathLen;
+        const char * homeDrive = getEnvView("HOMEDRIVE", 9, &homeDriveLen);
+        const char * homePath = getEnvView("HOMEPATH", 8, &homePathLen);
+
+        // Concatenate directly into the result
+        char * home = sink->reserve(sink->context, homeDriveLen + homePathLen);
+
+        if (home != 0x0)
+        {
+            memcpy(home, homeDrive, homeDriveLen);
+            memcpy(home + homeDriveLen, homePath, homePathLen);
+        }
+
+    #else // every other UNIX, including Linux and macOS
+
+        // First, test HOME
+        unsigned int homeLen = 0;
+        const char * home = getEnvView("HOME", 4, &homeLen);
+
+        if (home != 0x0)
         {
-            copyToStringOutParameter(pwd->pw_dir, strlen(pwd->pw_dir), dir, dirLength);
+            writeStringSink(sink, home, homeLen);
 
             return;
         }
 
-        // No home directory was found
-        invalidateStringOutParameter(dir, dirLength);
+        // Fallback using UNIX passwd structure for the current user, looked up only once
+        lockGlobalState();
+
+        if (!passwdHomeDirResolved)
+        {
+            resolvePasswdHomeDir();
+        }
+
+        if (passwdHomeDir != 0x0)
+        {
+            writeStringSink(sink, passwdHomeDir, passwdHomeDirLength);
+        }
+        else
+        {
+            // No home directory was found
+            invalidateStringSink(sink);
+        }
+
+        unlockGlobalState();
 
     #endif
+}
+
+void homeDir(char ** dir, unsigned int * dirLength)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(dir, dirLength))
+    {
+        return;
+    }
+
+    StringOutParameter out;
+    initStringOutParameter(&out, dir, dirLength);
+
+    homeDirTo(&out.sink);
+}
+
+void refreshEnvironment()
+{
+    refreshEnvironmentSnapshot();
+}
+
+const char * environmentValue(const char * name, unsigned int nameLength, unsigned int * valueLength)
+{
+    return getEnvView(name, nameLength, valueLength);
+}
+
+void clearHomeDirCache()
+{
+#ifndef SYSTEM_WINDOWS
+    lockGlobalState();
+
+    free(passwdHomeDir);
 
+    passwdHomeDir = 0x0;
+    passwdHomeDirLength = 0;
+    passwdHomeDirResolved = 0;
+
+    unlockGlobalState();
+#endif
 }
 
 void profileDir(char ** dir, unsigned int * dirLength)
@@ -581,70 +1541,263 @@ void documentDir(char ** dir, unsigned int * dirLength)
     homeDir(dir, dirLength);
 }
 
-void configDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
+/**
+*  @brief
+*    Get a directory relative to the home directory
+*
+*  @remark
+*    If variable names an environment variable set to an absolute path
+*    (e.g., XDG_CACHE_HOME), its value is used instead. Relative values
+*    are invalid according to the XDG specification and ignored.
+*/
+static void homeBasedDir(char ** dir, unsigned int * dirLength, const char * variable, unsigned int variableLength,
+    const char * homeSubdir, unsigned int homeSubdirLength)
 {
-    // Early exit when invalid out-parameters are passed
-    if (!checkStringOutParameter(dir, dirLength))
+    unsigned int valueLength = 0;
+    const char * value = variable != 0x0 ? getEnvView(variable, variableLength, &valueLength) : 0x0;
+
+    if (value != 0x0 && value[0] == '/')
     {
+        copyToStringOutParameter(value, valueLength, dir, dirLength);
         return;
     }
 
-    char * configPath;
-    unsigned int configPathLen;
+    char * home;
+    unsigned int homeLen;
+    homeDir(&home, &homeLen);
+
+    if (home == 0x0)
+    {
+        invalidateStringOutParameter(dir, dirLength);
+        return;
+    }
+
+    char * path = (char *)allocateMemory(sizeof(char) * (homeLen + homeSubdirLength));
+
+    if (path == 0x0)
+    {
+        freeMemory(home);
+        invalidateStringOutParameter(dir, dirLength);
+        return;
+    }
+
+    memcpy(path, home, homeLen);
+    memcpy(path + homeLen, homeSubdir, homeSubdirLength);
+
+    copyToStringOutParameter(path, homeLen + homeSubdirLength, dir, dirLength);
+
+    freeMemory(path);
+    freeMemory(home);
+}
 
+/**
+*  @brief
+*    Get per-user base directory
+*/
+static void baseDir(char ** dir, unsigned int * dirLength, ApplicationDirectory kind)
+{
     #if defined SYSTEM_WINDOWS
-        char * appData;
-        unsigned int appDataLen;
-        getEnv("APPDATA", 7, &appData, &appDataLen);
+        unsigned int valueLength = 0;
+        const char * value = kind == ConfigDirectory || kind == DataDirectory
+            ? getEnvView("APPDATA", 7, &valueLength)
+            : getEnvView("LOCALAPPDATA", 12, &valueLength);
 
-        configPathLen = appDataLen + 1 + applicationLength;
-        configPath = (char *)malloc(sizeof(char) * configPathLen);
-        memcpy(configPath, appData, appDataLen);
-        configPath[appDataLen] = '\\';
+        if (value == 0x0)
+        {
+            invalidateStringOutParameter(dir, dirLength);
+            return;
+        }
 
-        free(appData);
+        copyToStringOutParameter(value, valueLength, dir, dirLength);
     #elif defined SYSTEM_DARWIN
-        char * home;
-        unsigned int homeLen;
-        getEnv("HOME", 4, &home, &homeLen);
+        switch (kind)
+        {
+        case ConfigDirectory:
+            homeBasedDir(dir, dirLength, 0x0, 0, "/Library/Preferences", 20);
+            break;
+        case CacheDirectory:
+            homeBasedDir(dir, dirLength, 0x0, 0, "/Library/Caches", 15);
+            break;
+        default:
+            homeBasedDir(dir, dirLength, 0x0, 0, "/Library/Application Support", 28);
+            break;
+        }
+    #else
+        switch (kind)
+        {
+        case ConfigDirectory:
+            homeBasedDir(dir, dirLength, "XDG_CONFIG_HOME", 15, "/.config", 8);
+            break;
+        case CacheDirectory:
+            homeBasedDir(dir, dirLength, "XDG_CACHE_HOME", 14, "/.cache", 7);
+            break;
+        case StateDirectory:
+            homeBasedDir(dir, dirLength, "XDG_STATE_HOME", 14, "/.local/state", 13);
+            break;
+        default:
+            homeBasedDir(dir, dirLength, "XDG_DATA_HOME", 13, "/.local/share", 13);
+            break;
+        }
+    #endif
+}
 
-        configPathLen = homeLen + 21 + applicationLength;
-        configPath = (char *)malloc(sizeof(char) * configPathLen);
-        memcpy(configPath, home, homeLen);
-        memcpy(configPath + homeLen, "/Library/Preferences/", 21);
+/**
+*  @brief
+*    Get temporary base directory
+*/
+static void tempBaseDir(char ** dir, unsigned int * dirLength)
+{
+    #ifdef SYSTEM_WINDOWS
+        char tempPath[MAX_PATH + 1];
+        const DWORD tempPathLength = GetTempPathA(MAX_PATH + 1, tempPath);
 
-        free(home);
+        if (tempPathLength > 0 && tempPathLength <= MAX_PATH)
+        {
+            copyToStringOutParameter(tempPath, tempPathLength, dir, dirLength);
+        }
+        else
+        {
+            invalidateStringOutParameter(dir, dirLength);
+        }
     #else
-        char * home;
-        unsigned int homeLen;
-        getEnv("HOME", 4, &home, &homeLen);
+        unsigned int tmpDirLength = 0;
+        const char * tmpDir = getEnvView("TMPDIR", 6, &tmpDirLength);
+
+        if (tmpDir != 0x0)
+        {
+            copyToStringOutParameter(tmpDir, tmpDirLength, dir, dirLength);
+        }
+        else
+        {
+            copyToStringOutParameter("/tmp", 4, dir, dirLength);
+        }
+    #endif
+}
+
+/**
+*  @brief
+*    Append the application name to a base directory
+*
+*  @remark
+*    Takes memory ownership over base.
+*/
+static void applicationDir(const StringSink * sink, char * base, unsigned int baseLength,
+    const char * application, unsigned int applicationLength)
+{
+    if (base == 0x0 || baseLength == 0)
+    {
+        freeMemory(base);
+        invalidateStringSink(sink);
+        return;
+    }
+
+    // Strip trailing delimiters (e.g., of TMPDIR), but keep a root
+    while (baseLength > 1 && (base[baseLength - 1] == '/' || base[baseLength - 1] == '\\'))
+    {
+        --baseLength;
+    }
 
-        configPathLen = homeLen + 9 + applicationLength;
-        configPath = (char *)malloc(sizeof(char) * configPathLen);
-        memcpy(configPath, home, homeLen);
-        memcpy(configPath + homeLen, "/.config/", 9);
+    // Compose directly into the result
+    char * path = sink->reserve(sink->context, baseLength + 1 + applicationLength);
 
-        free(home);
+    if (path != 0x0)
+    {
+        memcpy(path, base, baseLength);
+        #ifdef SYSTEM_WINDOWS
+            path[baseLength] = '\\';
+        #else
+            path[baseLength] = '/';
+        #endif
+        memcpy(path + baseLength + 1, application, applicationLength);
+    }
+
+    freeMemory(base);
+}
+
+void applicationDirectoryTo(const StringSink * sink, ApplicationDirectory kind, const char * application, unsigned int applicationLength)
+{
+    char * base = 0x0;
+    unsigned int baseLength = 0;
+
+    #if !defined(SYSTEM_WINDOWS) && !defined(SYSTEM_DARWIN)
+        if (kind == RuntimeDirectory)
+        {
+            unsigned int runtimeLength = 0;
+            const char * runtime = getEnvView("XDG_RUNTIME_DIR", 15, &runtimeLength);
+
+            if (runtime != 0x0 && runtime[0] == '/')
+            {
+                copyToStringOutParameter(runtime, runtimeLength, &base, &baseLength);
+
+                applicationDir(sink, base, baseLength, application, applicationLength);
+                return;
+            }
+        }
     #endif
 
-    unsigned int configPrefixLen = configPathLen - applicationLength;
-    memcpy(configPath + configPrefixLen, application, applicationLength);
-    copyToStringOutParameter(configPath, configPathLen, dir, dirLength);
+    if (kind == TemporaryDirectory || kind == RuntimeDirectory)
+    {
+        // No dedicated runtime directory, fall back to the temporary directory
+        tempBaseDir(&base, &baseLength);
+    }
+    else
+    {
+        baseDir(&base, &baseLength, kind);
+    }
+
+    applicationDir(sink, base, baseLength, application, applicationLength);
+}
 
-    free(configPath);
+static void baseApplicationDir(char ** dir, unsigned int * dirLength, ApplicationDirectory kind, const char * application, unsigned int applicationLength)
+{
+    // Early exit when invalid out-parameters are passed
+    if (!checkStringOutParameter(dir, dirLength))
+    {
+        return;
+    }
+
+    StringOutParameter out;
+    initStringOutParameter(&out, dir, dirLength);
+
+    applicationDirectoryTo(&out.sink, kind, application, applicationLength);
+}
+
+void configDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
+{
+    baseApplicationDir(dir, dirLength, ConfigDirectory, application, applicationLength);
 }
 
 void roamingDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
 {
-    configDir(dir, dirLength, application, applicationLength);
+    baseApplicationDir(dir, dirLength, ConfigDirectory, application, applicationLength);
 }
 
 void localDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
 {
-    configDir(dir, dirLength, application, applicationLength);
+    baseApplicationDir(dir, dirLength, LocalDirectory, application, applicationLength);
+}
+
+void dataDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
+{
+    baseApplicationDir(dir, dirLength, DataDirectory, application, applicationLength);
+}
+
+void cacheDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
+{
+    baseApplicationDir(dir, dirLength, CacheDirectory, application, applicationLength);
+}
+
+void stateDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
+{
+    baseApplicationDir(dir, dirLength, StateDirectory, application, applicationLength);
 }
 
 void tempDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
 {
-    configDir(dir, dirLength, application, applicationLength);
+    baseApplicationDir(dir, dirLength, TemporaryDirectory, application, applicationLength);
+}
+
+void runtimeDir(char ** dir, unsigned int * dirLength, const char * application, unsigned int applicationLength)
+{
+    baseApplicationDir(dir, dirLength, RuntimeDirectory, application, applicationLength);
 }
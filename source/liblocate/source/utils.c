@@ -1,5 +1,8 @@
 
 #include "utils.h"
+#include "core.h"
+
+#include <liblocate/liblocate.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -7,8 +10,13 @@
 #ifdef SYSTEM_WINDOWS
     #define WIN32_LEAN_AND_MEAN
     #include <Windows.h>
+    #include <io.h>
+    #include <fcntl.h>
 #else
     #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <unistd.h>
 #endif
 
 
@@ -29,6 +37,112 @@
 #define macOSBundlePath "/Contents/MacOS"
 #define macOSBundlePathLength 15
 
+#define systemPrefixesVariable "LIBLOCATE_SYSTEM_PREFIXES"
+#define systemPrefixesVariableLength 25
+
+#define maxSymbolicLinks 40
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIMD_SSE2
+    #include <emmintrin.h>
+
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+    // AVX2 code paths are compiled per function and selected at runtime
+    #define SIMD_AVX2
+    #include <immintrin.h>
+#endif
+
+
+#if defined(_MSC_VER)
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
+
+#ifdef SYSTEM_WINDOWS
+    static SRWLOCK globalStateLock = SRWLOCK_INIT;
+    static SRWLOCK environmentLock = SRWLOCK_INIT;
+    static SRWLOCK allocatorLock = SRWLOCK_INIT;
+#else
+    static pthread_mutex_t globalStateLock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_mutex_t environmentLock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_mutex_t allocatorLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+/**
+*  @brief
+*    Allocation and release functions of an allocator
+*/
+typedef struct
+{
+    LocateAllocate allocate; // allocation function, 0x0 for malloc
+    LocateRelease release;   // release function
+    void * userData;         // user data passed to both functions
+} Allocator;
+
+/**
+*  @brief
+*    Memory handed out by custom allocators, keyed by address
+*
+*  @remark
+*    Open addressing hash table with linear probing. Allows
+*    releaseMemory to find the allocator of each block, so blocks
+*    outlive allocator changes and callers need not track them.
+*/
+typedef struct
+{
+    void ** blocks;           // allocated blocks, 0x0 for empty slots
+    Allocator * allocators;   // allocator of each block
+    unsigned int capacity;    // number of slots (power of two)
+    unsigned int count;       // number of used slots
+} AllocationTable;
+
+static Allocator globalAllocator = { 0x0, 0x0, 0x0 };
+static THREAD_LOCAL Allocator threadAllocator = { 0x0, 0x0, 0x0 };
+static AllocationTable allocationTable = { 0x0, 0x0, 0, 0 };
+static int customAllocatorInstalled = 0;
+
+
+/**
+*  @brief
+*    Set of install prefixes recognized by getSystemBasePath
+*
+*  @remark
+*    Each prefix is combined with the binary subdirectories into a
+*    pattern '<prefix>/<subdir>/'. The patterns are compiled into a
+*    deterministic Aho-Corasick automaton over the reversed patterns,
+*    so a path is matched in a single backward pass, independent of
+*    the number of registered prefixes.
+*/
+typedef struct
+{
+    char ** prefixes;             // registered prefixes in priority order (without trailing delimiter)
+    unsigned int * prefixLengths; // length of each prefix
+    unsigned int prefixCount;     // number of prefixes
+
+    unsigned char compiled;       // automaton is up to date with the registered prefixes
+    unsigned char classes[256];   // character class of each byte, 0 for bytes not used by any pattern
+    unsigned int classCount;      // number of character classes
+    unsigned int stateCount;      // number of automaton states
+    unsigned int * transitions;   // stateCount x classCount transition table
+    int * matches;                // highest priority pattern recognized in each state, -1 if none
+    unsigned int * baseLengths;   // length of the base path part of each pattern
+} SystemPrefixMatcher;
+
+static const char * systemPrefixDefaults[] = { "/usr", "/usr/local" };
+static const unsigned int systemPrefixDefaultLengths[] = { 4, 10 };
+static const char * systemPrefixSubdirs[] = { "bin", "lib", "lib32", "lib64" };
+static const unsigned int systemPrefixSubdirLengths[] = { 3, 3, 5, 5 };
+
+static SystemPrefixMatcher systemPrefixMatcher = { 0x0, 0x0, 0, 0, { 0 }, 0, 0, 0x0, 0x0, 0x0 };
+
 
 unsigned char checkStringParameter(const char * path, unsigned int * pathLength)
 {
@@ -73,189 +187,1913 @@ unsigned char checkStringVectorOutParameter(char *** paths, unsigned int ** leng
     return paths != 0x0;
 }
 
-void invalidateStringOutParameter(char ** path, unsigned int * pathLength)
+void lockGlobalState()
 {
-    *path = 0x0;
-    if (pathLength != 0x0)
-    {
-        *pathLength = 0;
-    }
+#ifdef SYSTEM_WINDOWS
+    AcquireSRWLockExclusive(&globalStateLock);
+#else
+    pthread_mutex_lock(&globalStateLock);
+#endif
 }
 
-void copyToStringOutParameter(const char * source, unsigned int length, char ** target, unsigned int * targetLength)
+void unlockGlobalState()
 {
-    *target = (char *)malloc(sizeof(char) * (length + 1));
-    memcpy(*target, source, length);
-    (*target)[length] = 0;
-    if (targetLength != 0x0)
+#ifdef SYSTEM_WINDOWS
+    ReleaseSRWLockExclusive(&globalStateLock);
+#else
+    pthread_mutex_unlock(&globalStateLock);
+#endif
+}
+
+static void lockAllocator()
+{
+#ifdef SYSTEM_WINDOWS
+    AcquireSRWLockExclusive(&allocatorLock);
+#else
+    pthread_mutex_lock(&allocatorLock);
+#endif
+}
+
+static void unlockAllocator()
+{
+#ifdef SYSTEM_WINDOWS
+    ReleaseSRWLockExclusive(&allocatorLock);
+#else
+    pthread_mutex_unlock(&allocatorLock);
+#endif
+}
+
+static int loadCustomAllocatorInstalled()
+{
+#if defined(_MSC_VER)
+    const int installed = *(volatile int *)&customAllocatorInstalled;
+    MemoryBarrier();
+    return installed;
+#else
+    return __atomic_load_n(&customAllocatorInstalled, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void markCustomAllocatorInstalled()
+{
+#if defined(_MSC_VER)
+    MemoryBarrier();
+    *(volatile int *)&customAllocatorInstalled = 1;
+#else
+    __atomic_store_n(&customAllocatorInstalled, 1, __ATOMIC_RELEASE);
+#endif
+}
+
+static unsigned int findAllocationSlot(const AllocationTable * table, const void * block)
+{
+    // Fibonacci hashing of the address; the low bits are zero due to alignment
+    const unsigned long long hash = (unsigned long long)(size_t)block * 11400714819323198485ull;
+    unsigned int slot = (unsigned int)(hash >> 32) & (table->capacity - 1);
+
+    while (table->blocks[slot] != 0x0 && table->blocks[slot] != block)
     {
-        *targetLength = length;
+        slot = (slot + 1) & (table->capacity - 1);
     }
+
+    return slot;
 }
 
-void unifyPathDelimiters(char * path, unsigned int pathLength)
+static void growAllocationTable(AllocationTable * table)
 {
-    if (path == 0x0 || pathLength == 0)
+    AllocationTable grown;
+    grown.capacity = table->capacity > 0 ? table->capacity * 2 : 64;
+    grown.count = table->count;
+    grown.blocks = (void **)calloc(grown.capacity, sizeof(void *));
+    grown.allocators = (Allocator *)malloc(sizeof(Allocator) * grown.capacity);
+
+    for (unsigned int i = 0; i < table->capacity; ++i)
     {
-        return;
+        if (table->blocks[i] == 0x0)
+        {
+            continue;
+        }
+
+        const unsigned int slot = findAllocationSlot(&grown, table->blocks[i]);
+        grown.blocks[slot] = table->blocks[i];
+        grown.allocators[slot] = table->allocators[i];
     }
 
-    const char * end = path + pathLength;
+    free(table->blocks);
+    free(table->allocators);
 
-    for (char * iter = path; iter < end; ++iter)
+    *table = grown;
+}
+
+static void removeAllocationSlot(AllocationTable * table, unsigned int slot)
+{
+    // Backward shift deletion keeps probe sequences intact without tombstones
+    unsigned int hole = slot;
+    unsigned int next = (slot + 1) & (table->capacity - 1);
+
+    while (table->blocks[next] != 0x0)
     {
-        if (*iter == windowsPathDelim)
+        const unsigned long long hash = (unsigned long long)(size_t)table->blocks[next] * 11400714819323198485ull;
+        const unsigned int home = (unsigned int)(hash >> 32) & (table->capacity - 1);
+
+        // Move the entry into the hole if the hole lies on its probe sequence
+        if (((next - home) & (table->capacity - 1)) >= ((next - hole) & (table->capacity - 1)))
         {
-            *iter = unixPathDelim;
+            table->blocks[hole] = table->blocks[next];
+            table->allocators[hole] = table->allocators[next];
+            hole = next;
         }
+
+        next = (next + 1) & (table->capacity - 1);
     }
+
+    table->blocks[hole] = 0x0;
+    --table->count;
 }
 
-void getDirectoryPart(const char * fullpath, unsigned int length, unsigned int * newLength)
+void installAllocator(LocateAllocate allocate, LocateRelease release, void * userData, unsigned char threadLocal)
 {
-    if (newLength == 0x0)
+    Allocator allocator = { 0x0, 0x0, 0x0 };
+
+    if (allocate != 0x0 && release != 0x0)
     {
-        return;
+        allocator.allocate = allocate;
+        allocator.release = release;
+        allocator.userData = userData;
+
+        markCustomAllocatorInstalled();
     }
 
-    if (fullpath == 0x0 || length == 0)
+    if (threadLocal)
     {
-        *newLength = 0;
+        threadAllocator = allocator;
         return;
     }
 
-    const char * iter = fullpath + length - 1;
-    while (iter > fullpath && *iter != unixPathDelim && *iter != windowsPathDelim)
-    {
-        --iter;
-    }
+    lockAllocator();
+
+    globalAllocator = allocator;
 
-    *newLength = iter > fullpath ? (unsigned int)(iter - fullpath) : length;
+    unlockAllocator();
 }
 
-void getBundlePart(const char * fullpath, unsigned int length, unsigned int * newLength)
+/**
+*  @brief
+*    Get the allocator in effect for the calling thread
+*/
+static Allocator currentAllocator()
 {
-    if (newLength == 0x0)
+    if (threadAllocator.allocate != 0x0)
     {
-        return;
+        return threadAllocator;
     }
 
-    if (fullpath == 0x0 || length == 0)
+    if (!loadCustomAllocatorInstalled())
     {
-        *newLength = 0;
+        const Allocator system = { 0x0, 0x0, 0x0 };
+        return system;
+    }
 
-        return;
+    lockAllocator();
+
+    const Allocator allocator = globalAllocator;
+
+    unlockAllocator();
+
+    return allocator;
+}
+
+void * allocateMemory(size_t size)
+{
+    const Allocator allocator = currentAllocator();
+
+    if (allocator.allocate == 0x0)
+    {
+        return malloc(size > 0 ? size : 1);
     }
 
-    // check for /Contents/MacOS
-    const char * potentialBundleStart = fullpath + length - macOSBundlePathLength;
+    void * block = allocator.allocate(size > 0 ? size : 1, allocator.userData);
 
-    if (strncmp(potentialBundleStart, macOSBundlePath, macOSBundlePathLength) != 0)
+    if (block == 0x0)
     {
-        // No bundle
-        *newLength = 0;
+        return 0x0;
+    }
 
-        return;
+    lockAllocator();
+
+    if (2 * (allocationTable.count + 1) > allocationTable.capacity)
+    {
+        growAllocationTable(&allocationTable);
     }
 
-    *newLength = length - macOSBundlePathLength;
+    const unsigned int slot = findAllocationSlot(&allocationTable, block);
+    allocationTable.blocks[slot] = block;
+    allocationTable.allocators[slot] = allocator;
+    ++allocationTable.count;
+
+    unlockAllocator();
+
+    return block;
 }
 
-void getSystemBasePath(const char * path, unsigned int pathLength, unsigned int * subLength)
+void freeMemory(void * memory)
 {
-    static const char * systemPaths[] = {
-        "/usr/bin/",
-        "/usr/lib/",
-        "/usr/lib32/",
-        "/usr/lib64/",
-        "/usr/local/bin/",
-        "/usr/local/lib/",
-        "/usr/local/lib32/",
-        "/usr/local/lib64/",
-    };
-    static unsigned char systemPathLengths[] = { 9, 11, 15, 17 };
-    static unsigned char systemPathPrefixLength[] = { 5, 11 };
+    if (memory == 0x0)
+    {
+        return;
+    }
 
-    if (!checkStringParameter(path, subLength))
+    // Without custom allocators, all memory stems from malloc
+    if (!loadCustomAllocatorInstalled())
     {
+        free(memory);
         return;
     }
 
-    for (int i = 0; i < 8; ++i)
+    lockAllocator();
+
+    if (allocationTable.capacity > 0)
     {
-        const char * systemPath = systemPaths[i];
-        unsigned char systemPathLength = systemPathLengths[i >> 1];
+        const unsigned int slot = findAllocationSlot(&allocationTable, memory);
 
-        const char * iter = path + pathLength - 1;
-        const char * resetSearchIter = systemPath + systemPathLength - 1;
-        const char * searchIter = resetSearchIter;
-        while (searchIter >= systemPath && iter >= path)
+        if (allocationTable.blocks[slot] != 0x0)
         {
-            searchIter = *iter == *searchIter ? searchIter - 1 : resetSearchIter;
-            --iter;
-        }
+            const Allocator allocator = allocationTable.allocators[slot];
+
+            removeAllocationSlot(&allocationTable, slot);
+
+            unlockAllocator();
+
+            allocator.release(memory, allocator.userData);
 
-        if (searchIter < systemPath) // sub-systemPath-string found
-        {
-            *subLength = (unsigned int)(iter - path) + systemPathPrefixLength[i >> 2] + 1;
             return;
         }
     }
 
-    *subLength = 0;
+    unlockAllocator();
+
+    free(memory);
 }
 
-void getEnv(const char * name, unsigned int nameLength, char ** value, unsigned int * valueLength)
+void * transferMemory(void * data, size_t size)
 {
-    (void)nameLength;
+    if (data == 0x0 || currentAllocator().allocate == 0x0)
+    {
+        return data;
+    }
 
-    if (name == 0x0 || value == 0x0)
+    void * memory = allocateMemory(size);
+
+    if (memory != 0x0)
     {
-        if (valueLength != 0x0)
-        {
-            *valueLength = 0;
-        }
+        memcpy(memory, data, size);
+    }
 
-        return;
+    free(data);
+
+    return memory;
+}
+
+void invalidateStringOutParameter(char ** path, unsigned int * pathLength)
+{
+    *path = 0x0;
+    if (pathLength != 0x0)
+    {
+        *pathLength = 0;
     }
+}
 
-    const char * systemValue = getenv(name);
+void copyToString(const char * source, unsigned int length, char ** target, unsigned int * targetLength)
+{
+    *target = (char *)malloc(sizeof(char) * (length + 1));
+    memcpy(*target, source, length);
+    (*target)[length] = 0;
+    if (targetLength != 0x0)
+    {
+        *targetLength = length;
+    }
+}
 
-    if (systemValue == 0x0)
+void copyToStringOutParameter(const char * source, unsigned int length, char ** target, unsigned int * targetLength)
+{
+    *target = (char *)allocateMemory(sizeof(char) * (length + 1));
+
+    if (*target == 0x0)
     {
-        invalidateStringOutParameter(value, valueLength);
+        invalidateStringOutParameter(target, targetLength);
         return;
     }
 
-    unsigned int systemValueLength = (unsigned int)strlen(systemValue);
+    memcpy(*target, source, length);
+    (*target)[length] = 0;
+    if (targetLength != 0x0)
+    {
+        *targetLength = length;
+    }
+}
 
-    if (systemValueLength == 0)
+static char * reserveStringOutParameter(void * context, unsigned int length)
+{
+    StringOutParameter * out = (StringOutParameter *)context;
+    char * buffer = (char *)allocateMemory(sizeof(char) * (length + 1));
+
+    if (buffer == 0x0)
     {
-        invalidateStringOutParameter(value, valueLength);
-        return;
+        invalidateStringOutParameter(out->target, out->targetLength);
+        return 0x0;
     }
 
-    copyToStringOutParameter(systemValue, systemValueLength, value, valueLength);
+    buffer[length] = 0;
+
+    *out->target = buffer;
+    if (out->targetLength != 0x0)
+    {
+        *out->targetLength = length;
+    }
+
+    return buffer;
 }
 
-unsigned char fileExists(const char * path, unsigned int pathLength)
+static void invalidateStringOutParameterSink(void * context)
 {
-    (void)pathLength;
+    StringOutParameter * out = (StringOutParameter *)context;
 
-    if (path == 0)
+    invalidateStringOutParameter(out->target, out->targetLength);
+}
+
+void initStringOutParameter(StringOutParameter * out, char ** target, unsigned int * targetLength)
+{
+    out->sink.reserve = reserveStringOutParameter;
+    out->sink.invalidate = invalidateStringOutParameterSink;
+    out->sink.context = out;
+    out->target = target;
+    out->targetLength = targetLength;
+}
+
+void writeStringSink(const StringSink * sink, const char * source, unsigned int length)
+{
+    char * buffer = sink->reserve(sink->context, length);
+
+    if (buffer != 0x0 && length > 0)
     {
-        return 0;
+        memcpy(buffer, source, length);
     }
+}
 
-#ifdef SYSTEM_WINDOWS
+void invalidateStringSink(const StringSink * sink)
+{
+    sink->invalidate(sink->context);
+}
 
-    WIN32_FILE_ATTRIBUTE_DATA fileInfo;
-    return (GetFileAttributesExA(path, GetFileExInfoStandard, &fileInfo) != 0);
+#if defined(SIMD_SSE2)
 
+static unsigned int highestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (unsigned int)index;
 #else
+    return 31u - (unsigned int)__builtin_clz(mask);
+#endif
+}
 
-    struct stat fileInfo;
-    return (stat(path, &fileInfo) == 0);
+static unsigned int lowestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
 
 #endif
+
+static void unifyPathDelimitersScalar(char * path, unsigned int pathLength)
+{
+    const char * end = path + pathLength;
+
+    for (char * iter = path; iter < end; ++iter)
+    {
+        if (*iter == windowsPathDelim)
+        {
+            *iter = unixPathDelim;
+        }
+    }
+}
+
+static unsigned int findLastPathDelimiterScalar(const char * path, unsigned int pathLength)
+{
+    for (unsigned int i = pathLength; i > 0; --i)
+    {
+        if (path[i - 1] == unixPathDelim || path[i - 1] == windowsPathDelim)
+        {
+            return i - 1;
+        }
+    }
+
+    return pathLength;
+}
+
+static unsigned int commonPrefixLengthScalar(const char * first, const char * second, unsigned int length)
+{
+    unsigned int i = 0;
+
+    while (i < length && first[i] == second[i])
+    {
+        ++i;
+    }
+
+    return i;
+}
+
+#if defined(SIMD_SSE2)
+
+static void unifyPathDelimitersSSE2(char * path, unsigned int pathLength)
+{
+    const __m128i windowsDelims = _mm_set1_epi8(windowsPathDelim);
+    const __m128i unixDelims = _mm_set1_epi8(unixPathDelim);
+
+    unsigned int i = 0;
+
+    for (; i + 16 <= pathLength; i += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(path + i));
+        const __m128i mask = _mm_cmpeq_epi8(chunk, windowsDelims);
+
+        if (_mm_movemask_epi8(mask) != 0)
+        {
+            _mm_storeu_si128((__m128i *)(path + i), _mm_or_si128(_mm_andnot_si128(mask, chunk), _mm_and_si128(mask, unixDelims)));
+        }
+    }
+
+    unifyPathDelimitersScalar(path + i, pathLength - i);
+}
+
+static unsigned int findLastPathDelimiterSSE2(const char * path, unsigned int pathLength)
+{
+    const __m128i windowsDelims = _mm_set1_epi8(windowsPathDelim);
+    const __m128i unixDelims = _mm_set1_epi8(unixPathDelim);
+
+    unsigned int end = pathLength;
+
+    for (; end >= 16; end -= 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(path + end - 16));
+        const unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, windowsDelims), _mm_cmpeq_epi8(chunk, unixDelims)));
+
+        if (mask != 0)
+        {
+            return end - 16 + highestBit(mask);
+        }
+    }
+
+    const unsigned int index = findLastPathDelimiterScalar(path, end);
+
+    return index < end ? index : pathLength;
+}
+
+static unsigned int commonPrefixLengthSSE2(const char * first, const char * second, unsigned int length)
+{
+    unsigned int i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *)(first + i)), _mm_loadu_si128((const __m128i *)(second + i))));
+
+        if (mask != 0xFFFF)
+        {
+            return i + lowestBit(~mask);
+        }
+    }
+
+    return i + commonPrefixLengthScalar(first + i, second + i, length - i);
+}
+
+#endif
+
+#if defined(SIMD_AVX2)
+
+__attribute__((target("avx2")))
+static void unifyPathDelimitersAVX2(char * path, unsigned int pathLength)
+{
+    const __m256i windowsDelims = _mm256_set1_epi8(windowsPathDelim);
+    const __m256i unixDelims = _mm256_set1_epi8(unixPathDelim);
+
+    unsigned int i = 0;
+
+    for (; i + 32 <= pathLength; i += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(path + i));
+        const __m256i mask = _mm256_cmpeq_epi8(chunk, windowsDelims);
+
+        if (_mm256_movemask_epi8(mask) != 0)
+        {
+            _mm256_storeu_si256((__m256i *)(path + i), _mm256_blendv_epi8(chunk, unixDelims, mask));
+        }
+    }
+
+    unifyPathDelimitersSSE2(path + i, pathLength - i);
+}
+
+__attribute__((target("avx2")))
+static unsigned int findLastPathDelimiterAVX2(const char * path, unsigned int pathLength)
+{
+    const __m256i windowsDelims = _mm256_set1_epi8(windowsPathDelim);
+    const __m256i unixDelims = _mm256_set1_epi8(unixPathDelim);
+
+    unsigned int end = pathLength;
+
+    for (; end >= 32; end -= 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(path + end - 32));
+        const unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, windowsDelims), _mm256_cmpeq_epi8(chunk, unixDelims)));
+
+        if (mask != 0)
+        {
+            return end - 32 + highestBit(mask);
+        }
+    }
+
+    const unsigned int index = findLastPathDelimiterSSE2(path, end);
+
+    return index < end ? index : pathLength;
+}
+
+__attribute__((target("avx2")))
+static unsigned int commonPrefixLengthAVX2(const char * first, const char * second, unsigned int length)
+{
+    unsigned int i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        const unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *)(first + i)), _mm256_loadu_si256((const __m256i *)(second + i))));
+
+        if (mask != 0xFFFFFFFFu)
+        {
+            return i + lowestBit(~mask);
+        }
+    }
+
+    return i + commonPrefixLengthSSE2(first + i, second + i, length - i);
+}
+
+#endif
+
+unsigned char pathScanLevel()
+{
+#if defined(SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return PATH_SCAN_AVX2;
+    }
+#endif
+
+#if defined(SIMD_SSE2)
+    return PATH_SCAN_SSE2;
+#else
+    return PATH_SCAN_SCALAR;
+#endif
+}
+
+void unifyPathDelimitersAt(unsigned char level, char * path, unsigned int pathLength)
+{
+    if (path == 0x0 || pathLength == 0)
+    {
+        return;
+    }
+
+    const unsigned char supported = pathScanLevel();
+    level = level < supported ? level : supported;
+
+#if defined(SIMD_AVX2)
+    if (level >= PATH_SCAN_AVX2)
+    {
+        unifyPathDelimitersAVX2(path, pathLength);
+        return;
+    }
+#endif
+
+#if defined(SIMD_SSE2)
+    if (level >= PATH_SCAN_SSE2)
+    {
+        unifyPathDelimitersSSE2(path, pathLength);
+        return;
+    }
+#endif
+
+    unifyPathDelimitersScalar(path, pathLength);
+}
+
+unsigned int findLastPathDelimiterAt(unsigned char level, const char * path, unsigned int pathLength)
+{
+    if (path == 0x0 || pathLength == 0)
+    {
+        return pathLength;
+    }
+
+    const unsigned char supported = pathScanLevel();
+    level = level < supported ? level : supported;
+
+#if defined(SIMD_AVX2)
+    if (level >= PATH_SCAN_AVX2)
+    {
+        return findLastPathDelimiterAVX2(path, pathLength);
+    }
+#endif
+
+#if defined(SIMD_SSE2)
+    if (level >= PATH_SCAN_SSE2)
+    {
+        return findLastPathDelimiterSSE2(path, pathLength);
+    }
+#endif
+
+    return findLastPathDelimiterScalar(path, pathLength);
+}
+
+unsigned int findLastPathDelimiter(const char * path, unsigned int pathLength)
+{
+    return findLastPathDelimiterAt(PATH_SCAN_AVX2, path, pathLength);
+}
+
+unsigned int commonPrefixLengthAt(unsigned char level, const char * first, const char * second, unsigned int length)
+{
+    if (first == 0x0 || second == 0x0 || length == 0)
+    {
+        return 0;
+    }
+
+    const unsigned char supported = pathScanLevel();
+    level = level < supported ? level : supported;
+
+#if defined(SIMD_AVX2)
+    if (level >= PATH_SCAN_AVX2)
+    {
+        return commonPrefixLengthAVX2(first, second, length);
+    }
+#endif
+
+#if defined(SIMD_SSE2)
+    if (level >= PATH_SCAN_SSE2)
+    {
+        return commonPrefixLengthSSE2(first, second, length);
+    }
+#endif
+
+    return commonPrefixLengthScalar(first, second, length);
+}
+
+unsigned int commonPrefixLength(const char * first, const char * second, unsigned int length)
+{
+    return commonPrefixLengthAt(PATH_SCAN_AVX2, first, second, length);
+}
+
+void unifyPathDelimiters(char * path, unsigned int pathLength)
+{
+    unifyPathDelimitersAt(PATH_SCAN_AVX2, path, pathLength);
+}
+
+void normalizePath(char * path, unsigned int pathLength, unsigned int * newLength)
+{
+    if (!checkStringParameter(path, newLength))
+    {
+        return;
+    }
+
+    if (pathLength == 0)
+    {
+        *newLength = 0;
+        return;
+    }
+
+    unifyPathDelimiters(path, pathLength);
+
+    // Determine root, which is kept as is
+    unsigned int root = 0;
+
+    if (pathLength >= 2 && path[1] == ':' && ((path[0] >= 'a' && path[0] <= 'z') || (path[0] >= 'A' && path[0] <= 'Z')))
+    {
+        root = 2;
+    }
+
+    if (root < pathLength && path[root] == unixPathDelim)
+    {
+        ++root;
+
+        // Keep a leading '//' (UNC paths), but collapse three or more delimiters
+        if (root == 1 && pathLength >= 2 && path[1] == unixPathDelim && (pathLength == 2 || path[2] != unixPathDelim))
+        {
+            ++root;
+        }
+    }
+
+    const unsigned char trailingDelimiter = pathLength > root && path[pathLength - 1] == unixPathDelim;
+
+    unsigned int read = root;
+    unsigned int write = root;
+    unsigned int floor = root; // end of leading '..' components of relative paths, which cannot be resolved
+
+    while (read < pathLength)
+    {
+        // Skip delimiters
+        while (read < pathLength && path[read] == unixPathDelim)
+        {
+            ++read;
+        }
+
+        if (read >= pathLength)
+        {
+            break;
+        }
+
+        const unsigned int start = read;
+
+        while (read < pathLength && path[read] != unixPathDelim)
+        {
+            ++read;
+        }
+
+        const unsigned int length = read - start;
+        const unsigned char parent = length == 2 && path[start] == '.' && path[start + 1] == '.';
+
+        if (length == 1 && path[start] == '.')
+        {
+            continue;
+        }
+
+        if (parent)
+        {
+            if (write > floor)
+            {
+                // Remove previous component and its leading delimiter
+                while (write > floor && path[write - 1] != unixPathDelim)
+                {
+                    --write;
+                }
+
+                if (write > floor)
+                {
+                    --write;
+                }
+
+                continue;
+            }
+
+            if (root > 0)
+            {
+                // '..' of the root is the root itself
+                continue;
+            }
+        }
+
+        if (write > root)
+        {
+            path[write++] = unixPathDelim;
+        }
+
+        memmove(path + write, path + start, length);
+        write += length;
+
+        if (parent)
+        {
+            floor = write;
+        }
+    }
+
+    if (write == 0)
+    {
+        path[write++] = '.';
+    }
+
+    if (trailingDelimiter && path[write - 1] != unixPathDelim)
+    {
+        path[write++] = unixPathDelim;
+    }
+
+    *newLength = write;
+}
+
+void getDirectoryPart(const char * fullpath, unsigned int length, unsigned int * newLength)
+{
+    if (newLength == 0x0)
+    {
+        return;
+    }
+
+    if (fullpath == 0x0 || length == 0)
+    {
+        *newLength = 0;
+        return;
+    }
+
+    const unsigned int delimiter = findLastPathDelimiter(fullpath, length);
+
+    *newLength = delimiter > 0 && delimiter < length ? delimiter : length;
+}
+
+void getBundlePart(const char * fullpath, unsigned int length, unsigned int * newLength)
+{
+    if (newLength == 0x0)
+    {
+        return;
+    }
+
+    if (fullpath == 0x0 || length == 0)
+    {
+        *newLength = 0;
+
+        return;
+    }
+
+    // check for /Contents/MacOS
+    const char * potentialBundleStart = fullpath + length - macOSBundlePathLength;
+
+    if (strncmp(potentialBundleStart, macOSBundlePath, macOSBundlePathLength) != 0)
+    {
+        // No bundle
+        *newLength = 0;
+
+        return;
+    }
+
+    *newLength = length - macOSBundlePathLength;
+}
+
+static void appendSystemPrefix(SystemPrefixMatcher * matcher, const char * prefix, unsigned int prefixLength)
+{
+    // Ignore trailing delimiters
+    while (prefixLength > 0 && (prefix[prefixLength - 1] == unixPathDelim || prefix[prefixLength - 1] == windowsPathDelim))
+    {
+        --prefixLength;
+    }
+
+    if (prefixLength == 0)
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; i < matcher->prefixCount; ++i)
+    {
+        if (matcher->prefixLengths[i] == prefixLength && memcmp(matcher->prefixes[i], prefix, prefixLength) == 0)
+        {
+            return;
+        }
+    }
+
+    matcher->prefixes = (char **)realloc(matcher->prefixes, sizeof(char *) * (matcher->prefixCount + 1));
+    matcher->prefixLengths = (unsigned int *)realloc(matcher->prefixLengths, sizeof(unsigned int) * (matcher->prefixCount + 1));
+
+    copyToString(prefix, prefixLength, matcher->prefixes + matcher->prefixCount, matcher->prefixLengths + matcher->prefixCount);
+    ++matcher->prefixCount;
+
+    matcher->compiled = 0;
+}
+
+static void clearSystemPrefixes(SystemPrefixMatcher * matcher)
+{
+    for (unsigned int i = 0; i < matcher->prefixCount; ++i)
+    {
+        free(matcher->prefixes[i]);
+    }
+
+    free(matcher->prefixes);
+    free(matcher->prefixLengths);
+
+    matcher->prefixes = 0x0;
+    matcher->prefixLengths = 0x0;
+    matcher->prefixCount = 0;
+    matcher->compiled = 0;
+}
+
+static void initializeSystemPrefixes(SystemPrefixMatcher * matcher)
+{
+    for (unsigned int i = 0; i < sizeof(systemPrefixDefaults) / sizeof(systemPrefixDefaults[0]); ++i)
+    {
+        appendSystemPrefix(matcher, systemPrefixDefaults[i], systemPrefixDefaultLengths[i]);
+    }
+
+    // Additional prefixes from the environment, separated like PATH entries
+    unsigned int prefixesLength = 0;
+    const char * prefixes = getEnvView(systemPrefixesVariable, systemPrefixesVariableLength, &prefixesLength);
+
+    unsigned int start = 0;
+    for (unsigned int i = 0; i <= prefixesLength; ++i)
+    {
+        if (i == prefixesLength || prefixes[i] == pathsDelim)
+        {
+            appendSystemPrefix(matcher, prefixes + start, i - start);
+            start = i + 1;
+        }
+    }
+}
+
+static void compileSystemPrefixes(SystemPrefixMatcher * matcher)
+{
+    const unsigned int subdirCount = sizeof(systemPrefixSubdirs) / sizeof(systemPrefixSubdirs[0]);
+    const unsigned int patternCount = matcher->prefixCount * subdirCount;
+
+    free(matcher->transitions);
+    free(matcher->matches);
+    free(matcher->baseLengths);
+
+    // Assemble patterns '<prefix>/<subdir>/' in priority order
+    char ** patterns = (char **)malloc(sizeof(char *) * patternCount);
+    unsigned int * patternLengths = (unsigned int *)malloc(sizeof(unsigned int) * patternCount);
+    matcher->baseLengths = (unsigned int *)malloc(sizeof(unsigned int) * patternCount);
+
+    unsigned int maxStates = 1;
+
+    for (unsigned int i = 0; i < matcher->prefixCount; ++i)
+    {
+        for (unsigned int j = 0; j < subdirCount; ++j)
+        {
+            const unsigned int index = i * subdirCount + j;
+            const unsigned int length = matcher->prefixLengths[i] + systemPrefixSubdirLengths[j] + 2;
+
+            patterns[index] = (char *)malloc(sizeof(char) * length);
+            memcpy(patterns[index], matcher->prefixes[i], matcher->prefixLengths[i]);
+            patterns[index][matcher->prefixLengths[i]] = unixPathDelim;
+            memcpy(patterns[index] + matcher->prefixLengths[i] + 1, systemPrefixSubdirs[j], systemPrefixSubdirLengths[j]);
+            patterns[index][length - 1] = unixPathDelim;
+
+            patternLengths[index] = length;
+            matcher->baseLengths[index] = matcher->prefixLengths[i] + 1;
+
+            maxStates += length;
+        }
+    }
+
+    // Map the bytes used by the patterns to character classes
+    memset(matcher->classes, 0, sizeof(matcher->classes));
+    matcher->classCount = 1;
+
+    for (unsigned int i = 0; i < patternCount; ++i)
+    {
+        for (unsigned int j = 0; j < patternLengths[i]; ++j)
+        {
+            const unsigned char c = (unsigned char)patterns[i][j];
+
+            if (matcher->classes[c] == 0)
+            {
+                matcher->classes[c] = (unsigned char)matcher->classCount++;
+            }
+        }
+    }
+
+    // Build trie over reversed patterns, 0 denotes a missing transition (the root is never a target)
+    const unsigned int classCount = matcher->classCount;
+    matcher->transitions = (unsigned int *)calloc(maxStates * classCount, sizeof(unsigned int));
+    matcher->matches = (int *)malloc(sizeof(int) * maxStates);
+    matcher->matches[0] = -1;
+    matcher->stateCount = 1;
+
+    for (unsigned int i = 0; i < patternCount; ++i)
+    {
+        unsigned int state = 0;
+
+        for (unsigned int j = patternLengths[i]; j-- > 0; )
+        {
+            unsigned int * next = matcher->transitions + state * classCount + matcher->classes[(unsigned char)patterns[i][j]];
+
+            if (*next == 0)
+            {
+                *next = matcher->stateCount;
+                matcher->matches[matcher->stateCount] = -1;
+                ++matcher->stateCount;
+            }
+
+            state = *next;
+        }
+
+        if (matcher->matches[state] < 0)
+        {
+            matcher->matches[state] = (int)i;
+        }
+    }
+
+    // Compute failure links in breadth-first order and complete the transition table
+    unsigned int * failures = (unsigned int *)calloc(matcher->stateCount, sizeof(unsigned int));
+    unsigned int * queue = (unsigned int *)malloc(sizeof(unsigned int) * matcher->stateCount);
+    unsigned int queueBegin = 0;
+    unsigned int queueEnd = 0;
+
+    for (unsigned int c = 0; c < classCount; ++c)
+    {
+        const unsigned int next = matcher->transitions[c];
+
+        if (next != 0)
+        {
+            failures[next] = 0;
+            queue[queueEnd++] = next;
+        }
+    }
+
+    while (queueBegin < queueEnd)
+    {
+        const unsigned int state = queue[queueBegin++];
+        const unsigned int failure = failures[state];
+
+        // Inherit recognized patterns of the longest proper suffix, keeping the highest priority
+        const int inherited = matcher->matches[failure];
+        if (inherited >= 0 && (matcher->matches[state] < 0 || inherited < matcher->matches[state]))
+        {
+            matcher->matches[state] = inherited;
+        }
+
+        for (unsigned int c = 0; c < classCount; ++c)
+        {
+            unsigned int * next = matcher->transitions + state * classCount + c;
+            const unsigned int fallback = matcher->transitions[failure * classCount + c];
+
+            if (*next != 0)
+            {
+                failures[*next] = fallback;
+                queue[queueEnd++] = *next;
+            }
+            else
+            {
+                *next = fallback;
+            }
+        }
+    }
+
+    free(queue);
+    free(failures);
+
+    for (unsigned int i = 0; i < patternCount; ++i)
+    {
+        free(patterns[i]);
+    }
+
+    free(patterns);
+    free(patternLengths);
+
+    matcher->compiled = 1;
+}
+
+void addSystemBasePrefix(const char * prefix, unsigned int prefixLength)
+{
+    if (prefix == 0x0)
+    {
+        return;
+    }
+
+    lockGlobalState();
+
+    if (systemPrefixMatcher.prefixCount == 0)
+    {
+        initializeSystemPrefixes(&systemPrefixMatcher);
+    }
+
+    appendSystemPrefix(&systemPrefixMatcher, prefix, prefixLength);
+
+    unlockGlobalState();
+}
+
+void resetSystemBasePrefixes()
+{
+    lockGlobalState();
+
+    clearSystemPrefixes(&systemPrefixMatcher);
+
+    unlockGlobalState();
+}
+
+void getSystemBasePath(const char * path, unsigned int pathLength, unsigned int * subLength)
+{
+    if (!checkStringParameter(path, subLength))
+    {
+        return;
+    }
+
+    lockGlobalState();
+
+    if (systemPrefixMatcher.prefixCount == 0)
+    {
+        initializeSystemPrefixes(&systemPrefixMatcher);
+    }
+
+    if (!systemPrefixMatcher.compiled)
+    {
+        compileSystemPrefixes(&systemPrefixMatcher);
+    }
+
+    const unsigned int classCount = systemPrefixMatcher.classCount;
+    const unsigned int * transitions = systemPrefixMatcher.transitions;
+    const unsigned char * classes = systemPrefixMatcher.classes;
+
+    unsigned int state = 0;
+    int best = -1;
+    unsigned int bestStart = 0;
+
+    // Scan backwards, so the first occurrence of each pattern is its rightmost one
+    for (unsigned int i = pathLength; i-- > 0; )
+    {
+        state = transitions[state * classCount + classes[(unsigned char)path[i]]];
+
+        const int match = systemPrefixMatcher.matches[state];
+
+        if (match >= 0 && (best < 0 || match < best))
+        {
+            best = match;
+            bestStart = i;
+
+            if (best == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    *subLength = best >= 0 ? bestStart + systemPrefixMatcher.baseLengths[best] : 0;
+
+    unlockGlobalState();
+}
+
+/**
+*  @brief
+*    Environment variables consumed by liblocate, captured in the snapshot
+*/
+static const char * const environmentVariables[] = {
+    "HOME", "HOMEDRIVE", "HOMEPATH", "USERPROFILE", "APPDATA", "LOCALAPPDATA",
+    "XDG_CONFIG_HOME", "XDG_CONFIG_DIRS", "XDG_DATA_HOME", "XDG_DATA_DIRS",
+    "XDG_CACHE_HOME", "XDG_STATE_HOME", "XDG_RUNTIME_DIR",
+    "TMPDIR", "TEMP", "TMP", "PATH", "PATHEXT", systemPrefixesVariable
+};
+
+#define environmentVariableCount (sizeof(environmentVariables) / sizeof(environmentVariables[0]))
+#define environmentSlotCount 32
+
+/**
+*  @brief
+*    Immutable copy of the consumed environment variables
+*
+*  @remark
+*    Values are stored null-terminated in a single arena. A snapshot is
+*    never modified or freed after publication, so it can be read
+*    without locking; refreshing publishes a new snapshot and keeps the
+*    previous ones alive for readers that may still use them. Snapshots
+*    are only published if a value changed, so the retained memory is
+*    bounded by the number of actual changes, not of refreshes.
+*/
+typedef struct EnvironmentSnapshot
+{
+    char * arena;
+    unsigned int offsets[environmentVariableCount];
+    unsigned int lengths[environmentVariableCount];  ///< 0 if unset or empty
+    signed char slots[environmentSlotCount];         ///< Variable index per hash slot, -1 if unused
+    struct EnvironmentSnapshot * previous;
+} EnvironmentSnapshot;
+
+static EnvironmentSnapshot * environmentSnapshot = 0x0;
+
+/**
+*  @brief
+*    Hash function that is collision-free over environmentVariables
+*/
+static unsigned int environmentSlot(const char * name, unsigned int nameLength)
+{
+    return (nameLength * 5 + (unsigned char)name[0] + 4 * (unsigned char)name[nameLength - 1]
+        + 4 * (unsigned char)name[nameLength / 2]) % environmentSlotCount;
+}
+
+/**
+*  @brief
+*    Serialize snapshot creation
+*
+*  @remark
+*    Separate from the global state lock, so the snapshot can be
+*    accessed while the global state is locked.
+*/
+static void lockEnvironment()
+{
+#ifdef SYSTEM_WINDOWS
+    AcquireSRWLockExclusive(&environmentLock);
+#else
+    pthread_mutex_lock(&environmentLock);
+#endif
+}
+
+static void unlockEnvironment()
+{
+#ifdef SYSTEM_WINDOWS
+    ReleaseSRWLockExclusive(&environmentLock);
+#else
+    pthread_mutex_unlock(&environmentLock);
+#endif
+}
+
+static EnvironmentSnapshot * loadEnvironmentSnapshot()
+{
+#if defined(_MSC_VER)
+    EnvironmentSnapshot * snapshot = *(EnvironmentSnapshot * volatile *)&environmentSnapshot;
+    MemoryBarrier();
+    return snapshot;
+#else
+    return __atomic_load_n(&environmentSnapshot, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void publishEnvironmentSnapshot(EnvironmentSnapshot * snapshot)
+{
+#if defined(_MSC_VER)
+    MemoryBarrier();
+    *(EnvironmentSnapshot * volatile *)&environmentSnapshot = snapshot;
+#else
+    __atomic_store_n(&environmentSnapshot, snapshot, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+*  @brief
+*    Capture the consumed environment variables into a new snapshot
+*
+*  @remark
+*    Must be called with the environment locked.
+*/
+static EnvironmentSnapshot * createEnvironmentSnapshot()
+{
+    EnvironmentSnapshot * snapshot = (EnvironmentSnapshot *)malloc(sizeof(EnvironmentSnapshot));
+    const char * values[environmentVariableCount];
+    unsigned int arenaLength = 0;
+
+    memset(snapshot->slots, -1, sizeof(snapshot->slots));
+
+    for (unsigned int i = 0; i < environmentVariableCount; ++i)
+    {
+        const unsigned int nameLength = (unsigned int)strlen(environmentVariables[i]);
+        snapshot->slots[environmentSlot(environmentVariables[i], nameLength)] = (signed char)i;
+
+        values[i] = getenv(environmentVariables[i]);
+        snapshot->lengths[i] = values[i] != 0x0 ? (unsigned int)strlen(values[i]) : 0;
+        snapshot->offsets[i] = arenaLength;
+
+        arenaLength += snapshot->lengths[i] + 1;
+    }
+
+    snapshot->arena = (char *)malloc(sizeof(char) * arenaLength);
+
+    for (unsigned int i = 0; i < environmentVariableCount; ++i)
+    {
+        if (values[i] != 0x0)
+        {
+            memcpy(snapshot->arena + snapshot->offsets[i], values[i], snapshot->lengths[i]);
+        }
+
+        snapshot->arena[snapshot->offsets[i] + snapshot->lengths[i]] = '\0';
+    }
+
+    snapshot->previous = environmentSnapshot;
+
+    return snapshot;
+}
+
+static const EnvironmentSnapshot * currentEnvironmentSnapshot()
+{
+    EnvironmentSnapshot * snapshot = loadEnvironmentSnapshot();
+
+    if (snapshot != 0x0)
+    {
+        return snapshot;
+    }
+
+    lockEnvironment();
+
+    // Another thread may have captured the snapshot in the meantime
+    snapshot = environmentSnapshot;
+
+    if (snapshot == 0x0)
+    {
+        snapshot = createEnvironmentSnapshot();
+        publishEnvironmentSnapshot(snapshot);
+    }
+
+    unlockEnvironment();
+
+    return snapshot;
+}
+
+/**
+*  @brief
+*    Check if two snapshots hold the same values
+*/
+static int equalEnvironmentSnapshots(const EnvironmentSnapshot * first, const EnvironmentSnapshot * second)
+{
+    const unsigned int last = environmentVariableCount - 1;
+
+    return memcmp(first->lengths, second->lengths, sizeof(first->lengths)) == 0
+        && memcmp(first->arena, second->arena, first->offsets[last] + first->lengths[last] + 1) == 0;
+}
+
+void refreshEnvironmentSnapshot()
+{
+    lockEnvironment();
+
+    EnvironmentSnapshot * snapshot = createEnvironmentSnapshot();
+
+    // Keep the current snapshot if nothing changed, as it cannot be freed once published
+    if (snapshot->previous != 0x0 && equalEnvironmentSnapshots(snapshot, snapshot->previous))
+    {
+        free(snapshot->arena);
+        free(snapshot);
+    }
+    else
+    {
+        publishEnvironmentSnapshot(snapshot);
+    }
+
+    unlockEnvironment();
+}
+
+static int environmentSnapshotIndex(const char * name, unsigned int nameLength)
+{
+    if (name == 0x0 || nameLength == 0)
+    {
+        return -1;
+    }
+
+    const EnvironmentSnapshot * snapshot = currentEnvironmentSnapshot();
+    const int index = snapshot->slots[environmentSlot(name, nameLength)];
+
+    if (index < 0 || strncmp(environmentVariables[index], name, nameLength) != 0 || environmentVariables[index][nameLength] != '\0')
+    {
+        return -1;
+    }
+
+    return index;
+}
+
+const char * getEnvView(const char * name, unsigned int nameLength, unsigned int * valueLength)
+{
+    if (valueLength != 0x0)
+    {
+        *valueLength = 0;
+    }
+
+    const int index = environmentSnapshotIndex(name, nameLength);
+
+    if (index < 0)
+    {
+        return 0x0;
+    }
+
+    const EnvironmentSnapshot * snapshot = loadEnvironmentSnapshot();
+
+    if (snapshot->lengths[index] == 0)
+    {
+        return 0x0;
+    }
+
+    if (valueLength != 0x0)
+    {
+        *valueLength = snapshot->lengths[index];
+    }
+
+    return snapshot->arena + snapshot->offsets[index];
+}
+
+void getEnv(const char * name, unsigned int nameLength, char ** value, unsigned int * valueLength)
+{
+    if (name == 0x0 || value == 0x0)
+    {
+        if (valueLength != 0x0)
+        {
+            *valueLength = 0;
+        }
+
+        return;
+    }
+
+    // Variables consumed by liblocate are served from the snapshot
+    if (environmentSnapshotIndex(name, nameLength) >= 0)
+    {
+        unsigned int snapshotValueLength = 0;
+        const char * snapshotValue = getEnvView(name, nameLength, &snapshotValueLength);
+
+        if (snapshotValue == 0x0)
+        {
+            invalidateStringOutParameter(value, valueLength);
+            return;
+        }
+
+        copyToStringOutParameter(snapshotValue, snapshotValueLength, value, valueLength);
+        return;
+    }
+
+    const char * systemValue = getenv(name);
+
+    if (systemValue == 0x0)
+    {
+        invalidateStringOutParameter(value, valueLength);
+        return;
+    }
+
+    unsigned int systemValueLength = (unsigned int)strlen(systemValue);
+
+    if (systemValueLength == 0)
+    {
+        invalidateStringOutParameter(value, valueLength);
+        return;
+    }
+
+    copyToStringOutParameter(systemValue, systemValueLength, value, valueLength);
+}
+
+unsigned char fileExists(const char * path, unsigned int pathLength)
+{
+    (void)pathLength;
+
+    if (path == 0)
+    {
+        return 0;
+    }
+
+#ifdef SYSTEM_WINDOWS
+
+    WIN32_FILE_ATTRIBUTE_DATA fileInfo;
+    return (GetFileAttributesExA(path, GetFileExInfoStandard, &fileInfo) != 0);
+
+#else
+
+    struct stat fileInfo;
+    return (stat(path, &fileInfo) == 0);
+
+#endif
+}
+
+int openFile(const char * path, unsigned int pathLength)
+{
+    (void)pathLength;
+
+    if (path == 0)
+    {
+        return -1;
+    }
+
+#ifdef SYSTEM_WINDOWS
+
+    return _open(path, _O_RDONLY | _O_BINARY | _O_NOINHERIT);
+
+#elif defined O_CLOEXEC
+
+    return open(path, O_RDONLY | O_CLOEXEC);
+
+#else
+
+    return open(path, O_RDONLY);
+
+#endif
+}
+
+/**
+*  @brief
+*    Process-wide cache of canonical paths
+*
+*  @remark
+*    Maps '<canonical directory>/<name>' to the canonical path of that
+*    entry, i.e., the resolved target for symbolic links and the key
+*    itself for other entries. Open addressing hash table.
+*/
+typedef struct
+{
+    char ** keys;                // cached paths, 0x0 for empty slots
+    unsigned int * keyLengths;   // length of each cached path
+    char ** values;              // canonical path of each cached path
+    unsigned int * valueLengths; // length of each canonical path
+    unsigned int capacity;       // number of slots (power of two)
+    unsigned int count;          // number of used slots
+} CanonicalPathCache;
+
+static CanonicalPathCache canonicalPathCache = { 0x0, 0x0, 0x0, 0x0, 0, 0 };
+
+/**
+*  @brief
+*    Growable string buffer
+*/
+typedef struct
+{
+    char * data;         // characters (null-terminated)
+    unsigned int length; // number of characters
+    unsigned int size;   // allocated bytes
+} PathBuffer;
+
+static void appendToPathBuffer(PathBuffer * buffer, const char * source, unsigned int length)
+{
+    if (buffer->length + length + 1 > buffer->size)
+    {
+        buffer->size = (buffer->length + length + 1) * 2;
+        buffer->data = (char *)realloc(buffer->data, sizeof(char) * buffer->size);
+    }
+
+    memcpy(buffer->data + buffer->length, source, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = 0;
+}
+
+static unsigned int hashCanonicalPath(const char * path, unsigned int pathLength)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+
+    for (unsigned int i = 0; i < pathLength; ++i)
+    {
+        hash ^= (unsigned char)path[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static unsigned int findCanonicalPathSlot(const CanonicalPathCache * cache, const char * path, unsigned int pathLength)
+{
+    unsigned int slot = hashCanonicalPath(path, pathLength) & (cache->capacity - 1);
+
+    while (cache->keys[slot] != 0x0
+        && (cache->keyLengths[slot] != pathLength || memcmp(cache->keys[slot], path, pathLength) != 0))
+    {
+        slot = (slot + 1) & (cache->capacity - 1);
+    }
+
+    return slot;
+}
+
+static void growCanonicalPathCache(CanonicalPathCache * cache)
+{
+    CanonicalPathCache grown;
+    grown.capacity = cache->capacity > 0 ? cache->capacity * 2 : 64;
+    grown.count = cache->count;
+    grown.keys = (char **)calloc(grown.capacity, sizeof(char *));
+    grown.keyLengths = (unsigned int *)malloc(sizeof(unsigned int) * grown.capacity);
+    grown.values = (char **)malloc(sizeof(char *) * grown.capacity);
+    grown.valueLengths = (unsigned int *)malloc(sizeof(unsigned int) * grown.capacity);
+
+    for (unsigned int i = 0; i < cache->capacity; ++i)
+    {
+        if (cache->keys[i] == 0x0)
+        {
+            continue;
+        }
+
+        const unsigned int slot = findCanonicalPathSlot(&grown, cache->keys[i], cache->keyLengths[i]);
+        grown.keys[slot] = cache->keys[i];
+        grown.keyLengths[slot] = cache->keyLengths[i];
+        grown.values[slot] = cache->values[i];
+        grown.valueLengths[slot] = cache->valueLengths[i];
+    }
+
+    free(cache->keys);
+    free(cache->keyLengths);
+    free(cache->values);
+    free(cache->valueLengths);
+
+    *cache = grown;
+}
+
+static unsigned char lookupCanonicalPath(const char * path, unsigned int pathLength, PathBuffer * canonical)
+{
+    unsigned char found = 0;
+
+    lockGlobalState();
+
+    if (canonicalPathCache.capacity > 0)
+    {
+        const unsigned int slot = findCanonicalPathSlot(&canonicalPathCache, path, pathLength);
+
+        if (canonicalPathCache.keys[slot] != 0x0)
+        {
+            canonical->length = 0;
+            appendToPathBuffer(canonical, canonicalPathCache.values[slot], canonicalPathCache.valueLengths[slot]);
+            found = 1;
+        }
+    }
+
+    unlockGlobalState();
+
+    return found;
+}
+
+static void storeCanonicalPath(const char * path, unsigned int pathLength, const char * canonical, unsigned int canonicalLength)
+{
+    lockGlobalState();
+
+    if (2 * (canonicalPathCache.count + 1) > canonicalPathCache.capacity)
+    {
+        growCanonicalPathCache(&canonicalPathCache);
+    }
+
+    const unsigned int slot = findCanonicalPathSlot(&canonicalPathCache, path, pathLength);
+
+    if (canonicalPathCache.keys[slot] == 0x0)
+    {
+        copyToString(path, pathLength, canonicalPathCache.keys + slot, canonicalPathCache.keyLengths + slot);
+        copyToString(canonical, canonicalLength, canonicalPathCache.values + slot, canonicalPathCache.valueLengths + slot);
+        ++canonicalPathCache.count;
+    }
+
+    unlockGlobalState();
+}
+
+#ifndef SYSTEM_WINDOWS
+
+/**
+*  @brief
+*    Resolve path components against a canonical directory
+*
+*  @param[inout] result
+*    Canonical directory ('' denotes the root), receives the canonical path
+*  @param[in] path
+*    Components to resolve
+*  @param[in] pathLength
+*    Length of path
+*  @param[inout] links
+*    Number of symbolic links followed so far
+*
+*  @return
+*    '1' on success, '0' if a component does not exist or too many links were followed
+*/
+static unsigned char resolveComponents(PathBuffer * result, const char * path, unsigned int pathLength, unsigned int * links)
+{
+    if (pathLength > 0 && path[0] == unixPathDelim)
+    {
+        result->length = 0;
+    }
+
+    unsigned int read = 0;
+
+    while (read < pathLength)
+    {
+        while (read < pathLength && path[read] == unixPathDelim)
+        {
+            ++read;
+        }
+
+        const unsigned int start = read;
+
+        while (read < pathLength && path[read] != unixPathDelim)
+        {
+            ++read;
+        }
+
+        const unsigned int length = read - start;
+
+        if (length == 0 || (length == 1 && path[start] == '.'))
+        {
+            continue;
+        }
+
+        if (length == 2 && path[start] == '.' && path[start + 1] == '.')
+        {
+            // The directory is canonical, so its parent is obtained lexically
+            while (result->length > 0 && result->data[result->length - 1] != unixPathDelim)
+            {
+                --result->length;
+            }
+
+            if (result->length > 0)
+            {
+                --result->length;
+            }
+
+            if (result->data != 0x0)
+            {
+                result->data[result->length] = 0;
+            }
+
+            continue;
+        }
+
+        const unsigned int parentLength = result->length;
+
+        appendToPathBuffer(result, "/", 1);
+        appendToPathBuffer(result, path + start, length);
+
+        if (lookupCanonicalPath(result->data, result->length, result))
+        {
+            continue;
+        }
+
+        struct stat info;
+
+        if (lstat(result->data, &info) != 0)
+        {
+            return 0;
+        }
+
+        if (!S_ISLNK(info.st_mode))
+        {
+            storeCanonicalPath(result->data, result->length, result->data, result->length);
+            continue;
+        }
+
+        if (++*links > maxSymbolicLinks)
+        {
+            return 0;
+        }
+
+        // Read link target
+        PathBuffer target = { 0x0, 0, 0 };
+        unsigned int targetSize = info.st_size > 0 ? (unsigned int)info.st_size + 1 : 256;
+
+        for (;;)
+        {
+            target.data = (char *)realloc(target.data, sizeof(char) * targetSize);
+
+            const ssize_t targetLength = readlink(result->data, target.data, targetSize);
+
+            if (targetLength < 0)
+            {
+                free(target.data);
+                return 0;
+            }
+
+            if ((unsigned int)targetLength < targetSize)
+            {
+                target.length = (unsigned int)targetLength;
+                break;
+            }
+
+            targetSize *= 2;
+        }
+
+        // Resolve target relative to the directory containing the link
+        PathBuffer resolved = { 0x0, 0, 0 };
+        appendToPathBuffer(&resolved, result->data, parentLength);
+
+        const unsigned char success = resolveComponents(&resolved, target.data, target.length, links);
+
+        if (success)
+        {
+            storeCanonicalPath(result->data, result->length, resolved.data, resolved.length);
+
+            result->length = 0;
+            appendToPathBuffer(result, resolved.data, resolved.length);
+        }
+
+        free(target.data);
+        free(resolved.data);
+
+        if (!success)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+#endif
+
+/**
+*  @brief
+*    Resolve a path to its canonical form
+*
+*  @param[in] path
+*    Path (not empty)
+*  @param[in] pathLength
+*    Length of path
+*  @param[out] result
+*    Canonical path (must be empty, the caller has to free result->data)
+*
+*  @return
+*    '1' on success, else '0'
+*/
+static unsigned char resolveCanonicalPath(const char * path, unsigned int pathLength, PathBuffer * result)
+{
+#ifdef SYSTEM_WINDOWS
+
+    // Let the system resolve links and junctions of the opened file
+    appendToPathBuffer(result, path, pathLength);
+
+    HANDLE file = CreateFileA(result->data, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0x0,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, 0x0);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return 0;
+    }
+
+    char systemPath[MAX_PATH];
+    DWORD length = GetFinalPathNameByHandleA(file, systemPath, MAX_PATH, FILE_NAME_NORMALIZED);
+    CloseHandle(file);
+
+    if (length == 0 || length >= MAX_PATH)
+    {
+        return 0;
+    }
+
+    // Strip '\\?\' prefix
+    const unsigned int prefixLength = length >= 4 && memcmp(systemPath, "\\\\?\\", 4) == 0 ? 4 : 0;
+
+    result->length = 0;
+    appendToPathBuffer(result, systemPath + prefixLength, length - prefixLength);
+    unifyPathDelimiters(result->data, result->length);
+
+#else
+
+    // Resolve relative paths against the working directory
+    if (path[0] != unixPathDelim)
+    {
+        char * workingDirectory = getcwd(0x0, 0);
+
+        if (workingDirectory == 0x0)
+        {
+            return 0;
+        }
+
+        unsigned int links = 0;
+        const unsigned char success = resolveComponents(result, workingDirectory, (unsigned int)strlen(workingDirectory), &links);
+
+        free(workingDirectory);
+
+        if (!success)
+        {
+            return 0;
+        }
+    }
+
+    unsigned int links = 0;
+
+    if (!resolveComponents(result, path, pathLength, &links))
+    {
+        return 0;
+    }
+
+    if (result->length == 0)
+    {
+        appendToPathBuffer(result, "/", 1);
+    }
+
+#endif
+
+    return 1;
+}
+
+void canonicalPath(const char * path, unsigned int pathLength, char ** canonical, unsigned int * canonicalLength)
+{
+    if (!checkStringOutParameter(canonical, canonicalLength))
+    {
+        return;
+    }
+
+    PathBuffer result = { 0x0, 0, 0 };
+
+    if (path == 0x0 || pathLength == 0 || !resolveCanonicalPath(path, pathLength, &result))
+    {
+        free(result.data);
+        invalidateStringOutParameter(canonical, canonicalLength);
+        return;
+    }
+
+    *canonical = (char *)transferMemory(result.data, sizeof(char) * (result.length + 1));
+    *canonicalLength = *canonical != 0x0 ? result.length : 0;
+}
+
+void canonicalPathTo(const char * path, unsigned int pathLength, const StringSink * sink)
+{
+    PathBuffer result = { 0x0, 0, 0 };
+
+    if (path == 0x0 || pathLength == 0 || !resolveCanonicalPath(path, pathLength, &result))
+    {
+        invalidateStringSink(sink);
+    }
+    else
+    {
+        writeStringSink(sink, result.data, result.length);
+    }
+
+    free(result.data);
+}
+
+void clearCanonicalPathCache()
+{
+    lockGlobalState();
+
+    for (unsigned int i = 0; i < canonicalPathCache.capacity; ++i)
+    {
+        if (canonicalPathCache.keys[i] != 0x0)
+        {
+            free(canonicalPathCache.keys[i]);
+            free(canonicalPathCache.values[i]);
+        }
+    }
+
+    free(canonicalPathCache.keys);
+    free(canonicalPathCache.keyLengths);
+    free(canonicalPathCache.values);
+    free(canonicalPathCache.valueLengths);
+
+    canonicalPathCache.keys = 0x0;
+    canonicalPathCache.keyLengths = 0x0;
+    canonicalPathCache.values = 0x0;
+    canonicalPathCache.valueLengths = 0x0;
+    canonicalPathCache.capacity = 0;
+    canonicalPathCache.count = 0;
+
+    unlockGlobalState();
 }
@@ -2,6 +2,11 @@
 #pragma once
 
 
+#include <stddef.h>
+
+#include <liblocate/liblocate.h>
+
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -14,6 +19,183 @@ unsigned char checkStringVectorOutParameter(char *** paths, unsigned int ** leng
 void invalidateStringOutParameter(char ** path, unsigned int * pathLength);
 void copyToStringOutParameter(const char * source, unsigned int length, char ** target, unsigned int * targetLength);
 
+/**
+*  @brief
+*    Copy a string into memory from malloc (e.g., for caches that outlive allocator changes)
+*/
+void copyToString(const char * source, unsigned int length, char ** target, unsigned int * targetLength);
+
+/**
+*  @brief
+*    Install the process-wide or thread-local allocator
+*
+*  @param[in] allocate
+*    Allocation function (0x0 restores malloc)
+*  @param[in] release
+*    Release function (0x0 restores free)
+*  @param[in] userData
+*    User data passed to both functions
+*  @param[in] threadLocal
+*    '1' to install the allocator for the calling thread only, '0' for all threads
+*/
+void installAllocator(LocateAllocate allocate, LocateRelease release, void * userData, unsigned char threadLocal);
+
+/**
+*  @brief
+*    Allocate memory with the allocator in effect for the calling thread
+*
+*  @param[in] size
+*    Number of bytes
+*
+*  @return
+*    Memory, 0x0 on failure
+*
+*  @remark
+*    Used for results handed to the caller and per-call temporaries.
+*    Release with freeMemory.
+*/
+void * allocateMemory(size_t size);
+
+/**
+*  @brief
+*    Release memory from allocateMemory or transferMemory
+*
+*  @param[in] memory
+*    Memory (may be 0x0)
+*
+*  @remark
+*    Uses the allocator the memory stems from, regardless of the
+*    allocators installed in the meantime.
+*/
+void freeMemory(void * memory);
+
+/**
+*  @brief
+*    Move a buffer from malloc into memory of the allocator in effect
+*
+*  @param[in] data
+*    Buffer allocated with malloc or realloc, ownership is transferred
+*  @param[in] size
+*    Number of bytes of data
+*
+*  @return
+*    data itself if no custom allocator is in effect, else a copy of data
+*
+*  @remark
+*    Allows growing buffers with realloc and handing them out without
+*    copying in the common case.
+*/
+void * transferMemory(void * data, size_t size);
+
+/**
+*  @brief
+*    Acquire the lock protecting the process-wide state of liblocate (e.g., caches and configuration)
+*
+*  @remark
+*    The lock is not recursive.
+*/
+void lockGlobalState();
+
+/**
+*  @brief
+*    Release the lock protecting the process-wide state of liblocate
+*/
+void unlockGlobalState();
+
+/**
+*  @brief
+*    Instruction set levels of the path scanning primitives
+*/
+#define PATH_SCAN_SCALAR 0
+#define PATH_SCAN_SSE2 1
+#define PATH_SCAN_AVX2 2
+
+/**
+*  @brief
+*    Get the highest instruction set level supported by the path scanning primitives on this machine
+*
+*  @return
+*    PATH_SCAN_SCALAR, PATH_SCAN_SSE2, or PATH_SCAN_AVX2
+*/
+unsigned char pathScanLevel();
+
+/**
+*  @brief
+*    Replace '\' with '/' using the given instruction set level
+*
+*  @param[in] level
+*    Instruction set level (clamped to pathScanLevel())
+*  @param[inout] path
+*    Path
+*  @param[in] pathLength
+*    The length of path
+*/
+void unifyPathDelimitersAt(unsigned char level, char * path, unsigned int pathLength);
+
+/**
+*  @brief
+*    Find the last path delimiter ('/' or '\') using the given instruction set level
+*
+*  @param[in] level
+*    Instruction set level (clamped to pathScanLevel())
+*  @param[in] path
+*    Path
+*  @param[in] pathLength
+*    The length of path
+*
+*  @return
+*    Index of the last delimiter, pathLength if path contains none
+*/
+unsigned int findLastPathDelimiterAt(unsigned char level, const char * path, unsigned int pathLength);
+
+/**
+*  @brief
+*    Find the last path delimiter ('/' or '\')
+*
+*  @param[in] path
+*    Path
+*  @param[in] pathLength
+*    The length of path
+*
+*  @return
+*    Index of the last delimiter, pathLength if path contains none
+*/
+unsigned int findLastPathDelimiter(const char * path, unsigned int pathLength);
+
+/**
+*  @brief
+*    Get the length of the common prefix of two strings using the given instruction set level
+*
+*  @param[in] level
+*    Instruction set level (clamped to pathScanLevel())
+*  @param[in] first
+*    First string
+*  @param[in] second
+*    Second string
+*  @param[in] length
+*    Number of characters to compare
+*
+*  @return
+*    Number of leading characters that are equal
+*/
+unsigned int commonPrefixLengthAt(unsigned char level, const char * first, const char * second, unsigned int length);
+
+/**
+*  @brief
+*    Get the length of the common prefix of two strings
+*
+*  @param[in] first
+*    First string
+*  @param[in] second
+*    Second string
+*  @param[in] length
+*    Number of characters to compare
+*
+*  @return
+*    Number of leading characters that are equal
+*/
+unsigned int commonPrefixLength(const char * first, const char * second, unsigned int length);
+
 /**
 *  @brief
 *    Convert path into unified form (replace '\' with '/')
@@ -25,6 +207,32 @@ void copyToStringOutParameter(const char * source, unsigned int length, char **
 */
 void unifyPathDelimiters(char * path, unsigned int pathLength);
 
+/**
+*  @brief
+*    Lexically normalize path in place
+*
+*  @param[inout] path
+*    Path
+*  @param[in] pathLength
+*    The length of path
+*  @param[out] newLength
+*    The length of the normalized path
+*
+*  @remark
+*    Unifies path delimiters, removes '.' components and duplicate
+*    delimiters, and resolves '..' against the preceding component
+*    without accessing the filesystem (symbolic links are not taken
+*    into account). A root ('/', 'C:/', or a leading '//') and a
+*    trailing delimiter are preserved. The result is never longer than
+*    path and is not null-terminated.
+*
+*    Examples:
+*      '/opt/app/lib/../../' -> '/opt/'
+*      'C:\\app\\.\\data' -> 'C:/app/data'
+*      'a/../../b' -> '../b'
+*/
+void normalizePath(char * path, unsigned int pathLength, unsigned int * newLength);
+
 /**
 *  @brief
 *    Cut away filename portion of a path, get path to directory
@@ -73,9 +281,62 @@ void getBundlePart(const char * fullpath, unsigned int length, unsigned int * ne
 *      '/usr/lib64/mylib.so' -> '/usr'
 *      '/usr/local/lib64/mylib.so' -> '/usr/local'
 *      '/crosscompile/armv4/usr/lib/mylib.so.2' -> '/crosscompile/armv4/usr'
+*
+*    The recognized prefixes are '/usr', '/usr/local', the entries of
+*    the environment variable LIBLOCATE_SYSTEM_PREFIXES, and prefixes
+*    registered with addSystemBasePrefix, each followed by 'bin', 'lib',
+*    'lib32', or 'lib64'. Earlier prefixes take precedence; for each
+*    prefix, the rightmost occurrence within path is used.
 */
 void getSystemBasePath(const char * path, unsigned int pathLength, unsigned int * systemPathLength);
 
+/**
+*  @brief
+*    Register an additional install prefix for getSystemBasePath
+*
+*  @param[in] prefix
+*    Install prefix (e.g., '/opt/vendor')
+*  @param[in] prefixLength
+*    Length of prefix
+*/
+void addSystemBasePrefix(const char * prefix, unsigned int prefixLength);
+
+/**
+*  @brief
+*    Remove all registered install prefixes and re-read LIBLOCATE_SYSTEM_PREFIXES on next use
+*/
+void resetSystemBasePrefixes();
+
+/**
+*  @brief
+*    Capture the environment variables consumed by liblocate anew
+*
+*  @remark
+*    The snapshot is taken on first use otherwise. Readers of the
+*    previous snapshot are not affected.
+*/
+void refreshEnvironmentSnapshot();
+
+/**
+*  @brief
+*    Get value of environment variable from the environment snapshot
+*
+*  @param[in] name
+*    Name of environment variable (one of the variables consumed by liblocate)
+*  @param[in] nameLength
+*    The length of name
+*  @param[out] valueLength
+*    The length of the value (may be null)
+*
+*  @return
+*    Null-terminated value, null if the variable is unset, empty, or not part of the snapshot
+*
+*  @remark
+*    The lookup neither locks nor allocates; the value remains valid for
+*    the lifetime of the process.
+*/
+const char * getEnvView(const char * name, unsigned int nameLength, unsigned int * valueLength);
+
 /**
 *  @brief
 *    Get value of environment variable
@@ -92,6 +353,7 @@ void getSystemBasePath(const char * path, unsigned int pathLength, unsigned int
 *  @return
 *    Value of the environment variable
 *
+*  Variables consumed by liblocate are read from the environment snapshot (see getEnvView).
 *  The caller takes memory ownership over *value.
 */
 void getEnv(const char * name, unsigned int nameLength, char ** value, unsigned int * valueLength);
@@ -110,6 +372,53 @@ void getEnv(const char * name, unsigned int nameLength, char ** value, unsigned
 */
 unsigned char fileExists(const char * path, unsigned int pathLength);
 
+/**
+*  @brief
+*    Open file or directory for reading
+*
+*  @param[in] path
+*    Path to file or directory
+*  @param[in] pathLength
+*    Length of path
+*
+*  @return
+*    File descriptor, -1 on error
+*
+*  @remark
+*    The caller takes ownership over the file descriptor.
+*/
+int openFile(const char * path, unsigned int pathLength);
+
+/**
+*  @brief
+*    Resolve a path to its canonical form
+*
+*  @param[in] path
+*    Absolute or relative path
+*  @param[in] pathLength
+*    Length of path
+*  @param[out] canonical
+*    Absolute path without symbolic links, '.' and '..' components, and duplicate delimiters
+*  @param[out] canonicalLength
+*    Length of canonical
+*
+*  @remark
+*    Like realpath, but the canonical form of each '<directory>/<name>'
+*    visited is kept in a process-wide cache, so resolving many paths
+*    that share ancestors reads each symbolic link only once. If path
+*    does not exist, an empty string is returned.
+*
+*  @remark
+*    The caller takes memory ownership over *canonical.
+*/
+void canonicalPath(const char * path, unsigned int pathLength, char ** canonical, unsigned int * canonicalLength);
+
+/**
+*  @brief
+*    Discard all cached canonical paths
+*/
+void clearCanonicalPathCache();
+
 
 #ifdef __cplusplus
 }
@@ -1,8 +1,25 @@
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+#ifndef SYSTEM_WINDOWS
+    #include <dlfcn.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 #include <gmock/gmock.h>
 
 #include <cpplocate/cpplocate.h>
 
+#include <liblocate/liblocate.h>
+
+#include <cpplocate_test_resources.h>
+
 
 class cpplocate_test : public testing::Test
 {
@@ -12,6 +29,32 @@ public:
     }
 };
 
+namespace
+{
+
+
+/**
+*  @brief
+*    Allocator counting the allocations of liblocate
+*/
+struct CountingAllocator
+{
+    static void * allocate(size_t size, void * userData)
+    {
+        ++*static_cast<unsigned int *>(userData);
+
+        return malloc(size);
+    }
+
+    static void release(void * memory, void *)
+    {
+        free(memory);
+    }
+};
+
+
+} // namespace
+
 TEST_F(cpplocate_test, getExecutablePath_Return)
 {
     const auto result = cpplocate::getExecutablePath();
@@ -59,6 +102,341 @@ TEST_F(cpplocate_test, locatePath_Return)
     EXPECT_NE(nullptr, result.c_str());
 }
 
+TEST_F(cpplocate_test, locatePath_NoResultCopies)
+{
+    const auto symbol = reinterpret_cast<void*>(cpplocate::getExecutablePath);
+    const auto relPath = std::string("source/version.h.in");
+
+    auto path = std::string();
+    path.reserve(4096);
+    cpplocate::locatePath(relPath, "", symbol, path);
+
+    char * result = nullptr;
+    unsigned int resultLength = 0;
+    auto native = 0u;
+    auto roundTrip = 0u;
+
+    // Results are written into the string, not allocated by liblocate and copied
+    setThreadAllocator(&CountingAllocator::allocate, &CountingAllocator::release, &native);
+    cpplocate::getLibraryPath(symbol, path);
+    setThreadAllocator(&CountingAllocator::allocate, &CountingAllocator::release, &roundTrip);
+    ::getLibraryPath(symbol, &result, &resultLength);
+    releaseMemory(result);
+    setThreadAllocator(nullptr, nullptr, nullptr);
+
+    EXPECT_EQ(0u, native);
+    EXPECT_EQ(1u, roundTrip);
+
+    native = 0;
+    roundTrip = 0;
+
+    // Temporaries of the search are allocated either way
+    setThreadAllocator(&CountingAllocator::allocate, &CountingAllocator::release, &native);
+    cpplocate::locatePath(relPath, "", symbol, path);
+    setThreadAllocator(&CountingAllocator::allocate, &CountingAllocator::release, &roundTrip);
+    ::locatePath(&result, &resultLength, relPath.c_str(), static_cast<unsigned int>(relPath.size()), "", 0, symbol);
+    releaseMemory(result);
+    setThreadAllocator(nullptr, nullptr, nullptr);
+
+    EXPECT_EQ(roundTrip - 1, native);
+}
+
+TEST_F(cpplocate_test, locatePath_IntoString)
+{
+    const auto symbol = reinterpret_cast<void*>(cpplocate::getExecutablePath);
+    const auto expected = cpplocate::locatePath(std::string("source/version.h.in"), std::string(), symbol);
+
+    ASSERT_LT(0, expected.size());
+
+    // Results are written into the reserved storage of the string
+    auto path = std::string();
+    path.reserve(4096);
+    const auto data = path.data();
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        cpplocate::locatePath("source/version.h.in", "", symbol, path);
+
+        EXPECT_EQ(expected, path);
+        EXPECT_EQ(data, path.data());
+    }
+
+    cpplocate::locatePath("source/does-not-exist.txt", "", symbol, path);
+    EXPECT_EQ("", path);
+    EXPECT_EQ(data, path.data());
+
+    cpplocate::locateCanonicalPath("source/version.h.in", "", symbol, path);
+    EXPECT_EQ(cpplocate::locateCanonicalPath("source/version.h.in", "", symbol), path);
+
+    cpplocate::canonicalPath(expected, path);
+    EXPECT_EQ(cpplocate::canonicalPath(expected), path);
+
+    cpplocate::getLibraryPath(symbol, path);
+    EXPECT_EQ(cpplocate::getLibraryPath(symbol), path);
+    EXPECT_EQ(data, path.data());
+
+    cpplocate::getLibraryPath(nullptr, path);
+    EXPECT_EQ("", path);
+}
+
+TEST_F(cpplocate_test, locatePath_Interned)
+{
+    const auto symbol = reinterpret_cast<void*>(cpplocate::getExecutablePath);
+    const auto before = cpplocate::pathTableStatistics();
+
+    auto first = cpplocate::Path();
+    auto second = cpplocate::Path();
+
+    cpplocate::locatePath("source/version.h.in", "", symbol, first);
+    cpplocate::locatePath("source/version.h.in", "", symbol, second);
+
+    // Equal results share one entry of the table
+    EXPECT_EQ(cpplocate::locatePath("source/version.h.in", "", symbol), first.str());
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first.c_str(), second.c_str());
+    EXPECT_EQ(first.size(), cpplocate::PathView(second).size());
+    EXPECT_EQ(std::hash<cpplocate::Path>()(first), std::hash<cpplocate::Path>()(second));
+
+    auto during = cpplocate::pathTableStatistics();
+    EXPECT_EQ(before.paths + 1, during.paths);
+    EXPECT_EQ(before.characters + first.size(), during.characters);
+    EXPECT_LT(before.bytes, during.bytes);
+    EXPECT_EQ(before.lookups + 2, during.lookups);
+    EXPECT_EQ(before.hits + 1, during.hits);
+
+    const auto copy = first;
+    EXPECT_EQ(before.references + 3, cpplocate::pathTableStatistics().references);
+
+    auto executable = cpplocate::internPath(cpplocate::getExecutablePath());
+    EXPECT_EQ(cpplocate::getExecutablePath(), executable.str());
+    EXPECT_NE(first, executable);
+    EXPECT_EQ(executable, cpplocate::internPath(cpplocate::getExecutablePath()));
+
+    cpplocate::locatePath("source/does-not-exist.txt", "", symbol, second);
+    EXPECT_TRUE(second.empty());
+    EXPECT_EQ("", second.str());
+    EXPECT_EQ(cpplocate::Path(), second);
+
+    // The entry is removed with the last handle
+    first = cpplocate::Path();
+    EXPECT_EQ(before.paths + 2, cpplocate::pathTableStatistics().paths);
+
+    executable = cpplocate::Path();
+    during = cpplocate::pathTableStatistics();
+    EXPECT_EQ(before.paths + 1, during.paths);
+    EXPECT_EQ(before.references + 1, during.references);
+}
+
+TEST_F(cpplocate_test, normalizePath)
+{
+    EXPECT_EQ("/opt/", cpplocate::normalizePath("/opt/app/lib/../../"));
+    EXPECT_EQ("", cpplocate::normalizePath(""));
+
+    const auto result = cpplocate::normalizePaths({ "a/./b", "", "C:\\x\\..\\y" });
+
+    ASSERT_EQ(3, result.size());
+    EXPECT_EQ("a/b", result[0]);
+    EXPECT_EQ("", result[1]);
+    EXPECT_EQ("C:/y", result[2]);
+}
+
+TEST_F(cpplocate_test, canonicalPath)
+{
+    const auto modulePath = cpplocate::getModulePath();
+
+    EXPECT_EQ(cpplocate::canonicalPath(modulePath), cpplocate::getCanonicalModulePath());
+    EXPECT_EQ(cpplocate::canonicalPath(modulePath), cpplocate::canonicalPath(modulePath + "/./../" + modulePath.substr(modulePath.rfind('/') + 1)));
+    EXPECT_EQ("", cpplocate::canonicalPath(modulePath + "/does-not-exist"));
+
+    const auto located = cpplocate::locateCanonicalPath("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    EXPECT_EQ(cpplocate::canonicalPath(cpplocate::locatePath("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath))) + "/", located);
+}
+
+TEST_F(cpplocate_test, locatePath_Literal)
+{
+    const auto symbol = reinterpret_cast<void*>(cpplocate::getExecutablePath);
+    const auto expected = cpplocate::locatePath(std::string("source/version.h.in"), std::string("share/liblocate"), symbol);
+
+    EXPECT_EQ(expected, cpplocate::locatePath("source/version.h.in", "share/liblocate", symbol));
+    EXPECT_EQ(expected, cpplocate::locatePath("source/version.h.in", std::string("share/liblocate"), symbol));
+    EXPECT_EQ(expected, cpplocate::locatePath(cpplocate::PathView("source/version.h.in"), cpplocate::PathView(), symbol));
+}
+
+TEST_F(cpplocate_test, pathView)
+{
+    static_assert(cpplocate::PathView("/usr/include/tuple").size() == 18, "");
+    static_assert(cpplocate::directoryPart("/usr/include/c++/v1/tuple").size() == 19, "");
+    static_assert(cpplocate::directoryPart("A-string").size() == 8, "");
+    static_assert(cpplocate::directoryPart("C:\\dev\\tuple").size() == 6, "");
+    static_assert(cpplocate::bundlePart("/home/user/test.app/Contents/MacOS").size() == 19, "");
+    static_assert(cpplocate::bundlePart("/usr/local/lib/test").empty(), "");
+    static_assert(cpplocate::systemBasePath("/usr/local/lib/cpplocate").size() == 11, "");
+    static_assert(cpplocate::systemBasePath("/home/user/dev/deploy/usr/local/lib/cpplocate").size() == 32, "");
+    static_assert(cpplocate::systemBasePath("/opt/usr/lib/lib/x").size() == 9, "");
+    static_assert(cpplocate::systemBasePath("/opt/app/lib/x").empty(), "");
+    static_assert(cpplocate::isUnified("/usr/lib") && !cpplocate::isUnified("C:\\dev"), "");
+    static_assert(cpplocate::startsWith("/usr/lib", "/usr/") && !cpplocate::startsWith("/us", "/usr/"), "");
+    static_assert(cpplocate::findLast("a/b/a/b", "a/b") == 4 && cpplocate::findLast("a", "ab") == cpplocate::pathNotFound, "");
+
+    EXPECT_EQ("/usr/include/c++/v1", cpplocate::directoryPart("/usr/include/c++/v1/tuple").str());
+}
+
+TEST_F(cpplocate_test, traits)
+{
+    static_assert(cpplocate::traits::libExtensions().size() == cpplocate::traits::libExtensionCount, "");
+    static_assert(cpplocate::traits::libPrefix().size() <= 3 && !cpplocate::traits::libExtension().empty(), "");
+
+    EXPECT_EQ(cpplocate::pathSeparator(), std::string(1, cpplocate::traits::pathSeparator()));
+    EXPECT_EQ(cpplocate::libPrefix(), cpplocate::traits::libPrefix().str());
+    EXPECT_EQ(cpplocate::libExtension(), cpplocate::traits::libExtension().str());
+    EXPECT_EQ(cpplocate::traits::libExtensionCount, cpplocate::libExtensions().size());
+    EXPECT_EQ(cpplocate::traits::libExtension().str(), cpplocate::traits::libExtensions().front().str());
+}
+
+TEST_F(cpplocate_test, composeLibraryFileNames)
+{
+    auto buffer = std::string();
+    const auto offsets = cpplocate::composeLibraryFileNames({ "first", "second" }, buffer);
+    const auto extensions = cpplocate::libExtensions();
+
+    ASSERT_EQ(2 * extensions.size() + 1, offsets.size());
+    EXPECT_EQ(buffer.size(), offsets.back());
+
+    for (auto i = 0u; i < 2; ++i)
+    {
+        for (auto j = 0u; j < extensions.size(); ++j)
+        {
+            const auto k = i * extensions.size() + j;
+            const auto expected = cpplocate::libPrefix() + (i == 0 ? "first" : "second") + "." + extensions[j];
+
+            EXPECT_EQ(expected, std::string(buffer.data() + offsets[k], offsets[k + 1] - offsets[k] - 1));
+            EXPECT_EQ('\0', buffer[offsets[k + 1] - 1]);
+        }
+    }
+
+    EXPECT_EQ(1, cpplocate::composeLibraryFileNames({}, buffer).size());
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST_F(cpplocate_test, locateAllPaths)
+{
+    const auto symbol = reinterpret_cast<void*>(cpplocate::getExecutablePath);
+    const auto result = cpplocate::locateAllPaths("source/version.h.in", "share/liblocate", symbol);
+
+    ASSERT_LT(0, result.size());
+    EXPECT_EQ(cpplocate::locatePath("source/version.h.in", "share/liblocate", symbol), result[0].path);
+    EXPECT_EQ(cpplocate::LocateStage::Library, result[0].stage);
+
+    EXPECT_TRUE(cpplocate::locateAllPaths("source/does-not-exist.txt", "", symbol).empty());
+}
+
+TEST_F(cpplocate_test, openLocated)
+{
+    auto file = cpplocate::openLocated("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    EXPECT_TRUE(file.valid());
+
+    const auto moved = std::move(file);
+
+    EXPECT_FALSE(file.valid());
+    EXPECT_TRUE(moved.valid());
+
+    EXPECT_FALSE(cpplocate::openLocated("source/does-not-exist.txt", "", nullptr).valid());
+}
+
+TEST_F(cpplocate_test, mapLocated)
+{
+    const auto first = cpplocate::mapLocated("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+    const auto second = cpplocate::mapLocated("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    ASSERT_NE(nullptr, first);
+    EXPECT_LT(0, first->size());
+    EXPECT_NE(nullptr, first->data());
+    EXPECT_EQ(first, second);
+
+    EXPECT_EQ(nullptr, cpplocate::mapLocated("source/does-not-exist.txt", "", nullptr));
+}
+
+TEST_F(cpplocate_test, mapLocated_Rewritten)
+{
+    const auto executablePath = cpplocate::getExecutablePath();
+    const auto fileName = executablePath.substr(0, executablePath.find_last_of("/\\") + 1) + "cpplocate-map-test.txt";
+
+    std::ofstream(fileName) << "first";
+    const auto first = cpplocate::mapLocated("cpplocate-map-test.txt", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    // Rewriting the file in place keeps device and inode, but changes its size
+    std::ofstream(fileName, std::ios::trunc) << "second version";
+    const auto second = cpplocate::mapLocated("cpplocate-map-test.txt", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(std::string("second version"), std::string(static_cast<const char *>(second->data()), second->size()));
+    EXPECT_EQ(second, cpplocate::mapLocated("cpplocate-map-test.txt", "", reinterpret_cast<void*>(cpplocate::getExecutablePath)));
+
+    std::remove(fileName.c_str());
+}
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(cpplocate_test, ensureDir)
+{
+    char tempDir[] = "/tmp/cpplocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDir));
+
+    const auto base = std::string(tempDir);
+    const auto dir = cpplocate::ensureDir(base + "/a/b//c/", 0750);
+
+    ASSERT_TRUE(dir.valid());
+
+    struct stat info;
+    ASSERT_EQ(0, stat((base + "/a/b/c").c_str(), &info));
+    EXPECT_TRUE(S_ISDIR(info.st_mode));
+    EXPECT_EQ(0750, info.st_mode & 0777);
+
+    // The descriptor refers to the created directory
+    const auto file = openat(dir.get(), "file", O_WRONLY | O_CREAT, 0600);
+    ASSERT_LE(0, file);
+    close(file);
+    EXPECT_EQ(0, stat((base + "/a/b/c/file").c_str(), &info));
+
+    // Existing directories are opened, files within the path are rejected
+    EXPECT_TRUE(cpplocate::ensureDir(base + "/a/b", 0750).valid());
+    EXPECT_FALSE(cpplocate::ensureDir(base + "/a/b/c/file/d", 0750).valid());
+    EXPECT_FALSE(cpplocate::ensureDir("", 0750).valid());
+
+    // Config directory
+    const auto original = getenv("XDG_CONFIG_HOME");
+    const auto originalValue = std::string(original != nullptr ? original : "");
+
+    setenv("XDG_CONFIG_HOME", (base + "/config").c_str(), 1);
+    cpplocate::refreshEnvironment();
+
+    EXPECT_TRUE(cpplocate::ensureConfigDir("app").valid());
+    ASSERT_EQ(0, stat((base + "/config/app").c_str(), &info));
+    EXPECT_EQ(0700, info.st_mode & 0777);
+
+    if (original != nullptr)
+    {
+        setenv("XDG_CONFIG_HOME", originalValue.c_str(), 1);
+    }
+    else
+    {
+        unsetenv("XDG_CONFIG_HOME");
+    }
+
+    cpplocate::refreshEnvironment();
+
+    std::remove((base + "/a/b/c/file").c_str());
+
+    for (const auto & path : { "/a/b/c", "/a/b", "/a", "/config/app", "/config", "" })
+    {
+        rmdir((base + path).c_str());
+    }
+}
+#endif
+
 TEST_F(cpplocate_test, pathSeperator)
 {
     #ifdef WIN32
@@ -112,3 +490,546 @@ TEST_F(cpplocate_test, homeDirectory)
     const auto dir = cpplocate::homeDir();
     ASSERT_LT(0, dir.size());
 }
+
+TEST_F(cpplocate_test, findEmbeddedResource)
+{
+    const auto resource = cpplocate::findEmbeddedResource("source/tests/cpplocate-test/resources/hello.txt");
+
+    ASSERT_NE(nullptr, resource);
+    EXPECT_EQ("Hello cpplocate\n", std::string(resource->data, resource->size));
+    EXPECT_EQ(0, resource->data[resource->size]);
+
+    EXPECT_NE(nullptr, cpplocate::findEmbeddedResource("source/tests/cpplocate-test/resources/config/default.json"));
+    EXPECT_EQ(nullptr, cpplocate::findEmbeddedResource("source/tests/cpplocate-test/resources/missing.txt"));
+
+    // The generated table is accessible through the generated header
+    auto count = std::size_t(0);
+    const auto resources = cpplocate_test_resources(&count);
+
+    ASSERT_NE(nullptr, resources);
+    EXPECT_LE(2u, count);
+}
+
+TEST_F(cpplocate_test, locateResource)
+{
+    const auto relPath = std::string("source/tests/cpplocate-test/resources/hello.txt");
+
+    const auto embedded = cpplocate::locateResource(relPath, "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    EXPECT_TRUE(embedded.path.empty());
+    ASSERT_NE(nullptr, embedded.data);
+    EXPECT_EQ("Hello cpplocate\n", std::string(embedded.data, embedded.size));
+
+    cpplocate::setEmbeddedResourceOverrides(true);
+    const auto overridden = cpplocate::locateResource(relPath, "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+    cpplocate::setEmbeddedResourceOverrides(false);
+
+    EXPECT_LT(0, overridden.path.size());
+    EXPECT_EQ(nullptr, overridden.data);
+
+    const auto onDisk = cpplocate::locateResource("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+
+    EXPECT_LT(0, onDisk.path.size());
+    EXPECT_EQ(nullptr, onDisk.data);
+}
+
+TEST_F(cpplocate_test, prefetch)
+{
+    const auto base = cpplocate::locatePath("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+    ASSERT_LT(0, base.size());
+
+    const auto before = cpplocate::prefetchStatistics();
+
+    cpplocate::prefetch(base, std::vector<std::string>{ "source/version.h.in", "README.md", "source/does-not-exist.txt" });
+    cpplocate::waitForPrefetch();
+
+    const auto after = cpplocate::prefetchStatistics();
+
+    EXPECT_EQ(before.filesRequested + 3, after.filesRequested);
+    EXPECT_EQ(before.filesPrefetched + 2, after.filesPrefetched);
+    EXPECT_EQ(before.filesFailed + 1, after.filesFailed);
+
+    // Exactly the sizes of the opened files are accounted
+    const auto fileSize = [&base](const std::string & relPath)
+    {
+        return static_cast<std::uint64_t>(std::ifstream(base + relPath, std::ios::binary | std::ios::ate).tellg());
+    };
+
+    EXPECT_EQ(before.bytesPrefetched + fileSize("source/version.h.in") + fileSize("README.md"), after.bytesPrefetched);
+
+    // A single request in flight still processes the whole queue
+    cpplocate::setMaxPrefetchRequests(1);
+    cpplocate::prefetch(base, std::vector<std::string>{ "source/version.h.in", "README.md" });
+    cpplocate::waitForPrefetch();
+    cpplocate::setMaxPrefetchRequests(4);
+
+    EXPECT_EQ(after.filesPrefetched + 2, cpplocate::prefetchStatistics().filesPrefetched);
+}
+
+TEST_F(cpplocate_test, prefetchPattern)
+{
+    const auto base = cpplocate::locatePath("source/version.h.in", "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+    ASSERT_LT(0, base.size());
+
+    const auto before = cpplocate::prefetchStatistics();
+
+    cpplocate::prefetchMatching(base + "source", "*.h.?n");
+    cpplocate::waitForPrefetch();
+
+    const auto after = cpplocate::prefetchStatistics();
+
+    EXPECT_EQ(before.filesRequested + 1, after.filesRequested);
+    EXPECT_EQ(before.filesPrefetched + 1, after.filesPrefetched);
+}
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(cpplocate_test, findLibraries)
+{
+    char tempDir[] = "/tmp/cpplocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDir));
+
+    const auto root = std::string(tempDir);
+    const auto prefix = cpplocate::libPrefix();
+    const auto extension = cpplocate::libExtension();
+
+    const auto files = std::vector<std::string>{
+        prefix + "firstplugin." + extension,
+        prefix + "secondplugin." + extension,
+        prefix + "other." + extension,
+        "firstplugin.txt",
+        prefix + "plugin." + extension + ".1"
+    };
+
+    for (const auto & file : files)
+    {
+        std::ofstream(root + "/" + file) << file;
+    }
+
+    const auto results = cpplocate::findLibraries({ root, root + "/missing" }, "*plugin");
+
+    ASSERT_EQ(2, results.size());
+    EXPECT_EQ(root, results[0].directory);
+    EXPECT_TRUE(results[0].scanned);
+    EXPECT_FALSE(results[1].scanned);
+    EXPECT_TRUE(results[1].libraries.empty());
+
+    ASSERT_EQ(2, results[0].libraries.size());
+    EXPECT_EQ(root + "/" + files[0], results[0].libraries[0].path);
+    EXPECT_EQ("firstplugin", results[0].libraries[0].name);
+    EXPECT_EQ(files[0].size(), results[0].libraries[0].size);
+    EXPECT_LT(0, results[0].libraries[0].modified);
+    EXPECT_EQ("secondplugin", results[0].libraries[1].name);
+
+    for (const auto & file : files)
+    {
+        std::remove((root + "/" + file).c_str());
+    }
+
+    rmdir(tempDir);
+}
+#endif
+
+#if defined(SYSTEM_LINUX) && defined(CPPLOCATE_TEST_PLUGIN_BASE)
+TEST_F(cpplocate_test, libraryDependencies)
+{
+    const auto base = std::string(CPPLOCATE_TEST_PLUGIN_BASE);
+    const auto dependent = std::string(CPPLOCATE_TEST_PLUGIN_DEPENDENT);
+    const auto baseName = base.substr(base.find_last_of('/') + 1);
+
+    const auto needed = cpplocate::libraryDependencies(dependent);
+
+    EXPECT_NE(needed.end(), std::find(needed.begin(), needed.end(), baseName));
+    EXPECT_TRUE(cpplocate::libraryDependencies(base + ".missing").empty());
+}
+
+TEST_F(cpplocate_test, loadLibraries)
+{
+    const auto base = std::string(CPPLOCATE_TEST_PLUGIN_BASE);
+    const auto dependent = std::string(CPPLOCATE_TEST_PLUGIN_DEPENDENT);
+
+    // Dependent plugin first, the loader has to reorder
+    auto libraries = cpplocate::loadLibraries({ dependent, base, base + ".missing" }, 4);
+
+    ASSERT_EQ(3, libraries.size());
+    EXPECT_EQ(dependent, libraries[0].path);
+    ASSERT_NE(nullptr, libraries[0].handle);
+    ASSERT_NE(nullptr, libraries[1].handle);
+    EXPECT_EQ(nullptr, libraries[2].handle);
+    EXPECT_FALSE(libraries[2].error.empty());
+
+    ASSERT_EQ(1, libraries[0].dependencies.size());
+    EXPECT_EQ(base, libraries[0].dependencies[0]);
+    EXPECT_TRUE(libraries[1].dependencies.empty());
+
+    using Function = int (*)();
+    const auto function = reinterpret_cast<Function>(dlsym(libraries[0].handle, "pluginDependentValue"));
+    ASSERT_NE(nullptr, function);
+    EXPECT_EQ(43, function());
+
+    cpplocate::unloadLibraries(libraries);
+
+    EXPECT_EQ(nullptr, libraries[0].handle);
+    EXPECT_EQ(nullptr, libraries[1].handle);
+}
+#endif
+
+#if defined(SYSTEM_LINUX) && defined(__x86_64__) && !defined(__ILP32__)
+TEST_F(cpplocate_test, findSystemLibrary)
+{
+    // Sample caches list i386, x86-64, and aarch64 entries of libz.so.1, libsample.so(.2), and libother.so.5;
+    // the combined sample precedes them with an old table of a single entry, so the new header is 8-byte aligned
+    const auto relPath = std::string("source/tests/cpplocate-test/data/");
+    const auto base = cpplocate::locatePath(relPath, "", reinterpret_cast<void*>(cpplocate::getExecutablePath));
+    ASSERT_FALSE(base.empty());
+
+    for (const auto & format : { "ld.so.cache-new", "ld.so.cache-old", "ld.so.cache-combined" })
+    {
+        const auto cacheFile = base + relPath + format;
+
+        EXPECT_EQ("/usr/lib/x86_64-linux-gnu/libz.so.1", cpplocate::findSystemLibrary("libz.so.1", cacheFile));
+        EXPECT_EQ("/opt/sample/lib/libsample.so.2", cpplocate::findSystemLibrary("libsample.so.2", cacheFile));
+        EXPECT_EQ("/opt/sample/lib/libsample.so", cpplocate::findSystemLibrary("sample", cacheFile));
+        EXPECT_EQ("/usr/lib/libother.so.5", cpplocate::findSystemLibrary("other", cacheFile));
+        EXPECT_EQ("", cpplocate::findSystemLibrary("cpplocate-missing", cacheFile));
+    }
+
+    // Falls back to probing the system library directories
+    EXPECT_EQ("", cpplocate::findSystemLibrary("cpplocate-missing", base + relPath + "missing"));
+    EXPECT_FALSE(cpplocate::findSystemLibrary("libc.so.6").empty());
+
+    cpplocate::clearSystemLibraryCache();
+
+    // The cache file is parsed once; later lookups do not read it again
+    char copy[] = "/tmp/cpplocate-test-XXXXXX";
+    const auto descriptor = mkstemp(copy);
+    ASSERT_LE(0, descriptor);
+    close(descriptor);
+
+    {
+        std::ifstream source(base + relPath + "ld.so.cache-new", std::ios::binary);
+        std::ofstream(copy, std::ios::binary) << source.rdbuf();
+    }
+
+    EXPECT_EQ("/opt/sample/lib/libsample.so.2", cpplocate::findSystemLibrary("libsample.so.2", copy));
+
+    std::ofstream(copy, std::ios::binary | std::ios::trunc) << "garbage";
+    EXPECT_EQ("/usr/lib/libother.so.5", cpplocate::findSystemLibrary("other", copy));
+
+    cpplocate::clearSystemLibraryCache();
+    EXPECT_EQ("", cpplocate::findSystemLibrary("libsample.so.2", copy));
+
+    std::remove(copy);
+    cpplocate::clearSystemLibraryCache();
+}
+#endif
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(cpplocate_test, findExecutable)
+{
+    const auto path = std::string(getenv("PATH") != nullptr ? getenv("PATH") : "");
+
+    char tempDir[] = "/tmp/cpplocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDir));
+
+    const auto first = std::string(tempDir) + "/first";
+    const auto second = std::string(tempDir) + "/second";
+    mkdir(first.c_str(), 0755);
+    mkdir(second.c_str(), 0755);
+
+    const auto createFile = [](const std::string & file, mode_t mode)
+    {
+        std::ofstream(file) << "#!/bin/sh\n";
+        chmod(file.c_str(), mode);
+    };
+
+    createFile(first + "/tool", 0644);
+    createFile(second + "/tool", 0755);
+
+    setenv("PATH", (first + ":" + std::string(tempDir) + "/missing:" + second).c_str(), 1);
+    cpplocate::refreshEnvironment();
+
+    // Non-executable files are skipped
+    EXPECT_EQ(second + "/tool", cpplocate::findExecutable("tool"));
+    EXPECT_EQ("", cpplocate::findExecutable("missing-tool"));
+
+    // First match wins once executable
+    chmod((first + "/tool").c_str(), 0755);
+    EXPECT_EQ(first + "/tool", cpplocate::findExecutable("tool"));
+
+    // New files are picked up
+    createFile(second + "/other", 0755);
+    EXPECT_EQ(second + "/other", cpplocate::findExecutable("other"));
+
+    EXPECT_EQ(second + "/other", cpplocate::findExecutable(second + "/other"));
+    EXPECT_EQ("", cpplocate::findExecutable(first + "/other"));
+
+    setenv("PATH", path.c_str(), 1);
+    cpplocate::refreshEnvironment();
+    cpplocate::clearExecutableCache();
+
+    EXPECT_FALSE(cpplocate::findExecutable("sh").empty());
+
+    for (const auto & file : { first + "/tool", second + "/tool", second + "/other" })
+    {
+        std::remove(file.c_str());
+    }
+
+    rmdir(first.c_str());
+    rmdir(second.c_str());
+    rmdir(tempDir);
+}
+#endif
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(cpplocate_test, findExecutable_Index)
+{
+    const auto path = std::string(getenv("PATH") != nullptr ? getenv("PATH") : "");
+
+    char tempDir[] = "/tmp/cpplocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDir));
+
+    const auto directory = std::string(tempDir);
+
+    // Pin the modification time of the directory to the past, so its index is considered stable
+    const auto pinModified = [&directory]()
+    {
+        struct timespec times[2];
+        times[0].tv_sec = times[1].tv_sec = 1000000000;
+        times[0].tv_nsec = times[1].tv_nsec = 0;
+
+        return utimensat(AT_FDCWD, directory.c_str(), times, 0);
+    };
+
+    std::ofstream(directory + "/tool") << "#!/bin/sh\n";
+    chmod((directory + "/tool").c_str(), 0755);
+    ASSERT_EQ(0, pinModified());
+
+    setenv("PATH", directory.c_str(), 1);
+    cpplocate::refreshEnvironment();
+    cpplocate::clearExecutableCache();
+
+    EXPECT_EQ(directory + "/tool", cpplocate::findExecutable("tool"));
+
+    // Lookups are answered from the index as long as the directory is unmodified
+    std::ofstream(directory + "/hidden") << "#!/bin/sh\n";
+    chmod((directory + "/hidden").c_str(), 0755);
+    ASSERT_EQ(0, pinModified());
+
+    EXPECT_EQ("", cpplocate::findExecutable("hidden"));
+
+    cpplocate::clearExecutableCache();
+    EXPECT_EQ(directory + "/hidden", cpplocate::findExecutable("hidden"));
+
+    setenv("PATH", path.c_str(), 1);
+    cpplocate::refreshEnvironment();
+    cpplocate::clearExecutableCache();
+
+    std::remove((directory + "/hidden").c_str());
+    std::remove((directory + "/tool").c_str());
+    rmdir(tempDir);
+}
+#endif
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(cpplocate_test, scratchDir)
+{
+    const char * names[] = { "XDG_RUNTIME_DIR", "TMPDIR" };
+    auto original = std::vector<std::pair<std::string, bool>>();
+
+    for (const auto name : names)
+    {
+        original.emplace_back(getenv(name) != nullptr ? getenv(name) : "", getenv(name) != nullptr);
+    }
+
+    char runtimeDir[] = "/tmp/cpplocate-test-XXXXXX";
+    char tmpDir[] = "/tmp/cpplocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(runtimeDir));
+    ASSERT_NE(nullptr, mkdtemp(tmpDir));
+
+    setenv("XDG_RUNTIME_DIR", runtimeDir, 1);
+    setenv("TMPDIR", tmpDir, 1);
+    cpplocate::refreshEnvironment();
+
+    // Fake filesystems: small memory-backed runtime directory, large local TMPDIR, everything else unavailable
+    auto probes = 0;
+    auto status = std::map<std::string, cpplocate::FilesystemStatus>{
+        { runtimeDir, { cpplocate::FilesystemKind::Memory, 1000, true } },
+        { tmpDir, { cpplocate::FilesystemKind::Local, 1000000, true } }
+    };
+
+    cpplocate::setFilesystemProbe([&status, &probes](const std::string & directory, cpplocate::FilesystemStatus & result)
+    {
+        ++probes;
+
+        const auto it = status.find(directory);
+
+        if (it == status.end())
+        {
+            return false;
+        }
+
+        result = it->second;
+        return true;
+    });
+
+    EXPECT_EQ(std::string(runtimeDir) + "/app", cpplocate::scratchDir("app", 100));
+    EXPECT_EQ(std::string(tmpDir) + "/app", cpplocate::scratchDir("app", 10000));
+    EXPECT_EQ("", cpplocate::scratchDir("app", 10000000));
+    EXPECT_EQ("", cpplocate::scratchDir("../app", 0));
+
+    struct stat info;
+    ASSERT_EQ(0, stat((std::string(runtimeDir) + "/app").c_str(), &info));
+    EXPECT_EQ(0700, info.st_mode & 0777);
+
+    // Decisions are cached
+    probes = 0;
+    status[runtimeDir].kind = cpplocate::FilesystemKind::Network;
+    EXPECT_EQ(std::string(runtimeDir) + "/app", cpplocate::scratchDir("app", 100));
+    EXPECT_EQ(0, probes);
+
+    // Network filesystems are used last
+    cpplocate::clearScratchDirCache();
+    EXPECT_EQ(std::string(tmpDir) + "/app", cpplocate::scratchDir("app", 100));
+
+    cpplocate::setScratchDirTimeToLive(std::chrono::seconds(0));
+    status[tmpDir].writable = false;
+    EXPECT_EQ(std::string(runtimeDir) + "/app", cpplocate::scratchDir("app", 100));
+
+    cpplocate::setScratchDirTimeToLive(std::chrono::seconds(60));
+    cpplocate::setFilesystemProbe(nullptr);
+
+    for (auto i = std::size_t(0); i < original.size(); ++i)
+    {
+        if (original[i].second)
+        {
+            setenv(names[i], original[i].first.c_str(), 1);
+        }
+        else
+        {
+            unsetenv(names[i]);
+        }
+    }
+
+    cpplocate::refreshEnvironment();
+
+    rmdir((std::string(runtimeDir) + "/app").c_str());
+    rmdir((std::string(tmpDir) + "/app").c_str());
+    rmdir(runtimeDir);
+    rmdir(tmpDir);
+}
+#endif
+
+#ifdef SYSTEM_LINUX
+TEST_F(cpplocate_test, filesystemInfo)
+{
+    const auto root = cpplocate::filesystemInfo("/");
+
+    ASSERT_TRUE(root.valid);
+    EXPECT_FALSE(root.type.empty());
+    EXPECT_EQ("/", root.mountPoint);
+    EXPECT_LT(0u, root.blockSize);
+    EXPECT_LE(root.freeBytes, root.totalBytes);
+
+    const auto proc = cpplocate::filesystemInfo("/proc/self");
+
+    ASSERT_TRUE(proc.valid);
+    EXPECT_EQ("proc", proc.type);
+    EXPECT_EQ("/proc", proc.mountPoint);
+
+    EXPECT_FALSE(cpplocate::filesystemInfo("/cpplocate-missing").valid);
+
+    const auto shm = cpplocate::filesystemInfo("/dev/shm");
+
+    if (shm.valid && shm.type == "tmpfs")
+    {
+        EXPECT_EQ(cpplocate::FilesystemKind::Memory, shm.kind);
+    }
+
+    cpplocate::clearFilesystemInfoCache();
+    EXPECT_EQ(root.type, cpplocate::filesystemInfo("/").type);
+}
+#endif
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(cpplocate_test, accessTrace)
+{
+    const auto home = std::string(getenv("HOME") != nullptr ? getenv("HOME") : "");
+
+    char tempHome[] = "/tmp/cpplocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempHome));
+    setenv("HOME", tempHome, 1);
+    cpplocate::refreshEnvironment();
+
+    const auto symbol = reinterpret_cast<void*>(cpplocate::getExecutablePath);
+    const auto traceFile = cpplocate::cacheDir("trace-test") + "/locate.trace";
+
+    EXPECT_EQ(cpplocate::AccessTraceMode::Recording, cpplocate::startAccessTrace("trace-test"));
+    const auto recorded = cpplocate::locatePath("source/version.h.in", "", symbol);
+    const auto recordedWithDepth = cpplocate::locatePath("source/tests", "", symbol, 8);
+    cpplocate::stopAccessTrace();
+
+    EXPECT_EQ(cpplocate::AccessTraceMode::Disabled, cpplocate::accessTraceMode());
+    EXPECT_TRUE(std::ifstream(traceFile).good());
+
+    // Queries with explicit depth are traced as well
+    std::ifstream stream(traceFile, std::ios::binary);
+    const auto contents = std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    EXPECT_NE(std::string::npos, contents.find("source/tests"));
+
+    EXPECT_EQ(cpplocate::AccessTraceMode::Replaying, cpplocate::startAccessTrace("trace-test"));
+    EXPECT_EQ(recorded, cpplocate::locatePath("source/version.h.in", "", symbol));
+    EXPECT_EQ(recordedWithDepth, cpplocate::locatePath("source/tests", "", symbol, 8));
+    const auto merged = cpplocate::locatePath("source/codegeneration", "", symbol);
+    cpplocate::stopAccessTrace();
+    cpplocate::waitForPrefetch();
+
+    // Queries new to the replayed trace are merged into it
+    std::ifstream mergedStream(traceFile, std::ios::binary);
+    const auto mergedContents = std::string(std::istreambuf_iterator<char>(mergedStream), std::istreambuf_iterator<char>());
+    EXPECT_NE(std::string::npos, mergedContents.find("source/codegeneration"));
+    EXPECT_NE(std::string::npos, mergedContents.find("source/version.h.in"));
+
+    EXPECT_EQ(cpplocate::AccessTraceMode::Replaying, cpplocate::startAccessTrace("trace-test"));
+    EXPECT_EQ(merged, cpplocate::locatePath("source/codegeneration", "", symbol));
+    cpplocate::stopAccessTrace();
+    cpplocate::waitForPrefetch();
+
+    // Replayed queries are located anew, the recorded result does not pin the resolution
+    const auto executable = cpplocate::getExecutablePath();
+    const auto directory = executable.substr(0, executable.rfind('/'));
+    const auto parent = directory.substr(0, directory.rfind('/'));
+    const auto probe = std::string("cpplocate-trace-probe");
+    std::ofstream(parent + "/" + probe) << "parent";
+
+    EXPECT_EQ(cpplocate::AccessTraceMode::Replaying, cpplocate::startAccessTrace("trace-test"));
+    const auto recordedProbe = cpplocate::locatePath(probe, "", symbol);
+    cpplocate::stopAccessTrace();
+    cpplocate::waitForPrefetch();
+
+    std::ofstream(directory + "/" + probe) << "directory";
+
+    EXPECT_EQ(cpplocate::AccessTraceMode::Replaying, cpplocate::startAccessTrace("trace-test"));
+    const auto replayedProbe = cpplocate::locatePath(probe, "", symbol);
+    cpplocate::stopAccessTrace();
+    cpplocate::waitForPrefetch();
+
+    EXPECT_NE(recordedProbe, replayedProbe);
+    EXPECT_EQ(cpplocate::locatePath(probe, "", symbol), replayedProbe);
+
+    std::remove((directory + "/" + probe).c_str());
+    std::remove((parent + "/" + probe).c_str());
+
+    // Corrupted traces are discarded
+    std::ofstream(traceFile, std::ios::trunc) << "garbage";
+    EXPECT_EQ(cpplocate::AccessTraceMode::Recording, cpplocate::startAccessTrace("trace-test"));
+    cpplocate::stopAccessTrace();
+
+    std::remove(traceFile.c_str());
+    rmdir(cpplocate::cacheDir("trace-test").c_str());
+    rmdir((std::string(tempHome) + "/.cache").c_str());
+    rmdir(tempHome);
+
+    setenv("HOME", home.c_str(), 1);
+    cpplocate::refreshEnvironment();
+}
+#endif
@@ -0,0 +1,12 @@
+
+#if defined(_WIN32)
+    #define PLUGIN_API __declspec(dllexport)
+#else
+    #define PLUGIN_API __attribute__((visibility("default")))
+#endif
+
+
+extern "C" PLUGIN_API int pluginBaseValue()
+{
+    return 42;
+}
@@ -0,0 +1,16 @@
+
+#if defined(_WIN32)
+    #define PLUGIN_API __declspec(dllexport)
+    #define PLUGIN_IMPORT __declspec(dllimport)
+#else
+    #define PLUGIN_API __attribute__((visibility("default")))
+    #define PLUGIN_IMPORT
+#endif
+
+
+extern "C" PLUGIN_IMPORT int pluginBaseValue();
+
+extern "C" PLUGIN_API int pluginDependentValue()
+{
+    return pluginBaseValue() + 1;
+}
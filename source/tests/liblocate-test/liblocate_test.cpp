@@ -1,4 +1,18 @@
 
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef SYSTEM_WINDOWS
+    #include <io.h>
+#else
+    #include <pwd.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 #include <gmock/gmock.h>
 
 #include <liblocate/liblocate.h>
@@ -12,6 +26,70 @@ public:
     }
 };
 
+/**
+*  @brief
+*    Bump allocator that counts allocations and releases
+*/
+struct CountingArena
+{
+    CountingArena()
+    : storage(1 << 16)
+    , used(0)
+    , allocations(0)
+    , releases(0)
+    , limit(~0u)
+    {
+    }
+
+    bool owns(const void * memory) const
+    {
+        return memory >= storage.data() && memory < storage.data() + storage.size();
+    }
+
+    static void * allocate(size_t size, void * userData)
+    {
+        auto arena = static_cast<CountingArena *>(userData);
+        const auto offset = (arena->used + 15) & ~size_t(15);
+
+        if (offset + size > arena->storage.size() || arena->allocations == arena->limit)
+        {
+            return nullptr;
+        }
+
+        arena->used = offset + size;
+        ++arena->allocations;
+
+        return arena->storage.data() + offset;
+    }
+
+    static void release(void * memory, void * userData)
+    {
+        auto arena = static_cast<CountingArena *>(userData);
+
+        EXPECT_TRUE(arena->owns(memory));
+        ++arena->releases;
+    }
+
+    std::vector<char> storage;
+    size_t used;
+    unsigned int allocations;
+    unsigned int releases;
+    unsigned int limit; ///< Number of allocations after which allocating fails
+};
+
+/**
+*  @brief
+*    Uninstalls all allocators when leaving the scope, also if an assertion fails
+*/
+struct AllocatorGuard
+{
+    ~AllocatorGuard()
+    {
+        setAllocator(nullptr, nullptr, nullptr);
+        setThreadAllocator(nullptr, nullptr, nullptr);
+    }
+};
+
 TEST_F(liblocate_test, getExecutablePath_NoReturn)
 {
     getExecutablePath(nullptr, nullptr);
@@ -174,6 +252,318 @@ TEST_F(liblocate_test, locatePath_ReturnNoSystemDir)
     free(path);
 }
 
+TEST_F(liblocate_test, locatePathWithDepth_Return)
+{
+    const char * relPath = "source/version.h.in";
+
+    char * path = nullptr;
+    unsigned int length = 0;
+
+    // The test executable resides in a direct subdirectory of the source tree
+    locatePathWithDepth(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath), 0);
+
+    EXPECT_EQ(0, length);
+    EXPECT_EQ(nullptr, path);
+
+    // Identical results with populated and cleared ancestor memo
+    for (int i = 0; i < 2; ++i)
+    {
+        locatePathWithDepth(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath), 8);
+
+        EXPECT_LT(0, length);
+        EXPECT_NE(nullptr, path);
+
+        free(path);
+
+        clearSearchCache();
+    }
+}
+
+TEST_F(liblocate_test, setSearchDepth)
+{
+    const unsigned int depth = getSearchDepth();
+
+    EXPECT_EQ(2, depth);
+
+    setSearchDepth(5);
+    EXPECT_EQ(5, getSearchDepth());
+
+    // Depths whose candidate length would overflow are clamped
+    setSearchDepth(0x55555556);
+    EXPECT_EQ(LocateMaxSearchDepth, getSearchDepth());
+
+    const char * relPath = "source/version.h.in";
+    char * path = nullptr;
+    unsigned int length = 0;
+
+    locatePath(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+    EXPECT_LT(0, length);
+    free(path);
+
+    locatePathWithDepth(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath), 0xFFFFFFFF);
+    EXPECT_LT(0, length);
+    free(path);
+
+    setSearchDepth(depth);
+}
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(liblocate_test, setSearchCacheTimeToLive)
+{
+    char * executablePath = nullptr;
+    unsigned int executablePathLength = 0;
+    getExecutablePath(&executablePath, &executablePathLength);
+
+    const auto executable = std::string(executablePath, executablePathLength);
+    const auto directory = executable.substr(0, executable.rfind('/')) + "/liblocate-search-cache";
+    const auto relPath = std::string("liblocate-search-cache");
+    const auto symbol = reinterpret_cast<void*>(getExecutablePath);
+    free(executablePath);
+
+    const auto locate = [&relPath, symbol]()
+    {
+        char * path = nullptr;
+        unsigned int length = 0;
+
+        locatePathWithDepth(&path, &length, relPath.c_str(), static_cast<unsigned int>(relPath.size()), nullptr, 0, symbol, 8);
+
+        const auto result = path != nullptr ? std::string(path, length) : std::string();
+        free(path);
+
+        return result;
+    };
+
+    rmdir(directory.c_str());
+    clearSearchCache();
+
+    // Without time to live, directories created after a miss are found,
+    // and found entries removed meanwhile are rejected by probing
+    EXPECT_EQ("", locate());
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0700));
+    EXPECT_NE("", locate());
+    ASSERT_EQ(0, rmdir(directory.c_str()));
+    EXPECT_EQ("", locate());
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0700));
+    EXPECT_NE("", locate());
+    ASSERT_EQ(0, rmdir(directory.c_str()));
+
+    // Memoized misses are kept until the time to live expires or the cache is cleared
+    clearSearchCache();
+    setSearchCacheTimeToLive(60000);
+
+    EXPECT_EQ("", locate());
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0700));
+    EXPECT_EQ("", locate());
+
+    clearSearchCache();
+    const auto found = locate();
+    EXPECT_NE("", found);
+
+    // Found entries are confirmed by probing
+    ASSERT_EQ(0, rmdir(directory.c_str()));
+    EXPECT_EQ("", locate());
+
+    setSearchCacheTimeToLive(1);
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0700));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(found, locate());
+
+    rmdir(directory.c_str());
+    setSearchCacheTimeToLive(0);
+    clearSearchCache();
+}
+#endif
+
+TEST_F(liblocate_test, locatePath_Normalized)
+{
+    const char * relPath = "source/version.h.in";
+
+    char * path = nullptr;
+    unsigned int length = 0;
+
+    setNormalizedResults(1);
+    locatePath(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+    setNormalizedResults(0);
+
+    ASSERT_LT(0, length);
+    EXPECT_EQ(std::string::npos, std::string(path, length).find("/../"));
+    EXPECT_EQ('/', path[length - 1]);
+
+    free(path);
+}
+
+TEST_F(liblocate_test, normalizePaths)
+{
+    char paths[] = "/a/b/../c\0./x/\0/y//z/.";
+    unsigned int lengths[] = { 9, 4, 7 };
+
+    normalizePaths(paths, lengths, 3);
+
+    EXPECT_EQ(4, lengths[0]);
+    EXPECT_STREQ("/a/c", paths);
+    EXPECT_EQ(2, lengths[1]);
+    EXPECT_STREQ("x/", paths + 5);
+    EXPECT_EQ(4, lengths[2]);
+    EXPECT_STREQ("/y/z", paths + 8);
+}
+
+TEST_F(liblocate_test, getCanonicalLibraryPath_Return)
+{
+    char * path = nullptr;
+    unsigned int length = 0;
+
+    getCanonicalLibraryPath(reinterpret_cast<void*>(getExecutablePath), &path, &length);
+
+    ASSERT_LT(0, length);
+    EXPECT_NE(nullptr, path);
+    EXPECT_EQ(std::string::npos, std::string(path, length).find("/../"));
+
+    free(path);
+
+    getCanonicalLibraryPath(nullptr, &path, &length);
+
+    EXPECT_EQ(0, length);
+    EXPECT_EQ(nullptr, path);
+}
+
+TEST_F(liblocate_test, locateCanonicalPath_Return)
+{
+    const char * relPath = "source/version.h.in";
+
+    char * path = nullptr;
+    unsigned int length = 0;
+
+    locateCanonicalPath(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+
+    ASSERT_LT(0, length);
+    EXPECT_EQ('/', path[length - 1]);
+    EXPECT_EQ(std::string::npos, std::string(path, length).find("/../"));
+    EXPECT_TRUE(std::ifstream(std::string(path, length) + relPath).good());
+
+    free(path);
+}
+
+TEST_F(liblocate_test, pathArenas)
+{
+    char paths[] = "C:\\dev\\include\\tuple\0file.txt\0/usr/include/c++/v1/tuple";
+    const unsigned int lengths[] = { 20, 8, 25 };
+    unsigned int directoryLengths[] = { 0, 0, 0 };
+    unsigned char matches[] = { 2, 2, 2 };
+
+    unifyPaths(paths, lengths, 3);
+
+    EXPECT_STREQ("C:/dev/include/tuple", paths);
+    EXPECT_STREQ("file.txt", paths + 21);
+    EXPECT_STREQ("/usr/include/c++/v1/tuple", paths + 30);
+
+    getDirectoryParts(paths, lengths, 3, directoryLengths);
+
+    EXPECT_EQ(14, directoryLengths[0]); // "C:/dev/include"
+    EXPECT_EQ(8, directoryLengths[1]); // "file.txt"
+    EXPECT_EQ(19, directoryLengths[2]); // "/usr/include/c++/v1"
+
+    matchPathPrefix(paths, lengths, 3, "/usr/", 5, matches);
+
+    EXPECT_EQ(0, matches[0]);
+    EXPECT_EQ(0, matches[1]);
+    EXPECT_EQ(1, matches[2]);
+}
+
+TEST_F(liblocate_test, locateAllPaths_NoReturn)
+{
+    const char * relPath = "source/version.h.in";
+
+    locateAllPaths(nullptr, nullptr, nullptr, nullptr, relPath, strlen(relPath), nullptr, 0, nullptr);
+
+    SUCCEED();
+}
+
+TEST_F(liblocate_test, locateAllPaths_Return)
+{
+    char * paths = 0x0;
+    unsigned int * lengths = 0x0;
+    unsigned char * stages = 0x0;
+    unsigned int count = 0;
+
+    char * path = 0x0;
+    unsigned int length = 0;
+
+    const char * relPath = "source/version.h.in";
+
+    locateAllPaths(&paths, &lengths, &stages, &count, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+    locatePath(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+
+    ASSERT_LT(0, count);
+    ASSERT_FALSE(paths == 0x0);
+    ASSERT_FALSE(lengths == 0x0);
+    ASSERT_FALSE(stages == 0x0);
+
+    // First match equals the result of locatePath
+    EXPECT_EQ(length, lengths[0]);
+    EXPECT_STREQ(path, paths);
+
+    // Paths are stored as consecutive null-terminated strings
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(lengths[i], strlen(paths + offset));
+        EXPECT_GE(LocateStageBundleResources, stages[i]);
+        offset += lengths[i] + 1;
+    }
+
+    free(path);
+    free(paths);
+    free(lengths);
+    free(stages);
+}
+
+TEST_F(liblocate_test, locateAllPaths_Missing)
+{
+    char * paths = 0x0;
+    unsigned int * lengths = 0x0;
+    unsigned char * stages = 0x0;
+    unsigned int count = 10;
+
+    const char * relPath = "source/does-not-exist.txt";
+
+    locateAllPaths(&paths, &lengths, &stages, &count, relPath, strlen(relPath), nullptr, 0, nullptr);
+
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(nullptr, paths);
+}
+
+TEST_F(liblocate_test, openLocatedFile_Return)
+{
+    char * path = 0x0;
+    unsigned int length = 0;
+
+    const char * relPath = "source/version.h.in";
+
+    const int fd = openLocatedFile(&path, &length, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+
+    ASSERT_LE(0, fd);
+    EXPECT_LT(0, length);
+    ASSERT_FALSE(path == 0x0);
+    EXPECT_EQ(length, strlen(path));
+
+#ifdef SYSTEM_WINDOWS
+    _close(fd);
+#else
+    close(fd);
+#endif
+
+    free(path);
+}
+
+TEST_F(liblocate_test, openLocatedFile_Missing)
+{
+    const char * relPath = "source/does-not-exist.txt";
+
+    const int fd = openLocatedFile(nullptr, nullptr, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void*>(getExecutablePath));
+
+    EXPECT_EQ(-1, fd);
+}
+
 TEST_F(liblocate_test, pathSeparator_NoReturn)
 {
     pathSeparator(nullptr);
@@ -305,6 +695,244 @@ TEST_F(liblocate_test, libExtensions_Return)
     free(extensions);
 }
 
+TEST_F(liblocate_test, setAllocator)
+{
+    CountingArena arena;
+    AllocatorGuard guard;
+
+    setAllocator(&CountingArena::allocate, &CountingArena::release, &arena);
+
+    char * executablePath = 0x0;
+    unsigned int executablePathLength = 0;
+    getExecutablePath(&executablePath, &executablePathLength);
+
+    ASSERT_FALSE(executablePath == 0x0);
+    EXPECT_TRUE(arena.owns(executablePath));
+    EXPECT_EQ(executablePathLength, strlen(executablePath));
+    EXPECT_EQ(1u, arena.allocations);
+
+    // Temporaries of a call are allocated and released with the allocator as well
+    const char * relPath = "source/version.h.in";
+    char * path = 0x0;
+    unsigned int pathLength = 0;
+    locatePath(&path, &pathLength, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void *>(getExecutablePath));
+
+    ASSERT_FALSE(path == 0x0);
+    EXPECT_TRUE(arena.owns(path));
+    EXPECT_LT(2u, arena.allocations);
+
+    // Results that are grown internally are handed over in arena memory
+    char * paths = 0x0;
+    unsigned int * lengths = 0x0;
+    unsigned char * stages = 0x0;
+    unsigned int count = 0;
+    locateAllPaths(&paths, &lengths, &stages, &count, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void *>(getExecutablePath));
+
+    ASSERT_LT(0u, count);
+    EXPECT_TRUE(arena.owns(paths));
+    EXPECT_TRUE(arena.owns(lengths));
+    EXPECT_TRUE(arena.owns(stages));
+    EXPECT_EQ(pathLength, lengths[0]);
+
+    char ** extensions = 0x0;
+    unsigned int * extensionLengths = 0x0;
+    unsigned int extensionCount = 0;
+    libExtensions(&extensions, &extensionLengths, &extensionCount);
+
+    ASSERT_LT(0u, extensionCount);
+    EXPECT_TRUE(arena.owns(extensions));
+    EXPECT_TRUE(arena.owns(extensionLengths));
+    EXPECT_TRUE(arena.owns(extensions[0]));
+
+    // Results are released with the allocator they stem from, even after it was replaced
+    setAllocator(nullptr, nullptr, nullptr);
+
+    char * systemPath = 0x0;
+    getExecutablePath(&systemPath, nullptr);
+
+    ASSERT_FALSE(systemPath == 0x0);
+    EXPECT_FALSE(arena.owns(systemPath));
+
+    releaseMemory(systemPath);
+    releaseMemory(executablePath);
+    releaseMemory(path);
+    releaseMemory(paths);
+    releaseMemory(lengths);
+    releaseMemory(stages);
+
+    for (unsigned int i = 0; i < extensionCount; ++i)
+    {
+        releaseMemory(extensions[i]);
+    }
+
+    releaseMemory(extensions);
+    releaseMemory(extensionLengths);
+    releaseMemory(nullptr);
+
+    EXPECT_EQ(arena.allocations, arena.releases);
+}
+
+TEST_F(liblocate_test, setThreadAllocator)
+{
+    CountingArena arena;
+    AllocatorGuard guard;
+
+    setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &arena);
+
+    char * dir = 0x0;
+    unsigned int dirLength = 0;
+    configDir(&dir, &dirLength, "app", 3);
+
+    ASSERT_FALSE(dir == 0x0);
+    EXPECT_TRUE(arena.owns(dir));
+
+    // Other threads keep using the process-wide allocator
+    char * otherDir = 0x0;
+    std::thread([&otherDir]()
+    {
+        configDir(&otherDir, nullptr, "app", 3);
+    }).join();
+
+    ASSERT_FALSE(otherDir == 0x0);
+    EXPECT_FALSE(arena.owns(otherDir));
+    EXPECT_STREQ(dir, otherDir);
+
+    setThreadAllocator(nullptr, nullptr, nullptr);
+
+    releaseMemory(dir);
+    releaseMemory(otherDir);
+
+    EXPECT_EQ(arena.allocations, arena.releases);
+
+    // Failing allocations result in invalidated out-parameters
+    CountingArena exhausted;
+    exhausted.used = exhausted.storage.size();
+
+    setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &exhausted);
+
+    dirLength = 1;
+    libPrefix(&dir, &dirLength);
+
+    setThreadAllocator(nullptr, nullptr, nullptr);
+
+    EXPECT_TRUE(dir == 0x0);
+    EXPECT_EQ(0u, dirLength);
+
+    // If one of the buffers of locateAllPaths cannot be handed over, no paths are reported
+    const char * relPath = "source/version.h.in";
+    char * paths = 0x0;
+    unsigned int * lengths = 0x0;
+    unsigned char * stages = 0x0;
+    unsigned int count = 0;
+
+    CountingArena counting;
+    setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &counting);
+    locateAllPaths(&paths, &lengths, &stages, &count, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void *>(getExecutablePath));
+    setThreadAllocator(nullptr, nullptr, nullptr);
+
+    ASSERT_LT(0u, count);
+    releaseMemory(paths);
+    releaseMemory(lengths);
+    releaseMemory(stages);
+
+    // The buffers are handed over last, so the final allocation is the one of the stages
+    CountingArena limited;
+    limited.limit = counting.allocations - 1;
+
+    setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &limited);
+    locateAllPaths(&paths, &lengths, &stages, &count, relPath, strlen(relPath), nullptr, 0, reinterpret_cast<void *>(getExecutablePath));
+    setThreadAllocator(nullptr, nullptr, nullptr);
+
+    EXPECT_EQ(0u, count);
+    EXPECT_TRUE(paths == 0x0);
+    EXPECT_TRUE(lengths == 0x0);
+    EXPECT_TRUE(stages == 0x0);
+    EXPECT_EQ(limited.allocations, limited.releases);
+}
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(liblocate_test, setThreadAllocator_Failing)
+{
+    const auto home = std::string(getenv("HOME") != nullptr ? getenv("HOME") : "");
+    const auto configHome = getenv("XDG_CONFIG_HOME");
+    const auto configHomeValue = std::string(configHome != nullptr ? configHome : "");
+
+    // Compose the config directory from HOME
+    setenv("HOME", "/tmp/liblocate-home", 1);
+    unsetenv("XDG_CONFIG_HOME");
+    refreshEnvironment();
+
+    {
+        AllocatorGuard guard;
+
+        // Count the allocations of successful calls, then let each of them fail in turn
+        CountingArena counting;
+        setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &counting);
+
+        char ** extensions = nullptr;
+        unsigned int * extensionLengths = nullptr;
+        unsigned int extensionCount = 0;
+        libExtensions(&extensions, &extensionLengths, &extensionCount);
+        const auto extensionAllocations = counting.allocations;
+
+        char * dir = nullptr;
+        unsigned int dirLength = 0;
+        configDir(&dir, &dirLength, "app", 3);
+        const auto configAllocations = counting.allocations - extensionAllocations;
+
+        ASSERT_LT(0u, extensionCount);
+        ASSERT_FALSE(dir == nullptr);
+
+        for (auto i = 0u; i < extensionCount; ++i)
+        {
+            releaseMemory(extensions[i]);
+        }
+
+        releaseMemory(extensions);
+        releaseMemory(extensionLengths);
+        releaseMemory(dir);
+
+        for (auto limit = 0u; limit < extensionAllocations; ++limit)
+        {
+            CountingArena limited;
+            limited.limit = limit;
+            setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &limited);
+
+            extensionCount = 1;
+            libExtensions(&extensions, &extensionLengths, &extensionCount);
+
+            EXPECT_TRUE(extensions == nullptr) << limit;
+            EXPECT_TRUE(extensionLengths == nullptr) << limit;
+            EXPECT_EQ(0u, extensionCount) << limit;
+            EXPECT_EQ(limited.allocations, limited.releases) << limit;
+        }
+
+        for (auto limit = 0u; limit < configAllocations; ++limit)
+        {
+            CountingArena limited;
+            limited.limit = limit;
+            setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &limited);
+
+            dirLength = 1;
+            configDir(&dir, &dirLength, "app", 3);
+
+            EXPECT_TRUE(dir == nullptr) << limit;
+            EXPECT_EQ(0u, dirLength) << limit;
+            EXPECT_EQ(limited.allocations, limited.releases) << limit;
+        }
+    }
+
+    setenv("HOME", home.c_str(), 1);
+
+    if (configHome != nullptr)
+    {
+        setenv("XDG_CONFIG_HOME", configHomeValue.c_str(), 1);
+    }
+
+    refreshEnvironment();
+}
+#endif
+
 TEST_F(liblocate_test, homeDir)
 {
     char * dir;
@@ -317,3 +945,134 @@ TEST_F(liblocate_test, homeDir)
 
     free(dir);
 }
+
+#ifdef SYSTEM_LINUX
+TEST_F(liblocate_test, baseDirectories)
+{
+    const char * names[] = { "HOME", "XDG_CONFIG_HOME", "XDG_DATA_HOME", "XDG_CACHE_HOME", "XDG_STATE_HOME", "XDG_RUNTIME_DIR", "TMPDIR" };
+    auto original = std::vector<std::pair<std::string, bool>>();
+
+    for (const auto name : names)
+    {
+        original.emplace_back(getenv(name) != nullptr ? getenv(name) : "", getenv(name) != nullptr);
+        unsetenv(name);
+    }
+
+    const auto query = [](void (*function)(char **, unsigned int *, const char *, unsigned int))
+    {
+        char * dir = nullptr;
+        unsigned int length = 0;
+
+        function(&dir, &length, "app", 3);
+
+        const auto result = dir != nullptr ? std::string(dir, length) : std::string();
+        free(dir);
+
+        return result;
+    };
+
+    setenv("HOME", "/home/user", 1);
+    setenv("XDG_CONFIG_HOME", "/xdg/config", 1);
+    setenv("XDG_CACHE_HOME", "relative/cache", 1); // Relative paths are ignored
+    setenv("TMPDIR", "/tmp/user/", 1);
+    refreshEnvironment();
+
+    EXPECT_EQ("/xdg/config/app", query(configDir));
+    EXPECT_EQ("/xdg/config/app", query(roamingDir));
+    EXPECT_EQ("/home/user/.local/share/app", query(dataDir));
+    EXPECT_EQ("/home/user/.local/share/app", query(localDir));
+    EXPECT_EQ("/home/user/.cache/app", query(cacheDir));
+    EXPECT_EQ("/home/user/.local/state/app", query(stateDir));
+    EXPECT_EQ("/tmp/user/app", query(tempDir));
+    EXPECT_EQ("/tmp/user/app", query(runtimeDir));
+
+    setenv("XDG_DATA_HOME", "/xdg/data", 1);
+    setenv("XDG_CACHE_HOME", "/xdg/cache", 1);
+    setenv("XDG_STATE_HOME", "/xdg/state", 1);
+    setenv("XDG_RUNTIME_DIR", "/run/user/1000", 1);
+    unsetenv("TMPDIR");
+    refreshEnvironment();
+
+    EXPECT_EQ("/xdg/data/app", query(dataDir));
+    EXPECT_EQ("/xdg/cache/app", query(cacheDir));
+    EXPECT_EQ("/xdg/state/app", query(stateDir));
+    EXPECT_EQ("/run/user/1000/app", query(runtimeDir));
+    EXPECT_EQ("/tmp/app", query(tempDir));
+
+    for (auto i = std::size_t(0); i < original.size(); ++i)
+    {
+        if (original[i].second)
+        {
+            setenv(names[i], original[i].first.c_str(), 1);
+        }
+        else
+        {
+            unsetenv(names[i]);
+        }
+    }
+
+    refreshEnvironment();
+}
+#endif
+
+#ifndef SYSTEM_WINDOWS
+TEST_F(liblocate_test, homeDir_Environment)
+{
+    const auto home = std::string(getenv("HOME") != nullptr ? getenv("HOME") : "");
+
+    char * dir;
+    unsigned int length;
+
+    // HOME takes precedence over the user database
+    setenv("HOME", "/tmp/liblocate-home", 1);
+    refreshEnvironment();
+    homeDir(&dir, &length);
+    EXPECT_EQ("/tmp/liblocate-home", std::string(dir, length));
+    free(dir);
+
+    configDir(&dir, &length, "app", 3);
+    EXPECT_EQ(0u, std::string(dir, length).find("/tmp/liblocate-home/"));
+    free(dir);
+
+    // Without HOME, the user database entry is used (and cached)
+    unsetenv("HOME");
+    refreshEnvironment();
+    clearHomeDirCache();
+
+    char buffer[16384];
+    struct passwd entry;
+    struct passwd * result = nullptr;
+    const auto expected = getpwuid_r(getuid(), &entry, buffer, sizeof(buffer), &result) == 0 && result != nullptr
+        ? std::string(result->pw_dir) : std::string();
+
+    for (auto i = 0; i < 2; ++i)
+    {
+        homeDir(&dir, &length);
+        EXPECT_EQ(expected, dir != nullptr ? std::string(dir, length) : std::string());
+        free(dir);
+    }
+
+    // Both paths allocate the result only, HOME and the database entry are not copied
+    {
+        CountingArena arena;
+        AllocatorGuard guard;
+
+        setThreadAllocator(&CountingArena::allocate, &CountingArena::release, &arena);
+
+        homeDir(&dir, &length);
+        EXPECT_EQ(expected.empty() ? 0u : 1u, arena.allocations);
+        releaseMemory(dir);
+
+        setenv("HOME", "/tmp/liblocate-home", 1);
+        refreshEnvironment();
+
+        homeDir(&dir, &length);
+        EXPECT_EQ(expected.empty() ? 1u : 2u, arena.allocations);
+        releaseMemory(dir);
+    }
+
+    setenv("HOME", home.c_str(), 1);
+    refreshEnvironment();
+    clearHomeDirCache();
+}
+#endif
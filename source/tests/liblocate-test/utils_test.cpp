@@ -1,11 +1,50 @@
 
 #include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef SYSTEM_WINDOWS
+    #include <climits>
+    #include <fstream>
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif
 
 #include <gmock/gmock.h>
 
 #include "../../liblocate/source/utils.h"
 
 
+namespace
+{
+
+
+// Straightforward reference: for each pattern in priority order, take its rightmost occurrence
+unsigned int referenceSystemBasePath(const std::string & path, const std::vector<std::string> & prefixes)
+{
+    const char * subdirs[] = { "bin", "lib", "lib32", "lib64" };
+
+    for (const auto & prefix : prefixes)
+    {
+        for (const auto subdir : subdirs)
+        {
+            const auto pattern = prefix + "/" + subdir + "/";
+            const auto pos = path.rfind(pattern);
+
+            if (pos != std::string::npos)
+            {
+                return static_cast<unsigned int>(pos + prefix.size() + 1);
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+} // namespace
+
+
 class utils_test : public testing::Test
 {
 public:
@@ -14,6 +53,66 @@ public:
     }
 };
 
+TEST_F(utils_test, pathScan_Level)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    // SSE2 is part of x86-64, so the vectorized primitives are always dispatched there
+    EXPECT_LE(PATH_SCAN_SSE2, pathScanLevel());
+#endif
+
+    EXPECT_GE(PATH_SCAN_AVX2, pathScanLevel());
+}
+
+TEST_F(utils_test, pathScan_MatchesScalar)
+{
+    const char alphabet[] = { '/', '\\', 'a', 'b', '.', ':', '\0', '\x80', '\xff' };
+    const auto alphabetSize = sizeof(alphabet) / sizeof(alphabet[0]);
+
+    auto seed = 42u;
+    const auto random = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+
+    for (auto iteration = 0; iteration < 20000; ++iteration)
+    {
+        // Random length and misalignment, delimiters dense or sparse
+        const auto length = random() % 300;
+        const auto offset = random() % 32;
+        const auto sparse = random() % 2 == 0;
+
+        auto buffer = std::vector<char>(offset + length + 1);
+        auto other = std::vector<char>(offset + length + 1);
+
+        for (auto i = 0u; i < length; ++i)
+        {
+            buffer[offset + i] = sparse && random() % 64 != 0 ? 'x' : alphabet[random() % alphabetSize];
+        }
+
+        // Second string shares a random prefix
+        const auto shared = random() % (length + 1);
+        for (auto i = 0u; i < length; ++i)
+        {
+            other[offset + i] = i < shared ? buffer[offset + i] : static_cast<char>(buffer[offset + i] + 1);
+        }
+
+        const char * path = buffer.data() + offset;
+        const auto expectedDelimiter = findLastPathDelimiterAt(PATH_SCAN_SCALAR, path, length);
+        const auto expectedPrefix = commonPrefixLengthAt(PATH_SCAN_SCALAR, path, other.data() + offset, length);
+
+        auto expectedUnified = buffer;
+        unifyPathDelimitersAt(PATH_SCAN_SCALAR, expectedUnified.data() + offset, length);
+
+        for (auto level = PATH_SCAN_SSE2; level <= pathScanLevel(); ++level)
+        {
+            ASSERT_EQ(expectedDelimiter, findLastPathDelimiterAt(level, path, length)) << level;
+            ASSERT_EQ(expectedPrefix, commonPrefixLengthAt(level, path, other.data() + offset, length)) << level;
+
+            auto unified = buffer;
+            unifyPathDelimitersAt(level, unified.data() + offset, length);
+
+            ASSERT_EQ(expectedUnified, unified) << level;
+        }
+    }
+}
+
 TEST_F(utils_test, unifiedPath_EmptyPath)
 {
     unifyPathDelimiters(nullptr, 0);
@@ -75,6 +174,53 @@ TEST_F(utils_test, unifiedPath_WindowsPath)
     free(actual);
 }
 
+TEST_F(utils_test, normalizePath_EmptyPath)
+{
+    unsigned int newLength = 10;
+
+    normalizePath(nullptr, 0, &newLength);
+
+    EXPECT_EQ(0, newLength); // ""
+}
+
+TEST_F(utils_test, normalizePath_UnixPath)
+{
+    char source[] = "/opt/app/lib//./../../share/app/";
+    const unsigned int length = strlen(source);
+    unsigned int newLength = 0;
+
+    normalizePath(source, length, &newLength);
+
+    EXPECT_EQ("/opt/share/app/", std::string(source, newLength));
+}
+
+TEST_F(utils_test, normalizePath_WindowsPath)
+{
+    char source[] = "C:\\dev\\..\\..\\include\\.\\tuple";
+    const unsigned int length = strlen(source);
+    unsigned int newLength = 0;
+
+    normalizePath(source, length, &newLength);
+
+    EXPECT_EQ("C:/include/tuple", std::string(source, newLength));
+}
+
+TEST_F(utils_test, normalizePath_RelativePath)
+{
+    const char * sources[] = { "a/../../b/", "./a/..", "../a/./b/../c", "//server/share/../x", "a//b" };
+    const char * expected[] = { "../b/", ".", "../a/c", "//server/x", "a/b" };
+
+    for (auto i = 0u; i < sizeof(sources) / sizeof(sources[0]); ++i)
+    {
+        auto source = std::string(sources[i]);
+        unsigned int newLength = 0;
+
+        normalizePath(&source[0], static_cast<unsigned int>(source.size()), &newLength);
+
+        EXPECT_EQ(expected[i], source.substr(0, newLength));
+    }
+}
+
 TEST_F(utils_test, getDirectoryPath_EmptyPath)
 {
     unsigned int newLength = 10;
@@ -188,6 +334,106 @@ TEST_F(utils_test, getSystemBasePath_ChrootPath)
     EXPECT_EQ(32, newLength); // "/home/user/dev/deploy/usr/local/"
 }
 
+TEST_F(utils_test, getSystemBasePath_OverlappingPath)
+{
+    const char * source = "/opt/usr/lib/lib/cpplocate";
+    const unsigned int length = strlen(source);
+    unsigned int newLength = 0;
+
+    getSystemBasePath(source, length, &newLength);
+
+    EXPECT_EQ(9, newLength); // "/opt/usr/"
+}
+
+TEST_F(utils_test, getSystemBasePath_CustomPrefix)
+{
+    const char * source = "/opt/vendor/lib64/cpplocate";
+    const unsigned int length = strlen(source);
+    unsigned int newLength = 0;
+
+    getSystemBasePath(source, length, &newLength);
+
+    EXPECT_EQ(0, newLength); // ""
+
+    addSystemBasePrefix("/opt/vendor/", 12);
+    getSystemBasePath(source, length, &newLength);
+
+    EXPECT_EQ(12, newLength); // "/opt/vendor/"
+
+    resetSystemBasePrefixes();
+    getSystemBasePath(source, length, &newLength);
+
+    EXPECT_EQ(0, newLength); // ""
+}
+
+TEST_F(utils_test, getSystemBasePath_MatchesReference)
+{
+    const char * components[] = { "usr", "local", "bin", "lib", "lib32", "lib64", "opt", "vendor", "x" };
+    const auto componentCount = sizeof(components) / sizeof(components[0]);
+    const auto prefixes = std::vector<std::string>{ "/usr", "/usr/local", "/opt/vendor" };
+
+    addSystemBasePrefix("/opt/vendor", 11);
+
+    // All paths of up to five components
+    auto paths = std::vector<std::string>{ "/" };
+
+    for (auto begin = std::size_t(0), depth = std::size_t(0); depth < 5; ++depth)
+    {
+        const auto end = paths.size();
+
+        for (auto i = begin; i < end; ++i)
+        {
+            for (auto c = std::size_t(0); c < componentCount; ++c)
+            {
+                paths.push_back(paths[i] + components[c] + "/");
+            }
+        }
+
+        begin = end;
+    }
+
+    for (const auto & path : paths)
+    {
+        unsigned int newLength = 0;
+
+        getSystemBasePath(path.c_str(), static_cast<unsigned int>(path.size()), &newLength);
+
+        ASSERT_EQ(referenceSystemBasePath(path, prefixes), newLength) << path;
+    }
+
+    resetSystemBasePrefixes();
+}
+
+TEST_F(utils_test, getSystemBasePath_ManyPrefixes)
+{
+    auto prefixes = std::vector<std::string>{ "/usr", "/usr/local" };
+
+    // Overlapping prefixes of varying depth, all compiled into one automaton
+    for (auto i = 0; i < 200; ++i)
+    {
+        const auto prefix = "/opt/v" + std::to_string(i % 20) + (i >= 20 ? "/p" + std::to_string(i) : std::string());
+
+        addSystemBasePrefix(prefix.c_str(), static_cast<unsigned int>(prefix.size()));
+        prefixes.push_back(prefix);
+    }
+
+    const std::string paths[] = {
+        "/opt/v7/lib/app", "/opt/v7/p27/bin/app", "/opt/v7/p28/bin/app", "/chroot/opt/v19/p199/lib64/x",
+        "/opt/v3/lib/opt/v4/p44/lib32/", "/usr/local/lib/opt/v1/bin/", "/opt/v20/lib/", "/opt/v1/p21/share/"
+    };
+
+    for (const auto & path : paths)
+    {
+        unsigned int newLength = 0;
+
+        getSystemBasePath(path.c_str(), static_cast<unsigned int>(path.size()), &newLength);
+
+        EXPECT_EQ(referenceSystemBasePath(path, prefixes), newLength) << path;
+    }
+
+    resetSystemBasePrefixes();
+}
+
 TEST_F(utils_test, getEnv_NoName)
 {
     char * value = nullptr;
@@ -255,6 +501,70 @@ TEST_F(utils_test, getEnv_Value)
 #endif
 }
 
+#ifndef SYSTEM_WINDOWS
+TEST_F(utils_test, getEnvView_Snapshot)
+{
+    const char * names[] = {
+        "HOME", "HOMEDRIVE", "HOMEPATH", "USERPROFILE", "APPDATA", "LOCALAPPDATA",
+        "XDG_CONFIG_HOME", "XDG_CONFIG_DIRS", "XDG_DATA_HOME", "XDG_DATA_DIRS",
+        "XDG_CACHE_HOME", "XDG_STATE_HOME", "XDG_RUNTIME_DIR",
+        "TMPDIR", "TEMP", "TMP", "PATH", "PATHEXT", "LIBLOCATE_SYSTEM_PREFIXES"
+    };
+
+    auto original = std::vector<std::pair<std::string, bool>>();
+
+    // Each variable has its own slot
+    for (const auto name : names)
+    {
+        original.emplace_back(getenv(name) != nullptr ? getenv(name) : "", getenv(name) != nullptr);
+        setenv(name, name, 1);
+    }
+
+    refreshEnvironmentSnapshot();
+
+    for (const auto name : names)
+    {
+        unsigned int length = 0;
+        const auto value = getEnvView(name, strlen(name), &length);
+
+        ASSERT_NE(nullptr, value);
+        EXPECT_EQ(std::string(name), std::string(value, length));
+        EXPECT_EQ('\0', value[length]);
+    }
+
+    EXPECT_EQ(nullptr, getEnvView("CPPLOCATE_DISPLAY", 17, nullptr));
+    EXPECT_EQ(nullptr, getEnvView("HOM", 3, nullptr));
+
+    // Changes become visible on refresh only
+    setenv("TMPDIR", "/tmp/changed", 1);
+    const auto previous = getEnvView("TMPDIR", 6, nullptr);
+    EXPECT_STREQ("TMPDIR", previous);
+
+    refreshEnvironmentSnapshot();
+    EXPECT_STREQ("/tmp/changed", getEnvView("TMPDIR", 6, nullptr));
+    EXPECT_STREQ("TMPDIR", previous);
+
+    // Refreshing without changes keeps the current snapshot
+    const auto current = getEnvView("TMPDIR", 6, nullptr);
+    refreshEnvironmentSnapshot();
+    EXPECT_EQ(current, getEnvView("TMPDIR", 6, nullptr));
+
+    for (auto i = std::size_t(0); i < original.size(); ++i)
+    {
+        if (original[i].second)
+        {
+            setenv(names[i], original[i].first.c_str(), 1);
+        }
+        else
+        {
+            unsetenv(names[i]);
+        }
+    }
+
+    refreshEnvironmentSnapshot();
+}
+#endif
+
 TEST_F(utils_test, fileExists_NoPath)
 {
     const auto result = fileExists(nullptr, 0);
@@ -269,3 +579,133 @@ TEST_F(utils_test, fileExists_EmptyPath)
 
     ASSERT_FALSE(result);
 }
+
+#ifndef SYSTEM_WINDOWS
+
+TEST_F(utils_test, canonicalPath_NestedLinks)
+{
+    char tempDir[] = "/tmp/liblocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDir));
+
+    const auto root = std::string(tempDir);
+
+    mkdir((root + "/a").c_str(), 0755);
+    mkdir((root + "/a/b").c_str(), 0755);
+    mkdir((root + "/a/b/c").c_str(), 0755);
+    std::ofstream(root + "/a/b/c/file") << "file";
+
+    ASSERT_EQ(0, symlink("a", (root + "/l1").c_str()));
+    ASSERT_EQ(0, symlink("b/c", (root + "/a/l2").c_str()));
+    ASSERT_EQ(0, symlink("../../l1/l2", (root + "/a/b/l3").c_str()));
+    ASSERT_EQ(0, symlink((root + "/l1/b").c_str(), (root + "/abs").c_str()));
+    ASSERT_EQ(0, symlink("loop", (root + "/loop").c_str()));
+
+    const char * paths[] = { "/a/b/c/file", "/l1/l2/file", "/l1/b/l3/file", "/abs/l3/../c/./file", "//abs//l3", "/l1/b/l3/.." };
+
+    // Resolve twice, with empty and with populated cache
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        for (const auto path : paths)
+        {
+            const auto fullPath = root + path;
+
+            char expected[PATH_MAX];
+            ASSERT_NE(nullptr, realpath(fullPath.c_str(), expected)) << fullPath;
+
+            char * canonical = nullptr;
+            unsigned int canonicalLength = 0;
+
+            canonicalPath(fullPath.c_str(), static_cast<unsigned int>(fullPath.size()), &canonical, &canonicalLength);
+
+            EXPECT_EQ(std::string(expected), std::string(canonical, canonicalLength)) << fullPath;
+
+            free(canonical);
+        }
+    }
+
+    // Missing entries and link loops are not resolved
+    const std::string invalid[] = { root + "/missing", root + "/loop", root + "/l1/l2/file/x" };
+
+    for (const auto & path : invalid)
+    {
+        char * canonical = nullptr;
+        unsigned int canonicalLength = 10;
+
+        canonicalPath(path.c_str(), static_cast<unsigned int>(path.size()), &canonical, &canonicalLength);
+
+        EXPECT_EQ(0, canonicalLength) << path;
+        EXPECT_EQ(nullptr, canonical) << path;
+    }
+
+    clearCanonicalPathCache();
+
+    std::remove((root + "/loop").c_str());
+    std::remove((root + "/abs").c_str());
+    std::remove((root + "/a/b/l3").c_str());
+    std::remove((root + "/a/l2").c_str());
+    std::remove((root + "/l1").c_str());
+    std::remove((root + "/a/b/c/file").c_str());
+    rmdir((root + "/a/b/c").c_str());
+    rmdir((root + "/a/b").c_str());
+    rmdir((root + "/a").c_str());
+    rmdir(root.c_str());
+}
+
+TEST_F(utils_test, canonicalPath_ReadsLinksOnce)
+{
+    char tempDir[] = "/tmp/liblocate-test-XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(tempDir));
+
+    char rootPath[PATH_MAX];
+    ASSERT_NE(nullptr, realpath(tempDir, rootPath));
+
+    const auto root = std::string(rootPath);
+
+    mkdir((root + "/first").c_str(), 0755);
+    mkdir((root + "/second").c_str(), 0755);
+    std::ofstream(root + "/first/a") << "a";
+    std::ofstream(root + "/first/b") << "b";
+    std::ofstream(root + "/second/b") << "b";
+
+    ASSERT_EQ(0, symlink("first", (root + "/link").c_str()));
+
+    clearCanonicalPathCache();
+
+    const auto resolve = [](const std::string & path)
+    {
+        char * canonical = nullptr;
+        unsigned int canonicalLength = 0;
+
+        canonicalPath(path.c_str(), static_cast<unsigned int>(path.size()), &canonical, &canonicalLength);
+
+        const auto result = std::string(canonical != nullptr ? canonical : "", canonicalLength);
+        free(canonical);
+
+        return result;
+    };
+
+    EXPECT_EQ(root + "/first/a", resolve(root + "/link/a"));
+
+    // Retarget the link; paths sharing it are resolved without reading it again
+    ASSERT_EQ(0, std::remove((root + "/link").c_str()));
+    ASSERT_EQ(0, symlink("second", (root + "/link").c_str()));
+
+    EXPECT_EQ(root + "/first/b", resolve(root + "/link/b"));
+
+    // The link is read again only after the cache was cleared
+    clearCanonicalPathCache();
+
+    EXPECT_EQ(root + "/second/b", resolve(root + "/link/b"));
+
+    clearCanonicalPathCache();
+
+    std::remove((root + "/link").c_str());
+    std::remove((root + "/second/b").c_str());
+    std::remove((root + "/first/b").c_str());
+    std::remove((root + "/first/a").c_str());
+    rmdir((root + "/second").c_str());
+    rmdir((root + "/first").c_str());
+    rmdir(root.c_str());
+}
+
+#endif